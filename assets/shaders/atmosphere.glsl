@@ -0,0 +1,133 @@
+// Atmospheric scattering from precomputed LUTs (#include'd after frame_data.glsl, not compiled on its own).
+// Binding points and the layout must match Skybox.h. Distances are in kilometres, the world is in metres.
+// Parameterizations follow Bruneton (transmittance) and Hillaire (sky-view).
+
+const float ATMOSPHERE_PI = 3.14159265;
+
+layout (std140, binding = 3) uniform AtmosphereData {
+    vec4 rayleighScattering; // rgb per km, w: scale height in km
+    vec4 mieParams;          // x: scattering per km, y: extinction per km, z: scale height in km, w: phase g
+    vec4 ozoneAbsorption;    // rgb per km, w: height of the layer's peak in km
+    vec4 atmosphereRadii;    // x: ground, y: top, z: camera distance from the planet's centre, w: aerial perspective scale
+    vec4 sunIlluminance;     // rgb, w: cosine of the sun disc's angular radius
+    vec4 cameraExtinction;   // rgb per km at the camera's height, for aerial perspective
+};
+
+layout (binding = 15) uniform sampler2D transmittanceLut;
+layout (binding = 16) uniform sampler2D skyViewLut;
+
+// Distance along the ray to the sphere around the planet's centre, -1 if it misses
+float raySphere(float r, float mu, float radius) {
+    float discriminant = r * r * (mu * mu - 1.0) + radius * radius;
+    if (discriminant < 0.0) return -1.0;
+    float s = sqrt(discriminant);
+    float near = -r * mu - s;
+    return near >= 0.0 ? near : -r * mu + s;
+}
+
+bool hitsGround(float r, float mu) {
+    return mu < 0.0 && r * r * (mu * mu - 1.0) + atmosphereRadii.x * atmosphereRadii.x >= 0.0;
+}
+
+// r: distance from the planet's centre, mu: cosine between the ray and the local up
+vec2 transmittanceUv(float r, float mu) {
+    float groundR = atmosphereRadii.x;
+    float topR = atmosphereRadii.y;
+    float H = sqrt(topR * topR - groundR * groundR);
+    float rho = sqrt(max(r * r - groundR * groundR, 0.0));
+    float d = max(-r * mu + sqrt(max(r * r * (mu * mu - 1.0) + topR * topR, 0.0)), 0.0); // to the top
+    float dMin = topR - r;
+    float dMax = rho + H;
+    return vec2((d - dMin) / (dMax - dMin), rho / H);
+}
+
+void transmittanceParams(vec2 uv, out float r, out float mu) {
+    float groundR = atmosphereRadii.x;
+    float topR = atmosphereRadii.y;
+    float H = sqrt(topR * topR - groundR * groundR);
+    float rho = H * uv.y;
+    r = sqrt(rho * rho + groundR * groundR);
+    float dMin = topR - r;
+    float dMax = rho + H;
+    float d = dMin + uv.x * (dMax - dMin);
+    mu = d == 0.0 ? 1.0 : clamp((H * H - rho * rho - d * d) / (2.0 * r * d), -1.0, 1.0);
+}
+
+// Transmittance from a point to the top of the atmosphere, ignoring the ground
+vec3 transmittanceToTop(float r, float mu) {
+    return texture(transmittanceLut, transmittanceUv(r, mu)).rgb;
+}
+
+// The sky-view LUT covers every view direction from the camera's height: u is the azimuth from the sun's,
+// squeezed towards the sun (the sky is mirror symmetric around the sun's azimuth), v is the zenith angle,
+// squeezed towards the horizon where the colour changes fastest. The top half is sky, the bottom half ground.
+vec2 skyViewUv(float r, float viewZenithCos, float lightViewCos) {
+    float groundR = atmosphereRadii.x;
+    float cosBeta = sqrt(max(r * r - groundR * groundR, 0.0)) / r;
+    float beta = acos(cosBeta); // horizon below the horizontal
+    float zenithHorizonAngle = ATMOSPHERE_PI - beta;
+    float viewZenithAngle = acos(clamp(viewZenithCos, -1.0, 1.0));
+
+    float v;
+    if (viewZenithAngle < zenithHorizonAngle) {
+        float coord = 1.0 - sqrt(1.0 - viewZenithAngle / zenithHorizonAngle);
+        v = coord * 0.5;
+    } else {
+        float coord = sqrt((viewZenithAngle - zenithHorizonAngle) / beta);
+        v = coord * 0.5 + 0.5;
+    }
+    float u = sqrt(acos(clamp(lightViewCos, -1.0, 1.0)) / ATMOSPHERE_PI);
+    return vec2(u, v);
+}
+
+// Cosine between the azimuths of the view direction and the sun, both around +y
+float lightViewCosine(vec3 direction) {
+    vec2 viewAzimuth = direction.xz;
+    vec2 sunAzimuth = sunDirection.xz;
+    float lengths = length(viewAzimuth) * length(sunAzimuth);
+    return lengths > 1e-5 ? dot(viewAzimuth, sunAzimuth) / lengths : 1.0;
+}
+
+// Scattered sunlight reaching the camera from a direction, out to the atmosphere's edge or the ground
+vec3 skyLuminance(vec3 direction) {
+    vec2 uv = skyViewUv(atmosphereRadii.z, direction.y, lightViewCosine(direction));
+    return texture(skyViewLut, uv).rgb;
+}
+
+// The sun seen through the atmosphere, zero outside its disc. The limb darkens towards the edge.
+vec3 sunDisc(vec3 direction) {
+    float cosAngle = dot(direction, normalize(sunDirection));
+    float cosRadius = sunIlluminance.w;
+    if (cosAngle < cosRadius) return vec3(0.0);
+    if (hitsGround(atmosphereRadii.z, direction.y)) return vec3(0.0);
+
+    float edge = clamp((1.0 - cosAngle) / (1.0 - cosRadius), 0.0, 1.0);
+    float limb = mix(1.0, 0.6, edge * edge);
+    return sunIlluminance.rgb * transmittanceToTop(atmosphereRadii.z, direction.y) * limb;
+}
+
+// Optical depth of the exponential height fog (FrameData::fog) along the ray from the camera, in closed form
+float heightFogOpticalDepth(vec3 toSurface) {
+    float start = fog.x * exp(-fog.y * viewPos.y);
+    float k = fog.y * toSurface.y;
+    float integral = abs(k) > 1e-4 ? (1.0 - exp(-k)) / k : 1.0 - 0.5 * k;
+    return start * length(toSurface) * integral;
+}
+
+// Haze between the camera and a surface. The in-scattered light is the horizon colour of the sky-view LUT in that
+// azimuth, weighted by how much of the path's extinction lies before the surface. Scaled by atmosphereRadii.w,
+// since over a few kilometres of real air the effect would hardly be visible. The height fog adds its extinction
+// on top, and the last stretch before the far plane (see HeightFog) fades into the sky behind the surface.
+vec3 applyAerialPerspective(vec3 color, vec3 worldPos) {
+    vec3 toSurface = worldPos - viewPos;
+    float surfaceDistance = length(toSurface);
+    float distanceKm = surfaceDistance * 0.001 * atmosphereRadii.w;
+    vec3 direction = toSurface / max(surfaceDistance, 1e-4);
+
+    vec3 horizonDirection = normalize(vec3(direction.x, max(direction.y, 0.0), direction.z) + vec3(0.0, 0.02, 0.0));
+    vec3 transmittance = exp(-cameraExtinction.rgb * distanceKm - heightFogOpticalDepth(toSurface));
+    color = color * transmittance + skyLuminance(horizonDirection) * (1.0 - transmittance);
+
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z; // the far plane clips by depth, not distance
+    return mix(color, skyLuminance(direction), smoothstep(fog.z, fog.w, viewDepth));
+}
@@ -0,0 +1,31 @@
+// Scattering and extinction coefficients of the air (#include'd after atmosphere.glsl by the LUT compute shaders).
+
+struct Medium {
+    vec3 rayleigh;   // scattering per km
+    float mie;       // scattering per km
+    vec3 extinction; // per km
+};
+
+Medium mediumAt(float heightKm) {
+    float h = max(heightKm, 0.0);
+    float rayleighDensity = exp(-h / rayleighScattering.w);
+    float mieDensity = exp(-h / mieParams.z);
+    float ozoneDensity = max(0.0, 1.0 - abs(h - ozoneAbsorption.w) / 15.0); // 30 km thick tent
+
+    Medium m;
+    m.rayleigh = rayleighScattering.rgb * rayleighDensity;
+    m.mie = mieParams.x * mieDensity;
+    m.extinction = m.rayleigh + mieParams.y * mieDensity + ozoneAbsorption.rgb * ozoneDensity;
+    return m;
+}
+
+float rayleighPhase(float cosTheta) {
+    return 3.0 / (16.0 * ATMOSPHERE_PI) * (1.0 + cosTheta * cosTheta);
+}
+
+// Cornette-Shanks
+float miePhase(float cosTheta) {
+    float g = mieParams.w;
+    float k = 3.0 / (8.0 * ATMOSPHERE_PI) * (1.0 - g * g) / (2.0 + g * g);
+    return k * (1.0 + cosTheta * cosTheta) / pow(1.0 + g * g - 2.0 * g * cosTheta, 1.5);
+}
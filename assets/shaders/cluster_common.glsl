@@ -0,0 +1,18 @@
+// Clustered forward lighting layout shared by ClusteredLighting's compute shaders and clustered_lighting.glsl
+// (#include'd, not compiled on its own). The constants and binding points must match ClusteredLighting.h.
+
+const uint MAX_LIGHTS_PER_CLUSTER = 128u;
+
+struct PointLight {
+    vec4 positionRadius; // world space, the light has no effect beyond the radius
+    vec4 color;          // linear RGB times intensity
+};
+
+layout (std140, binding = 1) uniform ClusterParams {
+    uvec4 gridSize; // xyz: clusters per axis, w: number of lights this frame
+    vec4 zParams;   // x: slice scale, y: slice bias, z: near, w: far
+};
+
+uint clusterCount() {
+    return gridSize.x * gridSize.y * gridSize.z;
+}
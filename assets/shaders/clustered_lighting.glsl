@@ -0,0 +1,51 @@
+// Point lights for the lit fragment shaders (#include'd after frame_data.glsl, not compiled on its own).
+// The fragment finds its cluster from the screen position and view depth and only shades the lights
+// ClusteredLighting assigned to it.
+
+#include "cluster_common.glsl"
+
+layout (std430, binding = 4) readonly buffer PointLightBuffer {
+    PointLight pointLights[];
+};
+
+layout (std430, binding = 5) readonly buffer ClusterLightCounts {
+    uint clusterLightCount[];
+};
+
+layout (std430, binding = 6) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+uint clusterIndex(vec3 worldPos) {
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    uint slice = uint(clamp(log(max(viewDepth, zParams.z)) * zParams.x + zParams.y, 0.0, float(gridSize.z - 1u)));
+    uvec2 tile = uvec2(clamp(gl_FragCoord.xy * resolution.zw * vec2(gridSize.xy), vec2(0.0), vec2(gridSize.xy - 1u)));
+    return tile.x + gridSize.x * (tile.y + gridSize.y * slice);
+}
+
+// Lambert diffuse plus Blinn-Phong specular of every light in the fragment's cluster
+vec3 clusteredPointLights(vec3 worldPos, vec3 N, vec3 V, vec3 albedo, float specularStrength, float shininess) {
+    uint cluster = clusterIndex(worldPos);
+    uint count = clusterLightCount[cluster];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < count; i++) {
+        PointLight light = pointLights[clusterLightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
+
+        vec3 toLight = light.positionRadius.xyz - worldPos;
+        float distanceSq = dot(toLight, toLight);
+        float radiusSq = light.positionRadius.w * light.positionRadius.w;
+        if (distanceSq >= radiusSq) continue;
+
+        // Inverse square falloff, windowed to reach exactly zero at the radius
+        float window = clamp(1.0 - (distanceSq * distanceSq) / (radiusSq * radiusSq), 0.0, 1.0);
+        float attenuation = window * window / (distanceSq + 1.0);
+
+        vec3 L = toLight * inversesqrt(distanceSq);
+        float NdotL = max(dot(N, L), 0.0);
+        float spec = pow(max(dot(N, normalize(L + V)), 0.0), shininess) * specularStrength;
+
+        result += light.color.rgb * attenuation * NdotL * (albedo + spec);
+    }
+    return result;
+}
@@ -0,0 +1,15 @@
+// Depth pre-pass for alpha-tested geometry (foliage). Must discard exactly like vegetation.frag.
+
+#version 460 core
+
+in vec2 TexCoords;
+
+struct Material {
+    sampler2D diffuse;
+};
+
+uniform Material material;
+
+void main() {
+    if (texture(material.diffuse, TexCoords).a < 0.1) discard;
+}
@@ -0,0 +1,6 @@
+// Depth pre-pass for opaque geometry. Colour writes are masked off, only depth is produced.
+
+#version 460 core
+
+void main() {
+}
@@ -0,0 +1,26 @@
+// Auto-exposure shared by the histogram, the averaging and the tonemap (#include'd, not compiled on its own).
+// Binding points must match AutoExposure.h.
+
+const uint HISTOGRAM_BINS = 256u;
+const float BLACK_LUMINANCE = 1e-5; // bin 0, left out of the average
+
+// Written by exposure_average.comp on the GPU, never read back
+layout (std430, binding = 13) buffer ExposureState {
+    float adaptedLuminance; // eased towards the scene's average, 0 until the first frame
+    float exposure;         // multiplier applied by the tonemap
+};
+
+uniform float u_MinLogLuminance;   // log2 of the darkest luminance with a bin of its own
+uniform float u_LogLuminanceRange; // log2 of brightest / darkest
+
+float luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Bins 1-255 are spaced evenly in log2 luminance
+uint luminanceBin(vec3 color) {
+    float lum = luminance(color);
+    if (lum < BLACK_LUMINANCE) return 0u;
+    float t = clamp((log2(lum) - u_MinLogLuminance) / u_LogLuminanceRange, 0.0, 1.0);
+    return uint(t * 254.0 + 1.0);
+}
@@ -7,7 +7,6 @@
 struct Light {
     vec3 position;
 
-    vec3 ambient;
     vec3 diffuse;
     vec3 specular;
 };
@@ -32,29 +31,27 @@ uniform Material material;
 uniform Light light;
 uniform bool enableNormalMapping;
 
-layout (std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-    vec3 viewPos;
-};
+#include "frame_data.glsl"
+#include "clustered_lighting.glsl"
+#include "sky_irradiance.glsl"
 
 void main() {
-    // ambient. Ambient light is constant
-    // the glsl texture function samples the texture at the given coordinates and returns the color
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, texCoords));
-
     // Implementation of Phong lighting
 
     vec3 norm;
 
     if (enableNormalMapping) {
-        norm = texture(material.normal, texCoords).rgb; // the normal map stores direction in tangent space, look up the normal from the normal map. rgb channels correspond to xyz components of the normal vector
-        norm = normalize(norm * 2.0 - 1.0); // unpack data, transform from [0,1] (texture color range) to [-1,1] (unit vector range)
+        norm.xy = texture(material.normal, texCoords).rg * 2.0 - 1.0; // the normal map stores direction in tangent space, unpack x and y from [0,1] (texture color range) to [-1,1] (unit vector range)
+        norm.z = sqrt(max(1.0 - dot(norm.xy, norm.xy), 0.0)); // the cooked normal maps are BC5 and only store x and y, z follows from the unit length
         norm = normalize(TBN * norm); // transform to world space
     } else {
         norm = normalize(normal);
     }
 
+    // ambient. Ambient light comes from the sky, evaluated from its spherical harmonics
+    // the glsl texture function samples the texture at the given coordinates and returns the color
+    vec3 ambient = skyIrradiance(norm) * vec3(texture(material.diffuse, texCoords));
+
     // diffuse. Diffuse light depends on the angle between light source and surface normal
     vec3 lightDir = normalize(light.position - fragPos);
     float diff = max(dot(norm, lightDir), 0.0);
@@ -68,5 +65,6 @@ void main() {
 
     // combine
     vec3 result = ambient + diffuse + specular;
+    result += clusteredPointLights(fragPos, norm, viewDir, vec3(texture(material.diffuse, texCoords)), texture(material.specular, texCoords).r, material.shininess);
     FragColor = vec4(result, 1.0f);
 }
@@ -0,0 +1,19 @@
+// Per-frame constants written once per frame by FrameUBO (#include'd, not compiled on its own).
+// Uniform buffer object at binding point 0, shared between all shaders: instead of uploading the matrices
+// to every program, they are written once and every shader reads the same memory.
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    mat4 invView;
+    mat4 invProjection;
+    mat4 invViewProj;
+    vec4 frustumPlanes[6]; // left, right, bottom, top, near, far: xyz normal pointing inside, w distance
+    vec3 viewPos;
+    vec3 sunDirection;
+    vec4 time;             // x: seconds since start, y: delta, z: day time
+    vec4 resolution;       // xy: pixels, zw: 1 / pixels
+    vec4 skySH[9];         // sky irradiance, see sky_irradiance.glsl
+    vec4 fog;              // x: height fog density per m at height 0, y: its falloff per m, z: far fade start, w: far plane
+};
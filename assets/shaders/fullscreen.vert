@@ -0,0 +1,12 @@
+// Fullscreen triangle generated from gl_VertexID, drawn with an empty VAO and glDrawArrays(GL_TRIANGLES, 0, 3).
+// One triangle instead of a quad avoids the helper-pixel waste along the diagonal.
+
+#version 460 core
+
+out vec2 TexCoords;
+
+void main() {
+    vec2 uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoords = uv;
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,80 @@
+// Shared visibility test for the culling compute shaders (#include'd, not compiled on its own).
+// Frustum test against the current frame, occlusion test against the previous frame's Hi-Z pyramid.
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 3) buffer CullStats {
+    uint instancesTested;
+    uint instancesVisible;
+    uint chunksTested;
+    uint chunksVisible;
+};
+
+uniform mat4 u_ViewProj;
+uniform mat4 u_PrevViewProj; // matrix the Hi-Z pyramid was rendered with
+uniform sampler2D u_HiZ;
+uniform bool u_UseHiZ;
+
+bool isVisible(vec3 boundsMin, vec3 boundsMax) {
+    vec4 corners[8];
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = mix(boundsMin, boundsMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        corners[i] = vec4(corner, 1.0);
+    }
+
+    // Frustum: culled if all eight corners lie outside the same clip plane
+    bvec3 allBelow = bvec3(true);
+    bvec3 allAbove = bvec3(true);
+    for (int i = 0; i < 8; i++) {
+        vec4 c = u_ViewProj * corners[i];
+        allBelow = bvec3(allBelow.x && c.x < -c.w, allBelow.y && c.y < -c.w, allBelow.z && c.z < -c.w);
+        allAbove = bvec3(allAbove.x && c.x > c.w, allAbove.y && c.y > c.w, allAbove.z && c.z > c.w);
+    }
+    if (any(allBelow) || any(allAbove)) return false;
+
+    if (!u_UseHiZ) return true;
+
+    // Screen rectangle and nearest depth of the box as seen by last frame's camera
+    vec2 ndcMin = vec2(1.0);
+    vec2 ndcMax = vec2(-1.0);
+    float nearestDepth = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec4 c = u_PrevViewProj * corners[i];
+        if (c.w <= 0.0) return true; // crosses the near plane, no reliable rectangle
+
+        vec3 ndc = c.xyz / c.w;
+        ndcMin = min(ndcMin, ndc.xy);
+        ndcMax = max(ndcMax, ndc.xy);
+        nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+    }
+
+    // Outside last frame's view: we have no depth information for it
+    if (any(greaterThan(ndcMin, vec2(1.0))) || any(lessThan(ndcMax, vec2(-1.0)))) return true;
+
+    vec2 uvMin = clamp(ndcMin * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(ndcMax * 0.5 + 0.5, 0.0, 1.0);
+
+    // Pick the level where the rectangle covers about 2x2 texels
+    vec2 sizePx = (uvMax - uvMin) * vec2(textureSize(u_HiZ, 0));
+    int levels = textureQueryLevels(u_HiZ);
+    int level = clamp(int(ceil(log2(max(max(sizePx.x, sizePx.y), 1.0)))), 0, levels - 1);
+
+    ivec2 levelSize = textureSize(u_HiZ, level);
+    ivec2 t0 = clamp(ivec2(uvMin * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 t1 = clamp(ivec2(uvMax * vec2(levelSize)), ivec2(0), min(levelSize - 1, t0 + 2));
+
+    float farthest = 0.0;
+    for (int y = t0.y; y <= t1.y; y++) {
+        for (int x = t0.x; x <= t1.x; x++) {
+            farthest = max(farthest, texelFetch(u_HiZ, ivec2(x, y), level).r);
+        }
+    }
+
+    return nearestDepth <= farthest;
+}
@@ -0,0 +1,40 @@
+// Instanced variant of vertex_shader.vert for static scene objects batched by StaticBatcher.
+// The model matrix comes from the instance buffer (binding point 1) instead of a uniform.
+
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aInstanceMatrix; // locations 3, 4, 5, 6
+layout (location = 7) in vec3 aTangent;
+
+#include "frame_data.glsl"
+
+out vec3 fragPos;
+out vec3 normal;
+out vec2 texCoords;
+out mat3 TBN;
+
+// The depth pre-pass reuses this vertex shader, positions must match bit for bit
+invariant gl_Position;
+
+void main() {
+    fragPos = vec3(aInstanceMatrix * vec4(aPos, 1.0));
+    texCoords = aTexCoord;
+
+    // Instances are translate * rotate * scale, so the inverse transpose of the upper 3x3 is each column
+    // divided by its squared length. Avoids a per-vertex inverse().
+    mat3 m = mat3(aInstanceMatrix);
+    mat3 normalMatrix = mat3(m[0] / dot(m[0], m[0]), m[1] / dot(m[1], m[1]), m[2] / dot(m[2], m[2]));
+
+    vec3 T = normalize(normalMatrix * aTangent);
+    vec3 N = normalize(normalMatrix * aNormal);
+
+    T = normalize(T - dot(T, N) * N); // Gram-Schmidt process
+    vec3 B = normalize(cross(N, T));
+
+    TBN = mat3(T, B, N);
+
+    normal = N;
+    gl_Position = viewProj * vec4(fragPos, 1.0);
+}
@@ -0,0 +1,44 @@
+// Sun shadows from ShadowCascades (#include'd after frame_data.glsl, not compiled on its own).
+// Binding points and the layout must match ShadowCascades.h.
+
+const int CASCADE_COUNT = 4;
+
+layout (std140, binding = 2) uniform ShadowData {
+    mat4 cascadeViewProj[CASCADE_COUNT];
+    vec4 cascadeSplits;    // view depth where each cascade ends
+    vec4 cascadeTexelSize; // world units per shadow texel
+    vec4 cascadeDepthBias; // in depth buffer units
+    vec4 shadowParams;     // x: enabled, y: normal offset in texels
+};
+
+layout (binding = 14) uniform sampler2DArrayShadow shadowMap;
+
+// 1 = lit, 0 = in shadow. The normal offset pushes the lookup off the surface by a few texels of the
+// selected cascade, which removes acne on slopes without the peter-panning a large depth bias causes.
+float sunShadow(vec3 worldPos, vec3 normal) {
+    if (shadowParams.x == 0.0) return 1.0;
+
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    if (viewDepth >= cascadeSplits[CASCADE_COUNT - 1]) return 1.0;
+
+    int cascade = 0;
+    for (int i = 0; i < CASCADE_COUNT - 1; i++) {
+        if (viewDepth >= cascadeSplits[i]) cascade = i + 1;
+    }
+
+    vec3 offsetPos = worldPos + normal * cascadeTexelSize[cascade] * shadowParams.y;
+    vec3 coords = (cascadeViewProj[cascade] * vec4(offsetPos, 1.0)).xyz * 0.5 + 0.5; // orthographic, w = 1
+    if (any(lessThan(coords.xy, vec2(0.0))) || any(greaterThan(coords.xy, vec2(1.0)))) return 1.0;
+
+    float reference = min(coords.z, 1.0) - cascadeDepthBias[cascade];
+
+    // 3x3 taps, each one already bilinearly filtered by the hardware comparison
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), reference));
+        }
+    }
+    return lit / 9.0;
+}
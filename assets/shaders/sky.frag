@@ -0,0 +1,24 @@
+// Sky from the sky-view LUT: one texture lookup per pixel, the scattering was integrated by sky_view.comp.
+// The low resolution sky leaves the sun disc out, sky_upsample.frag adds it at full resolution.
+
+#version 460 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform bool u_SunDisc;
+
+#include "frame_data.glsl"
+#include "atmosphere.glsl"
+#include "sky_common.glsl"
+
+void main() {
+    vec3 direction = viewDirection(TexCoords);
+
+    vec3 color = skyLuminance(direction);
+    if (u_SunDisc) {
+        color += sunDisc(direction);
+    }
+
+    FragColor = vec4(color, 1.0);
+}
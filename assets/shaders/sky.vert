@@ -0,0 +1,12 @@
+// Fullscreen triangle on the far plane: with GL_LEQUAL the sky only shades pixels no geometry has covered.
+// Drawn with an empty VAO and glDrawArrays(GL_TRIANGLES, 0, 3).
+
+#version 460 core
+
+out vec2 TexCoords;
+
+void main() {
+    vec2 uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoords = uv;
+    gl_Position = vec4(uv * 2.0 - 1.0, 1.0, 1.0);
+}
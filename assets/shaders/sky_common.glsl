@@ -0,0 +1,7 @@
+// Shared by the sky shaders (#include'd after frame_data.glsl, not compiled on its own).
+
+// World space direction through a point of the screen
+vec3 viewDirection(vec2 uv) {
+    vec4 farPoint = invViewProj * vec4(uv * 2.0 - 1.0, 1.0, 1.0);
+    return normalize(farPoint.xyz / farPoint.w - viewPos);
+}
@@ -0,0 +1,11 @@
+// Ambient light from the sky (#include'd after frame_data.glsl, not compiled on its own).
+
+// Irradiance from the sky around a normal, in the lit shaders' units where the sun's term is NdotL.
+// The coefficients are projected by SkyIrradiance and already carry the basis constants and the cosine lobe.
+vec3 skyIrradiance(vec3 n) {
+    vec3 e = skySH[0].rgb
+           + skySH[1].rgb * n.y + skySH[2].rgb * n.z + skySH[3].rgb * n.x
+           + skySH[4].rgb * (n.x * n.y) + skySH[5].rgb * (n.y * n.z) + skySH[6].rgb * (3.0 * n.z * n.z - 1.0)
+           + skySH[7].rgb * (n.x * n.z) + skySH[8].rgb * (n.x * n.x - n.y * n.y);
+    return max(e, vec3(0.0));
+}
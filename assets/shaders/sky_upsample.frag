@@ -0,0 +1,20 @@
+// Bilinear upsampling of the quarter resolution sky into the uncovered pixels, the sky has no edges of its own.
+// The sun disc is too small and sharp for the low resolution target, it is added here.
+
+#version 460 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D u_Sky;
+
+#include "frame_data.glsl"
+#include "atmosphere.glsl"
+#include "sky_common.glsl"
+
+void main() {
+    vec3 direction = viewDirection(TexCoords);
+    vec3 color = texture(u_Sky, TexCoords).rgb + sunDisc(direction);
+
+    FragColor = vec4(color, 1.0);
+}
@@ -11,28 +11,30 @@ out vec2 TexCoords;
 out vec3 Normal;
 out vec3 Tangent;
 out vec3 Bitangent;
-out float Height;
+out vec2 SplatCoords;
 
 uniform mat4 model;
+uniform mat3 normalMatrix; // computed once on the CPU instead of inverse(model) per vertex
 
-layout (std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-    vec3 viewPos;
-};
+// The depth pre-pass reuses this vertex shader, positions must match bit for bit
+invariant gl_Position;
+uniform sampler2D splatMap;
+
+#include "frame_data.glsl"
 
 void main()
 {
     vec4 worldPos = model * vec4(aPos, 1.0);
     FragPos = worldPos.xyz;
-    Height = worldPos.y; // Used for biome blending
 
-    mat3 normalMatrix = mat3(transpose(inverse(model)));
+    // One splat texel per heightmap vertex, sample at the texel centre
+    SplatCoords = (aPos.xz + 0.5) / vec2(textureSize(splatMap, 0));
+
     Normal    = normalize(normalMatrix * aNormal);
     Tangent   = normalize(normalMatrix * aTangent);
     Bitangent = normalize(normalMatrix * aBitangent);
 
     TexCoords = aTexCoords;
 
-    gl_Position = projection * view * worldPos;
+    gl_Position = viewProj * worldPos;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+// Terrain material and lighting (#include'd after frame_data.glsl, clustered_lighting.glsl, shadows.glsl,
+// atmosphere.glsl and sky_irradiance.glsl, not compiled on its own). Shared by the forward terrain.frag and the
+// visibility buffer resolve, the texture units are set by Terrain::bindMaterial.
+
+uniform sampler2D grassTexture;
+uniform sampler2D grassNormal;
+uniform sampler2D grassAO;
+
+uniform sampler2D rockTexture;
+uniform sampler2D rockNormal;
+uniform sampler2D rockAO;
+
+uniform sampler2D snowTexture;
+uniform sampler2D snowNormal;
+uniform sampler2D snowAO;
+
+// Baked on the CPU (TerrainSplatMap): r = grass, g = rock, b = snow weight
+uniform sampler2D splatMap;
+
+// Baked on the CPU (TerrainHorizonMap): horizon elevation / 90 degrees in 8 azimuths, 45 degrees apart from +x
+// towards +z. Layer 0 holds directions 0-3, layer 1 holds 4-7.
+uniform sampler2DArray horizonMap;
+
+// Everything the shading needs from the rasterizer. The screen space derivatives are passed in, so the
+// visibility buffer resolve can supply analytic ones where dFdx / dFdy would cross triangle edges.
+struct TerrainSample {
+    vec3 worldPos;
+    vec3 normal;      // interpolated vertex normal
+    vec2 splatCoords;
+    vec3 dPdx, dPdy;  // of worldPos
+    vec2 dSplatDx, dSplatDy;
+};
+
+struct Surface {
+    vec3 albedo;
+    vec3 normal;
+    float ao;
+};
+
+vec3 triplanarBlend(vec3 n) {
+    vec3 w = abs(n);
+    w = max(w, 0.00001);
+    return w / (w.x + w.y + w.z);
+}
+
+vec3 sampleTriplanarColor(sampler2D tex, vec3 p, vec3 n, float scale, vec3 dpdx, vec3 dpdy) {
+    vec3 w = triplanarBlend(n);
+
+    vec3 x = textureGrad(tex, p.yz * scale, dpdx.yz * scale, dpdy.yz * scale).rgb;
+    vec3 y = textureGrad(tex, p.xz * scale, dpdx.xz * scale, dpdy.xz * scale).rgb;
+    vec3 z = textureGrad(tex, p.xy * scale, dpdx.xy * scale, dpdy.xy * scale).rgb;
+
+    return x * w.x + y * w.y + z * w.z;
+}
+
+vec3 sampleTriplanarNormal(sampler2D tex, vec3 p, vec3 n, float scale, vec3 dpdx, vec3 dpdy) {
+    vec3 w = triplanarBlend(n);
+
+    vec3 nx = textureGrad(tex, p.yz * scale, dpdx.yz * scale, dpdy.yz * scale).xyz * 2.0 - 1.0;
+    vec3 ny = textureGrad(tex, p.xz * scale, dpdx.xz * scale, dpdy.xz * scale).xyz * 2.0 - 1.0;
+    vec3 nz = textureGrad(tex, p.xy * scale, dpdx.xy * scale, dpdy.xy * scale).xyz * 2.0 - 1.0;
+
+    nx = vec3(0.0, nx.y, nx.x);
+    ny = vec3(ny.x, 0.0, ny.y);
+    nz = vec3(nz.x, nz.y, 0.0);
+
+    return normalize(nx * w.x + ny * w.y + nz * w.z);
+}
+
+Surface sampleSurface(
+sampler2D albedo,
+sampler2D normal,
+sampler2D ao,
+vec3 p,
+vec3 n,
+vec3 dpdx,
+vec3 dpdy
+) {
+    const float SCALE = 0.05;
+
+    Surface s;
+    s.albedo = sampleTriplanarColor(albedo, p, n, SCALE, dpdx, dpdy);
+    s.normal = sampleTriplanarNormal(normal, p, n, SCALE, dpdx, dpdy);
+    s.ao     = clamp(sampleTriplanarColor(ao, p, n, SCALE, dpdx, dpdy).r, 0.4, 1.0);
+
+    return s;
+}
+
+Surface blendTerrain(TerrainSample t, vec3 n) {
+    vec3 p = t.worldPos;
+
+    Surface grass = sampleSurface(grassTexture, grassNormal, grassAO, p, n, t.dPdx, t.dPdy);
+    Surface rock  = sampleSurface(rockTexture,  rockNormal,  rockAO,  p, n, t.dPdx, t.dPdy);
+    Surface snow  = sampleSurface(snowTexture,  snowNormal,  snowAO,  p, n, t.dPdx, t.dPdy);
+
+    vec3 weights = textureGrad(splatMap, t.splatCoords, t.dSplatDx, t.dSplatDy).rgb;
+    weights /= max(weights.r + weights.g + weights.b, 0.0001); // renormalize after filtering/quantization
+
+    float grassW = weights.r;
+    float rockW  = weights.g;
+    float snowW  = weights.b;
+
+    Surface s;
+    s.albedo = grass.albedo * grassW + rock.albedo * rockW + snow.albedo * snowW;
+    s.normal = normalize(grass.normal * grassW + rock.normal * rockW + snow.normal * snowW);
+    s.ao     = grass.ao * grassW     + rock.ao * rockW     + snow.ao * snowW;
+
+    return s;
+}
+
+const float PI = 3.14159265;
+const float HORIZON_PENUMBRA = 0.05; // radians, hides the 8 bit angle steps
+
+// x: soft sun visibility against the horizon in the sun's azimuth, y: cosine weighted sky visibility
+vec2 horizonVisibility(TerrainSample t) {
+    vec4 layer0 = textureGrad(horizonMap, vec3(t.splatCoords, 0.0), t.dSplatDx, t.dSplatDy) * (PI * 0.5);
+    vec4 layer1 = textureGrad(horizonMap, vec3(t.splatCoords, 1.0), t.dSplatDx, t.dSplatDy) * (PI * 0.5);
+
+    float azimuth = mod(atan(sunDirection.z, sunDirection.x) / (PI * 0.25), 8.0);
+    int i0 = int(azimuth) % 8;
+    int i1 = (i0 + 1) % 8;
+    float h0 = i0 < 4 ? layer0[i0] : layer1[i0 - 4];
+    float h1 = i1 < 4 ? layer0[i1] : layer1[i1 - 4];
+    float horizon = mix(h0, h1, fract(azimuth));
+
+    float sunElevation = asin(clamp(sunDirection.y, -1.0, 1.0));
+    float sun = smoothstep(horizon - HORIZON_PENUMBRA, horizon + HORIZON_PENUMBRA, sunElevation);
+
+    // A slice with horizon angle h lets through cos^2(h) of its cosine weighted sky
+    vec4 sin0 = sin(layer0);
+    vec4 sin1 = sin(layer1);
+    float sky = 1.0 - (dot(sin0, sin0) + dot(sin1, sin1)) / 8.0;
+
+    return vec2(sun, sky);
+}
+
+vec3 lighting(TerrainSample t, Surface s, vec3 baseNormal) {
+
+    vec3 N = normalize(s.normal);
+    vec3 L = normalize(sunDirection); // points at the sun, like in the sky and vegetation shaders
+
+    float NdotL = max(dot(N, L), 0.0);
+
+    // Sky ambient, the horizon map shadows the part of the sky hidden behind terrain
+    vec2 horizon = horizonVisibility(t);
+    vec3 ambient = s.albedo * skyIrradiance(N) * s.ao * horizon.y;
+
+    // Lambert diffuse
+    vec3 sunColor = vec3(1.0, 0.97, 0.9);
+    vec3 diffuse = s.albedo * sunColor * NdotL * min(sunShadow(t.worldPos, baseNormal), horizon.x);
+
+    return ambient + diffuse;
+}
+
+vec3 shadeTerrain(TerrainSample t) {
+    vec3 baseNormal = normalize(t.normal);
+    Surface surface = blendTerrain(t, baseNormal);
+
+    vec3 color = lighting(t, surface, baseNormal);
+    color += clusteredPointLights(t.worldPos, normalize(surface.normal), normalize(viewPos - t.worldPos), surface.albedo, 0.0, 1.0);
+    return applyAerialPerspective(color, t.worldPos);
+}
@@ -0,0 +1,58 @@
+// HDR scene colour to the window: the auto-exposure multiplier, a filmic curve, then dithering against banding in
+// the 8 bit output. GL_FRAMEBUFFER_SRGB encodes the result.
+// Below native resolution the scene is upscaled bilinearly and sharpened with a contrast adaptive filter after
+// AMD's CAS, in tonemapped values where the sharpening is perceptually even.
+
+#version 460 core
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D u_Source;
+uniform float u_Sharpness; // 0: plain bilinear, 1: strongest
+
+#include "exposure.glsl"
+
+const float NOISE_GRANULARITY = 0.5 / 255.0; // dither strength
+
+// A standard pseudo-random function for shaders https://thebookofshaders.com/10/
+// We use this for dithering to reduce colour banding https://en.wikipedia.org/wiki/Colour_banding
+float random(vec2 st) {
+    return fract(sin(dot(st.xy, vec2(12.9898, 78.233))) * 43758.5453123);
+}
+
+vec3 dither(vec3 color) {
+    return color + mix(-NOISE_GRANULARITY, NOISE_GRANULARITY, random(gl_FragCoord.xy));
+}
+
+// Narkowicz's fit of the ACES reference rendering transform
+vec3 acesFilm(vec3 x) {
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+vec3 tonemapped(vec2 uv) {
+    return acesFilm(texture(u_Source, uv).rgb * exposure);
+}
+
+void main() {
+    vec3 color = tonemapped(TexCoords);
+
+    if (u_Sharpness > 0.0) {
+        // Cross of neighbours one source texel away
+        vec2 texel = 1.0 / vec2(textureSize(u_Source, 0));
+        vec3 north = tonemapped(TexCoords + vec2(0.0, texel.y));
+        vec3 south = tonemapped(TexCoords - vec2(0.0, texel.y));
+        vec3 east = tonemapped(TexCoords + vec2(texel.x, 0.0));
+        vec3 west = tonemapped(TexCoords - vec2(texel.x, 0.0));
+
+        // Less sharpening where the local contrast is already high, so edges don't ring
+        vec3 lo = min(color, min(min(north, south), min(east, west)));
+        vec3 hi = max(color, max(max(north, south), max(east, west)));
+        vec3 amount = sqrt(clamp(min(lo, 1.0 - hi) / max(hi, 1e-4), 0.0, 1.0));
+        vec3 weight = -amount / mix(8.0, 5.0, u_Sharpness);
+
+        color = clamp((color + (north + south + east + west) * weight) / (1.0 + 4.0 * weight), 0.0, 1.0);
+    }
+
+    FragColor = vec4(dither(color), 1.0);
+}
@@ -15,12 +15,10 @@ out vec3 Normal;
 out vec3 FragPos;
 out mat3 TBN;
 
-// Global Uniforms
-layout (std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-    vec3 viewPos;
-};
+// The depth pre-pass reuses this vertex shader, positions must match bit for bit
+invariant gl_Position;
+
+#include "frame_data.glsl"
 
 void main() {
     vec4 worldPos = aInstanceMatrix * vec4(aPos, 1.0);
@@ -45,5 +43,5 @@ void main() {
 
     Normal = N;
 
-    gl_Position = projection * view * worldPos;
+    gl_Position = viewProj * worldPos;
 }
\ No newline at end of file
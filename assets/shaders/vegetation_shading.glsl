@@ -0,0 +1,46 @@
+// Foliage lighting (#include'd after frame_data.glsl, clustered_lighting.glsl, shadows.glsl, atmosphere.glsl and
+// sky_irradiance.glsl, not compiled on its own). Shared by the forward vegetation.frag and the visibility buffer
+// resolve, which passes analytic texture coordinate derivatives.
+
+vec3 shadeVegetation(sampler2D diffuseMap, sampler2D normalMap, sampler2D armMap,
+                     vec2 uv, vec2 dUVdx, vec2 dUVdy, vec3 fragPos, vec3 vertexNormal, mat3 TBN) {
+    vec3 albedo = textureGrad(diffuseMap, uv, dUVdx, dUVdy).rgb;
+
+    // Sample ARM/ORM Texture
+    vec3 ormSample = textureGrad(armMap, uv, dUVdx, dUVdy).rgb;
+    float ao = max(ormSample.r, 0.3);
+    float roughness = ormSample.g;
+    float metallic = ormSample.b;
+
+    // Normal Mapping
+    vec3 normalMapSample;
+    normalMapSample.xy = textureGrad(normalMap, uv, dUVdx, dUVdy).rg * 2.0 - 1.0; // [0,1] -> [-1,1]
+    normalMapSample.z = sqrt(max(1.0 - dot(normalMapSample.xy, normalMapSample.xy), 0.0)); // BC5 stores only x and y
+    vec3 transformedNormal = TBN * normalMapSample; // Transform to world space
+    vec3 normal = normalize(transformedNormal);
+
+    // Lighting Calculations
+    vec3 lightDir = normalize(sunDirection);
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+
+    // Ambient Occlusion
+    vec3 ambient = skyIrradiance(normal) * albedo * ao;
+
+    // Diffuse
+    float NdotL = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = NdotL * albedo;
+
+    // Specular (Blinn-Phong)
+    float shininess = (1.0 - roughness) * 128.0;
+    float spec = pow(
+    max(dot(normal, halfwayDir), 0.0001),
+    max(shininess, 0.0001)
+    );
+    vec3 specular = vec3(0.2) * spec * (1.0 - roughness);
+
+    // Combine
+    vec3 result = ambient + (diffuse + specular) * sunShadow(fragPos, normalize(vertexNormal));
+    result += clusteredPointLights(fragPos, normal, viewDir, albedo, 0.2 * (1.0 - roughness), max(shininess, 0.0001));
+    return applyAerialPerspective(result, fragPos);
+}
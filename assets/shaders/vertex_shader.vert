@@ -10,12 +10,7 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aTangent;
 
-// Uniform buffer object (UBO) for camera data, shared between multiple shaders
-layout (std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-    vec3 viewPos;
-};
+#include "frame_data.glsl"
 
 // "out" variables are passed to the Fragment Shader.
 // The GPU automatically interpolates these values across the triangle's surface.
@@ -24,6 +19,9 @@ out vec3 normal;
 out vec2 texCoords; // the textures uv coordinates
 out mat3 TBN; // Tangent, Bitangent, Normal matrix to transform from tangent space to world space
 
+// The depth pre-pass reuses this vertex shader, positions must match bit for bit
+invariant gl_Position;
+
 // Uniforms are global variables within a shader that remain constant for all processed vertices for a single draw call.
 uniform mat4 model;       // Transforms Object Space -> World Space
 uniform mat3 normalMatrix;
@@ -41,5 +39,5 @@ void main() {
     TBN = mat3(T, B, N); // convert from tangent space to world space
 
     normal = N;
-    gl_Position = projection * view * vec4(fragPos, 1.0f); // gl_Position is a special variable that holds the final position of the vertex in Clip Space
+    gl_Position = viewProj * vec4(fragPos, 1.0f); // gl_Position is a special variable that holds the final position of the vertex in Clip Space
 }
@@ -0,0 +1,11 @@
+// Visibility buffer encoding (#include'd, not compiled on its own), must match VisibilityBuffer.h.
+// x: triangle index within the draw's index range, y: kind in the top 8 bits, instance in the low 24.
+
+const uint VIS_KIND_TERRAIN = 1u;
+const uint VIS_KIND_VEGETATION = 2u; // + mesh index of the vegetation model
+const uint VIS_INSTANCE_BITS = 24u;
+const uint VIS_INSTANCE_MASK = (1u << VIS_INSTANCE_BITS) - 1u;
+
+uvec2 packVisibility(uint triangle, uint kind, uint instance) {
+    return uvec2(triangle, (kind << VIS_INSTANCE_BITS) | (instance & VIS_INSTANCE_MASK));
+}
@@ -0,0 +1,220 @@
+// Visibility buffer resolve: every covered pixel fetches its triangle's vertices, rebuilds the attributes from
+// barycentrics and is shaded exactly once, no matter how many layers of foliage were rasterized on top of each other.
+// Pixels at the far plane are left to the sky, other geometry is drawn forward afterwards.
+
+#version 460 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+#include "frame_data.glsl"
+#include "clustered_lighting.glsl"
+#include "shadows.glsl"
+#include "atmosphere.glsl"
+#include "sky_irradiance.glsl"
+#include "visibility.glsl"
+#include "terrain_shading.glsl"
+#include "vegetation_shading.glsl"
+
+const int MAX_VEGETATION_MESHES = 4; // must match VisibilityBuffer.h
+
+// Texture units and binding points must match VisibilityBuffer.h
+layout (binding = 17) uniform sampler2D u_VegetationDiffuse[MAX_VEGETATION_MESHES];
+layout (binding = 21) uniform sampler2D u_VegetationNormal[MAX_VEGETATION_MESHES];
+layout (binding = 25) uniform sampler2D u_VegetationArm[MAX_VEGETATION_MESHES];
+layout (binding = 29) uniform usampler2D u_Visibility;
+layout (binding = 30) uniform sampler2D u_Depth;
+
+// Vertices as tightly packed floats, Terrain::TerrainVertex and Vertex share the layout
+const uint VERTEX_FLOATS = 14u;
+
+layout (std430, binding = 8) readonly buffer TerrainVertices {
+    float terrainVertices[];
+};
+
+layout (std430, binding = 9) readonly buffer TerrainIndices {
+    uint terrainIndices[];
+};
+
+// Every mesh of the vegetation model in one buffer, see VisibilityBuffer::setVegetationModel
+layout (std430, binding = 10) readonly buffer VegetationVertices {
+    float vegetationVertices[];
+};
+
+layout (std430, binding = 11) readonly buffer VegetationIndices {
+    uint vegetationIndices[];
+};
+
+layout (std430, binding = 12) readonly buffer VegetationInstances {
+    mat4 vegetationInstances[];
+};
+
+uniform mat4 u_TerrainModel;
+uniform mat3 u_TerrainNormalMatrix;
+uniform uint u_MeshFirstIndex[MAX_VEGETATION_MESHES];
+uniform uint u_MeshBaseVertex[MAX_VEGETATION_MESHES];
+
+struct VertexData {
+    vec3 position;
+    vec3 normal;
+    vec2 texCoords;
+    vec3 tangent;
+    vec3 bitangent;
+};
+
+VertexData terrainVertex(uint index) {
+    uint o = index * VERTEX_FLOATS;
+    VertexData v;
+    v.position = vec3(terrainVertices[o], terrainVertices[o + 1u], terrainVertices[o + 2u]);
+    v.normal = vec3(terrainVertices[o + 3u], terrainVertices[o + 4u], terrainVertices[o + 5u]);
+    return v; // the terrain shading only needs these two
+}
+
+VertexData vegetationVertex(uint index) {
+    uint o = index * VERTEX_FLOATS;
+    VertexData v;
+    v.position = vec3(vegetationVertices[o], vegetationVertices[o + 1u], vegetationVertices[o + 2u]);
+    v.normal = vec3(vegetationVertices[o + 3u], vegetationVertices[o + 4u], vegetationVertices[o + 5u]);
+    v.texCoords = vec2(vegetationVertices[o + 6u], vegetationVertices[o + 7u]);
+    v.tangent = vec3(vegetationVertices[o + 8u], vegetationVertices[o + 9u], vegetationVertices[o + 10u]);
+    v.bitangent = vec3(vegetationVertices[o + 11u], vegetationVertices[o + 12u], vegetationVertices[o + 13u]);
+    return v;
+}
+
+// Perspective correct barycentrics of the pixel and their screen space derivatives, from the triangle's clip space
+// positions. Attributes interpolated with the derivatives give the gradients the rasterizer would have.
+struct Barycentrics {
+    vec3 lambda;
+    vec3 ddx;
+    vec3 ddy;
+};
+
+Barycentrics barycentrics(vec4 clip0, vec4 clip1, vec4 clip2, vec2 pixelNdc) {
+    vec3 invW = 1.0 / vec3(clip0.w, clip1.w, clip2.w);
+    vec2 ndc0 = clip0.xy * invW.x;
+    vec2 ndc1 = clip1.xy * invW.y;
+    vec2 ndc2 = clip2.xy * invW.z;
+
+    float invDet = 1.0 / determinant(mat2(ndc2 - ndc1, ndc0 - ndc1));
+    vec3 ddx = vec3(ndc1.y - ndc2.y, ndc2.y - ndc0.y, ndc0.y - ndc1.y) * invDet * invW;
+    vec3 ddy = vec3(ndc2.x - ndc1.x, ndc0.x - ndc2.x, ndc1.x - ndc0.x) * invDet * invW;
+    float ddxSum = ddx.x + ddx.y + ddx.z;
+    float ddySum = ddy.x + ddy.y + ddy.z;
+
+    vec2 delta = pixelNdc - ndc0;
+    float interpInvW = invW.x + delta.x * ddxSum + delta.y * ddySum;
+    float interpW = 1.0 / interpInvW;
+
+    Barycentrics b;
+    b.lambda = interpW * vec3(invW.x + delta.x * ddx.x + delta.y * ddy.x,
+                              delta.x * ddx.y + delta.y * ddy.y,
+                              delta.x * ddx.z + delta.y * ddy.z);
+
+    // One pixel to the right and one up, in NDC
+    vec2 pixelSize = 2.0 * resolution.zw;
+    ddx *= pixelSize.x;
+    ddy *= pixelSize.y;
+    ddxSum *= pixelSize.x;
+    ddySum *= pixelSize.y;
+
+    b.ddx = (b.lambda * interpInvW + ddx) / (interpInvW + ddxSum) - b.lambda;
+    b.ddy = (b.lambda * interpInvW + ddy) / (interpInvW + ddySum) - b.lambda;
+    return b;
+}
+
+vec3 interpolate(vec3 weights, vec3 a0, vec3 a1, vec3 a2) {
+    return weights.x * a0 + weights.y * a1 + weights.z * a2;
+}
+
+vec2 interpolate(vec3 weights, vec2 a0, vec2 a1, vec2 a2) {
+    return weights.x * a0 + weights.y * a1 + weights.z * a2;
+}
+
+vec3 resolveTerrain(uint triangle, vec2 pixelNdc) {
+    uint first = triangle * 3u;
+    VertexData v0 = terrainVertex(terrainIndices[first]);
+    VertexData v1 = terrainVertex(terrainIndices[first + 1u]);
+    VertexData v2 = terrainVertex(terrainIndices[first + 2u]);
+
+    vec3 p0 = (u_TerrainModel * vec4(v0.position, 1.0)).xyz;
+    vec3 p1 = (u_TerrainModel * vec4(v1.position, 1.0)).xyz;
+    vec3 p2 = (u_TerrainModel * vec4(v2.position, 1.0)).xyz;
+    Barycentrics b = barycentrics(viewProj * vec4(p0, 1.0), viewProj * vec4(p1, 1.0), viewProj * vec4(p2, 1.0), pixelNdc);
+
+    // Like terrain.vert: one splat texel per heightmap vertex
+    vec2 splatScale = 1.0 / vec2(textureSize(splatMap, 0));
+    vec2 s0 = (v0.position.xz + 0.5) * splatScale;
+    vec2 s1 = (v1.position.xz + 0.5) * splatScale;
+    vec2 s2 = (v2.position.xz + 0.5) * splatScale;
+
+    TerrainSample t;
+    t.worldPos = interpolate(b.lambda, p0, p1, p2);
+    t.normal = interpolate(b.lambda, normalize(u_TerrainNormalMatrix * v0.normal), normalize(u_TerrainNormalMatrix * v1.normal),
+                           normalize(u_TerrainNormalMatrix * v2.normal));
+    t.splatCoords = interpolate(b.lambda, s0, s1, s2);
+    t.dPdx = interpolate(b.ddx, p0, p1, p2);
+    t.dPdy = interpolate(b.ddy, p0, p1, p2);
+    t.dSplatDx = interpolate(b.ddx, s0, s1, s2);
+    t.dSplatDy = interpolate(b.ddy, s0, s1, s2);
+    return shadeTerrain(t);
+}
+
+vec3 resolveVegetation(uint mesh, uint triangle, uint instance, vec2 pixelNdc) {
+    uint first = u_MeshFirstIndex[mesh] + triangle * 3u;
+    uint baseVertex = u_MeshBaseVertex[mesh];
+    VertexData v0 = vegetationVertex(baseVertex + vegetationIndices[first]);
+    VertexData v1 = vegetationVertex(baseVertex + vegetationIndices[first + 1u]);
+    VertexData v2 = vegetationVertex(baseVertex + vegetationIndices[first + 2u]);
+
+    mat4 model = vegetationInstances[instance];
+    vec3 p0 = (model * vec4(v0.position, 1.0)).xyz;
+    vec3 p1 = (model * vec4(v1.position, 1.0)).xyz;
+    vec3 p2 = (model * vec4(v2.position, 1.0)).xyz;
+    Barycentrics b = barycentrics(viewProj * vec4(p0, 1.0), viewProj * vec4(p1, 1.0), viewProj * vec4(p2, 1.0), pixelNdc);
+
+    // Like vegetation.vert, per vertex and then interpolated
+    mat3 normalMatrix = mat3(model);
+    vec3 n0 = normalize(normalMatrix * v0.normal);
+    vec3 n1 = normalize(normalMatrix * v1.normal);
+    vec3 n2 = normalize(normalMatrix * v2.normal);
+    vec3 t0 = normalize(normalMatrix * v0.tangent);
+    vec3 t1 = normalize(normalMatrix * v1.tangent);
+    vec3 t2 = normalize(normalMatrix * v2.tangent);
+    t0 = normalize(t0 - dot(t0, n0) * n0);
+    t1 = normalize(t1 - dot(t1, n1) * n1);
+    t2 = normalize(t2 - dot(t2, n2) * n2);
+
+    vec3 N = interpolate(b.lambda, n0, n1, n2);
+    vec3 T = interpolate(b.lambda, t0, t1, t2);
+    vec3 B = interpolate(b.lambda, cross(n0, t0), cross(n1, t1), cross(n2, t2));
+    mat3 TBN = mat3(T, B, N);
+
+    vec3 fragPos = interpolate(b.lambda, p0, p1, p2);
+    vec2 uv = interpolate(b.lambda, v0.texCoords, v1.texCoords, v2.texCoords);
+    vec2 dUVdx = interpolate(b.ddx, v0.texCoords, v1.texCoords, v2.texCoords);
+    vec2 dUVdy = interpolate(b.ddy, v0.texCoords, v1.texCoords, v2.texCoords);
+
+    // Sampler arrays can only be indexed with constants here, the mesh differs between pixels
+    switch (mesh) {
+        case 0u: return shadeVegetation(u_VegetationDiffuse[0], u_VegetationNormal[0], u_VegetationArm[0], uv, dUVdx, dUVdy, fragPos, N, TBN);
+        case 1u: return shadeVegetation(u_VegetationDiffuse[1], u_VegetationNormal[1], u_VegetationArm[1], uv, dUVdx, dUVdy, fragPos, N, TBN);
+        case 2u: return shadeVegetation(u_VegetationDiffuse[2], u_VegetationNormal[2], u_VegetationArm[2], uv, dUVdx, dUVdy, fragPos, N, TBN);
+        default: return shadeVegetation(u_VegetationDiffuse[3], u_VegetationNormal[3], u_VegetationArm[3], uv, dUVdx, dUVdy, fragPos, N, TBN);
+    }
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (texelFetch(u_Depth, pixel, 0).r == 1.0) discard; // the sky fills these
+
+    uvec2 visibility = texelFetch(u_Visibility, pixel, 0).rg;
+    uint kind = visibility.y >> VIS_INSTANCE_BITS;
+    uint instance = visibility.y & VIS_INSTANCE_MASK;
+    vec2 pixelNdc = gl_FragCoord.xy * resolution.zw * 2.0 - 1.0;
+
+    vec3 color = kind == VIS_KIND_TERRAIN
+        ? resolveTerrain(visibility.x, pixelNdc)
+        : resolveVegetation(kind - VIS_KIND_VEGETATION, visibility.x, instance, pixelNdc);
+
+    FragColor = vec4(color, 1.0);
+}
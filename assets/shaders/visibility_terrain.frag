@@ -0,0 +1,11 @@
+#version 460 core
+
+flat in uint FirstTriangle;
+
+layout (location = 0) out uvec2 Visibility;
+
+#include "visibility.glsl"
+
+void main() {
+    Visibility = packVisibility(FirstTriangle + uint(gl_PrimitiveID), VIS_KIND_TERRAIN, 0u);
+}
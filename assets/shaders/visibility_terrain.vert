@@ -0,0 +1,16 @@
+// Visibility buffer pass of the terrain, positions only.
+
+#version 460 core
+
+layout (location = 0) in vec3 aPos;
+
+flat out uint FirstTriangle; // of the chunk, gl_PrimitiveID restarts with every draw command
+
+uniform mat4 model;
+
+#include "frame_data.glsl"
+
+void main() {
+    FirstTriangle = uint(gl_BaseInstance); // written by cull_terrain.comp, 0 for the unculled single draw
+    gl_Position = viewProj * model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,22 @@
+// Must discard exactly like vegetation.frag.
+
+#version 460 core
+
+in vec2 TexCoords;
+flat in uint Instance;
+
+layout (location = 0) out uvec2 Visibility;
+
+struct Material {
+    sampler2D diffuse;
+};
+
+uniform Material material;
+uniform uint u_Mesh; // set per mesh by Renderer::renderInstanced
+
+#include "visibility.glsl"
+
+void main() {
+    if (texture(material.diffuse, TexCoords).a < 0.1) discard;
+    Visibility = packVisibility(uint(gl_PrimitiveID), VIS_KIND_VEGETATION + u_Mesh, Instance);
+}
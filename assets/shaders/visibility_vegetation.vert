@@ -0,0 +1,18 @@
+// Visibility buffer pass of instanced foliage. Texture coordinates are only needed for the alpha test.
+
+#version 460 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aInstanceMatrix;
+
+out vec2 TexCoords;
+flat out uint Instance; // index into the instance buffer bound for the draw, the resolve reads the same one
+
+#include "frame_data.glsl"
+
+void main() {
+    TexCoords = aTexCoords;
+    Instance = uint(gl_InstanceID);
+    gl_Position = viewProj * aInstanceMatrix * vec4(aPos, 1.0);
+}
@@ -102,12 +102,16 @@ float Camera::getFov() const {
     return m_fov;
 }
 
+void Camera::setFov(const float fov) {
+    m_fov = glm::clamp(fov, 1.0f, 45.0f);
+}
+
 glm::mat4 Camera::getViewMatrix() const {
     return m_view;
 }
 
 glm::mat4 Camera::getProjectionMatrix(const float width, const float height) const {
-    return glm::perspective(glm::radians(m_fov), width / height, 0.1f, 4000.0f); // how far we can see
+    return glm::perspective(glm::radians(m_fov), width / height, m_near, m_far);
 }
 
 void Camera::setPosition(const glm::vec3 &position) {
@@ -115,6 +119,12 @@ void Camera::setPosition(const glm::vec3 &position) {
     updateView();
 }
 
+void Camera::setOrientation(const float yaw, const float pitch) {
+    m_yaw = yaw;
+    m_pitch = glm::clamp(pitch, -89.0f, 89.0f);
+    updateView();
+}
+
 void Camera::setPosition(float x, float y, float z) {
     m_cameraPos = glm::vec3(x, y, z);
     updateView();
@@ -14,10 +14,17 @@ public:
     void setPosition(const glm::vec3& position);
     void setPosition(float x, float y, float z);
     [[nodiscard]] float getFov() const;
+    void setFov(float fov); // degrees, clamped like scrolling
     [[nodiscard]] glm::mat4 getViewMatrix() const;
     [[nodiscard]] glm::mat4 getProjectionMatrix(float width, float height) const;
+    [[nodiscard]] float getNearPlane() const { return m_near; }
+    [[nodiscard]] float getFarPlane() const { return m_far; }
+    void setFarPlane(const float far) { m_far = far; } // e.g. where the fog hides everything, see HeightFog
     void setFirstMouse(const bool b) { m_firstMouse = b; }
     void setCameraPos(const glm::vec3& pos) { m_cameraPos = pos; updateView(); }
+    void setOrientation(float yaw, float pitch); // degrees, same convention as mouse look
+    [[nodiscard]] float getYaw() const { return m_yaw; }
+    [[nodiscard]] float getPitch() const { return m_pitch; }
 private:
     float m_yaw;
     float m_pitch;
@@ -29,6 +36,8 @@ private:
     float m_sensitivity;
     float m_speed;
     float m_fov;
+    float m_near = 0.1f;
+    float m_far = 4000.0f; // how far we can see
     bool m_firstMouse;
     glm::vec3 m_direction;
     glm::vec3 m_cameraPos;
@@ -0,0 +1,116 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "Camera.h"
+
+void CameraPath::clear() {
+    m_keyframes.clear();
+    m_startDayTime = 0.0f;
+}
+
+void CameraPath::addKeyframe(const float time, const Camera& camera) {
+    if (!m_keyframes.empty() && time <= m_keyframes.back().time) return; // keep times strictly increasing
+    m_keyframes.push_back({time, camera.getCameraPos(), camera.getYaw(), camera.getPitch(), camera.getFov()});
+}
+
+void CameraPath::apply(Camera& camera, const float time) const {
+    if (m_keyframes.empty()) return;
+
+    const auto next = std::ranges::upper_bound(m_keyframes, time, {}, &Keyframe::time);
+    Keyframe frame;
+    if (next == m_keyframes.begin()) {
+        frame = m_keyframes.front();
+    } else if (next == m_keyframes.end()) {
+        frame = m_keyframes.back();
+    } else {
+        const Keyframe& a = *(next - 1);
+        const Keyframe& b = *next;
+        const float t = (time - a.time) / (b.time - a.time);
+
+        // Yaw is unbounded while recording, but take the short way round in case it was wrapped
+        float yawDelta = std::fmod(b.yaw - a.yaw, 360.0f);
+        if (yawDelta > 180.0f) yawDelta -= 360.0f;
+        if (yawDelta < -180.0f) yawDelta += 360.0f;
+
+        frame.time = time;
+        frame.position = glm::mix(a.position, b.position, t);
+        frame.yaw = a.yaw + yawDelta * t;
+        frame.pitch = glm::mix(a.pitch, b.pitch, t);
+        frame.fov = glm::mix(a.fov, b.fov, t);
+    }
+
+    camera.setPosition(frame.position);
+    camera.setOrientation(frame.yaw, frame.pitch);
+    camera.setFov(frame.fov);
+}
+
+bool CameraPath::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::CAMERA_PATH:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    // Enough digits to reproduce every float exactly
+    file << std::setprecision(9);
+    file << "# Scilla camera path: time x y z yaw pitch fov\n";
+    file << "dayTime " << m_startDayTime << "\n";
+    for (const auto& [time, position, yaw, pitch, fov] : m_keyframes) {
+        file << time << ' ' << position.x << ' ' << position.y << ' ' << position.z << ' '
+             << yaw << ' ' << pitch << ' ' << fov << '\n';
+    }
+
+    std::cout << "Camera path written to " << path << " (" << m_keyframes.size() << " keyframes, "
+              << getDuration() << " s)" << std::endl;
+    return true;
+}
+
+bool CameraPath::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::CAMERA_PATH:: Could not open " << path << std::endl;
+        return false;
+    }
+
+    clear();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream stream(line);
+        if (line.starts_with("dayTime")) {
+            std::string key;
+            stream >> key >> m_startDayTime;
+            continue;
+        }
+
+        Keyframe frame{};
+        if (!(stream >> frame.time >> frame.position.x >> frame.position.y >> frame.position.z
+                     >> frame.yaw >> frame.pitch >> frame.fov)) {
+            std::cerr << "ERROR::CAMERA_PATH:: " << path << ":" << lineNumber << " is not a keyframe" << std::endl;
+            clear();
+            return false;
+        }
+        if (!m_keyframes.empty() && frame.time <= m_keyframes.back().time) {
+            std::cerr << "ERROR::CAMERA_PATH:: " << path << ":" << lineNumber << " goes back in time" << std::endl;
+            clear();
+            return false;
+        }
+        m_keyframes.push_back(frame);
+    }
+
+    if (m_keyframes.empty()) {
+        std::cerr << "ERROR::CAMERA_PATH:: " << path << " has no keyframes" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Camera;
+
+// Camera keyframes over time, recorded from a live session (F8) and played back with a fixed time step
+// (--camera-path), so different builds render the exact same flythrough.
+// Stored as text, one keyframe per line: time x y z yaw pitch fov
+class CameraPath {
+public:
+    struct Keyframe {
+        float time; // seconds since the start of the recording
+        glm::vec3 position;
+        float yaw;   // degrees
+        float pitch;
+        float fov;
+    };
+
+    void clear();
+    void addKeyframe(float time, const Camera& camera);
+
+    // Interpolates between the surrounding keyframes, holds the first/last one outside the recorded range
+    void apply(Camera& camera, float time) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // Scene day time when recording started, playback resets the scene to it so the lighting matches
+    void setStartDayTime(const float dayTime) { m_startDayTime = dayTime; }
+    [[nodiscard]] float getStartDayTime() const { return m_startDayTime; }
+
+    [[nodiscard]] float getDuration() const { return m_keyframes.empty() ? 0.0f : m_keyframes.back().time; }
+    [[nodiscard]] size_t getKeyframeCount() const { return m_keyframes.size(); }
+    [[nodiscard]] bool empty() const { return m_keyframes.empty(); }
+
+private:
+    std::vector<Keyframe> m_keyframes; // sorted by time
+    float m_startDayTime = 0.0f;
+};
@@ -0,0 +1,66 @@
+#include "FrameUBO.h"
+
+#include <algorithm>
+#include <iostream>
+
+void FrameUBO::initialize() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const GLsizeiptr alignedSize = (sizeof(FrameData) + alignment - 1) / alignment * alignment;
+    m_buffer.generate(MAX_VIEWS * alignedSize); // MAX_VIEWS aligned copies per region
+}
+
+void FrameUBO::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+                      const glm::vec3& sunDirection, const float time, const float dayTime,
+                      const int width, const int height) {
+    const float previousTime = m_data.time.x;
+
+    m_data.view = view;
+    m_data.projection = projection;
+    m_data.viewProj = projection * view;
+    m_data.invView = glm::inverse(view);
+    m_data.invProjection = glm::inverse(projection);
+    m_data.invViewProj = glm::inverse(m_data.viewProj);
+
+    m_frustum = Frustum::fromViewProj(m_data.viewProj);
+    std::ranges::copy(m_frustum.planes, m_data.frustumPlanes);
+
+    m_data.viewPos = glm::vec4(viewPos, 1.0f);
+    m_data.sunDirection = glm::vec4(sunDirection, 0.0f);
+    m_data.time = glm::vec4(time, time - previousTime, dayTime, 0.0f);
+    m_data.resolution = glm::vec4(width, height, 1.0f / static_cast<float>(width), 1.0f / static_cast<float>(height));
+
+    m_buffer.beginFrame();
+    m_offset = m_buffer.write(&m_data, sizeof(FrameData));
+    bind();
+}
+
+void FrameUBO::bindView(const glm::mat4& view, const glm::mat4& projection) {
+    FrameData data = m_data;
+    data.view = view;
+    data.projection = projection;
+    data.viewProj = projection * view;
+    data.invView = glm::inverse(view);
+    data.invProjection = glm::inverse(projection);
+    data.invViewProj = glm::inverse(data.viewProj);
+    std::ranges::copy(Frustum::fromViewProj(data.viewProj).planes, data.frustumPlanes);
+
+    const GLintptr offset = m_buffer.write(&data, sizeof(FrameData));
+    if (offset < 0) {
+        std::cerr << "WARNING::FRAME_UBO:: More than " << MAX_VIEWS << " views this frame" << std::endl;
+        return;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, BINDING_POINT, m_buffer.getID(), offset, sizeof(FrameData));
+}
+
+void FrameUBO::bind() const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, BINDING_POINT, m_buffer.getID(), m_offset, sizeof(FrameData));
+}
+
+void FrameUBO::setSkyIrradiance(const std::array<glm::vec4, 9>& coefficients) {
+    std::ranges::copy(coefficients, m_data.skySH);
+}
+
+void FrameUBO::endFrame() {
+    m_buffer.endFrame();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "graphics/buffers/StreamingBuffer.h"
+
+// The raw data structure that matches the GPU memory layout (std140) of assets/shaders/frame_data.glsl
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProj;
+    glm::mat4 invView;
+    glm::mat4 invProjection;
+    glm::mat4 invViewProj;
+    glm::vec4 frustumPlanes[6]; // Frustum::planes
+    glm::vec4 viewPos;          // w unused
+    glm::vec4 sunDirection;     // w unused
+    glm::vec4 time;             // x: seconds since start, y: delta, z: day time
+    glm::vec4 resolution;       // xy: pixels, zw: 1 / pixels
+    glm::vec4 skySH[9];         // SkyIrradiance::Coefficients
+    glm::vec4 fog;              // HeightFog::getShaderParams
+};
+
+static_assert(sizeof(FrameData) == 6 * sizeof(glm::mat4) + 20 * sizeof(glm::vec4), "FrameData must match std140");
+
+// Per-frame constants for every shader, bound to binding point 0. Written once per frame into a
+// triple-buffered persistently mapped ring, so updating it never waits for the GPU to finish the previous frame.
+// The CPU copy stays readable: CPU culling tests against exactly the frustum the shaders use.
+class FrameUBO {
+public:
+    static constexpr GLuint BINDING_POINT = 0;
+    static constexpr int MAX_VIEWS = 8; // per frame, the camera plus views like the shadow cascades
+
+    void initialize();
+
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+                const glm::vec3& sunDirection, float time, float dayTime, int width, int height);
+    void endFrame(); // after the frame's commands are submitted, fences its region
+
+    void setSkyIrradiance(const std::array<glm::vec4, 9>& coefficients); // picked up by the next update
+    void setFog(const glm::vec4& fog) { m_data.fog = fog; } // the same
+
+    // Binds a copy of this frame's constants seen from another view, so the usual vertex shaders can render
+    // e.g. shadow maps. bind() switches back to the camera.
+    void bindView(const glm::mat4& view, const glm::mat4& projection);
+    void bind() const;
+
+    [[nodiscard]] const FrameData& getData() const { return m_data; }
+    [[nodiscard]] const Frustum& getFrustum() const { return m_frustum; } // same planes as FrameData
+
+private:
+    FrameData m_data{};
+    Frustum m_frustum{};
+    StreamingBuffer m_buffer;
+    GLintptr m_offset = 0; // the camera's constants in the current region
+};
@@ -0,0 +1,253 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+#include "utils/Parallel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCILLA_FRUSTUM_X86 1
+#include <immintrin.h>
+#else
+#define SCILLA_FRUSTUM_X86 0
+#endif
+
+Frustum Frustum::fromViewProj(const glm::mat4& viewProj) {
+    // Each clip plane is the fourth row of the matrix plus or minus one of the others.
+    // glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    const glm::mat4& m = viewProj;
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum{};
+    frustum.planes[PLANE_LEFT] = row3 + row0;
+    frustum.planes[PLANE_RIGHT] = row3 - row0;
+    frustum.planes[PLANE_BOTTOM] = row3 + row1;
+    frustum.planes[PLANE_TOP] = row3 - row1;
+    frustum.planes[PLANE_NEAR] = row3 + row2;
+    frustum.planes[PLANE_FAR] = row3 - row2;
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, const float radius) const {
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+bool Frustum::intersectsAabb(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+    const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+
+    for (const glm::vec4& plane : planes) {
+        // Projected radius of the box onto the plane normal
+        const float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+namespace {
+    using FrustumCulling::Path;
+
+    // The scalar loops also handle the tails the SIMD loops leave over
+    void spheresScalar(const Frustum& frustum, const SphereArrays& s, uint8_t* visible, const size_t begin) {
+        for (size_t i = begin; i < s.count; i++) {
+            visible[i] = frustum.intersectsSphere({s.x[i], s.y[i], s.z[i]}, s.radius[i]) ? 1 : 0;
+        }
+    }
+
+    void aabbsScalar(const Frustum& frustum, const AabbArrays& b, uint8_t* visible, const size_t begin) {
+        for (size_t i = begin; i < b.count; i++) {
+            bool inside = true;
+            for (const glm::vec4& plane : frustum.planes) {
+                const float radius = std::abs(plane.x) * b.extentX[i] + std::abs(plane.y) * b.extentY[i] + std::abs(plane.z) * b.extentZ[i];
+                const float distance = plane.x * b.centerX[i] + plane.y * b.centerY[i] + plane.z * b.centerZ[i] + plane.w;
+                inside = inside && distance >= -radius;
+            }
+            visible[i] = inside ? 1 : 0;
+        }
+    }
+
+    void writeMask(uint8_t* visible, const int mask, const int lanes) {
+        for (int lane = 0; lane < lanes; lane++) {
+            visible[lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+
+#if SCILLA_FRUSTUM_X86
+    // One sphere per lane, planes broadcast. The multiply-adds are kept in the scalar order (x, y, z, w)
+    // so the results match the scalar path exactly.
+    size_t spheresSse(const Frustum& frustum, const SphereArrays& s, uint8_t* visible) {
+        const size_t end = s.count & ~size_t(3);
+        for (size_t i = 0; i < end; i += 4) {
+            const __m128 x = _mm_loadu_ps(s.x + i);
+            const __m128 y = _mm_loadu_ps(s.y + i);
+            const __m128 z = _mm_loadu_ps(s.z + i);
+            const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(s.radius + i));
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.planes) {
+                __m128 distance = _mm_mul_ps(_mm_set1_ps(plane.x), x);
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), y));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+                distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+            }
+            writeMask(visible + i, _mm_movemask_ps(inside), 4);
+        }
+        return end;
+    }
+
+    size_t aabbsSse(const Frustum& frustum, const AabbArrays& b, uint8_t* visible) {
+        const size_t end = b.count & ~size_t(3);
+        for (size_t i = 0; i < end; i += 4) {
+            const __m128 cx = _mm_loadu_ps(b.centerX + i);
+            const __m128 cy = _mm_loadu_ps(b.centerY + i);
+            const __m128 cz = _mm_loadu_ps(b.centerZ + i);
+            const __m128 ex = _mm_loadu_ps(b.extentX + i);
+            const __m128 ey = _mm_loadu_ps(b.extentY + i);
+            const __m128 ez = _mm_loadu_ps(b.extentZ + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.planes) {
+                __m128 radius = _mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex);
+                radius = _mm_add_ps(radius, _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey));
+                radius = _mm_add_ps(radius, _mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez));
+
+                __m128 distance = _mm_mul_ps(_mm_set1_ps(plane.x), cx);
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), cy));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), cz));
+                distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+            }
+            writeMask(visible + i, _mm_movemask_ps(inside), 4);
+        }
+        return end;
+    }
+
+    // AVX is not part of the x86-64 baseline, these are compiled for it explicitly and only called after
+    // the runtime check in resolve()
+    __attribute__((target("avx")))
+    size_t spheresAvx(const Frustum& frustum, const SphereArrays& s, uint8_t* visible) {
+        const size_t end = s.count & ~size_t(7);
+        for (size_t i = 0; i < end; i += 8) {
+            const __m256 x = _mm256_loadu_ps(s.x + i);
+            const __m256 y = _mm256_loadu_ps(s.y + i);
+            const __m256 z = _mm256_loadu_ps(s.z + i);
+            const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(s.radius + i));
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.planes) {
+                __m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+            }
+            writeMask(visible + i, _mm256_movemask_ps(inside), 8);
+        }
+        return end;
+    }
+
+    __attribute__((target("avx")))
+    size_t aabbsAvx(const Frustum& frustum, const AabbArrays& b, uint8_t* visible) {
+        const size_t end = b.count & ~size_t(7);
+        for (size_t i = 0; i < end; i += 8) {
+            const __m256 cx = _mm256_loadu_ps(b.centerX + i);
+            const __m256 cy = _mm256_loadu_ps(b.centerY + i);
+            const __m256 cz = _mm256_loadu_ps(b.centerZ + i);
+            const __m256 ex = _mm256_loadu_ps(b.extentX + i);
+            const __m256 ey = _mm256_loadu_ps(b.extentY + i);
+            const __m256 ez = _mm256_loadu_ps(b.extentZ + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.planes) {
+                __m256 radius = _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.x)), ex);
+                radius = _mm256_add_ps(radius, _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.y)), ey));
+                radius = _mm256_add_ps(radius, _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.z)), ez));
+
+                __m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), cx);
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), cy));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), cz));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), radius), _CMP_GE_OQ));
+            }
+            writeMask(visible + i, _mm256_movemask_ps(inside), 8);
+        }
+        return end;
+    }
+#endif
+
+    SphereArrays subRange(const SphereArrays& s, const size_t begin, const size_t end) {
+        return {s.x + begin, s.y + begin, s.z + begin, s.radius + begin, end - begin};
+    }
+
+    AabbArrays subRange(const AabbArrays& b, const size_t begin, const size_t end) {
+        return {b.centerX + begin, b.centerY + begin, b.centerZ + begin,
+                b.extentX + begin, b.extentY + begin, b.extentZ + begin, end - begin};
+    }
+}
+
+FrustumCulling::Path FrustumCulling::resolve(const Path path) {
+#if SCILLA_FRUSTUM_X86
+    static const bool hasAvx = __builtin_cpu_supports("avx");
+    if (path == Path::Auto) return hasAvx ? Path::AVX : Path::SSE;
+    if (path == Path::AVX && !hasAvx) return Path::SSE;
+    return path;
+#else
+    return Path::Scalar;
+#endif
+}
+
+const char* FrustumCulling::getName(const Path path) {
+    switch (path) {
+        case Path::Scalar: return "scalar";
+        case Path::SSE: return "SSE";
+        case Path::AVX: return "AVX";
+        default: return "auto";
+    }
+}
+
+void FrustumCulling::cullSpheres(const Frustum& frustum, const SphereArrays& spheres, uint8_t* visible, const Path path) {
+    size_t done = 0;
+#if SCILLA_FRUSTUM_X86
+    switch (resolve(path)) {
+        case Path::SSE: done = spheresSse(frustum, spheres, visible); break;
+        case Path::AVX: done = spheresAvx(frustum, spheres, visible); break;
+        default: break;
+    }
+#endif
+    spheresScalar(frustum, spheres, visible, done);
+}
+
+void FrustumCulling::cullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint8_t* visible, const Path path) {
+    size_t done = 0;
+#if SCILLA_FRUSTUM_X86
+    switch (resolve(path)) {
+        case Path::SSE: done = aabbsSse(frustum, boxes, visible); break;
+        case Path::AVX: done = aabbsAvx(frustum, boxes, visible); break;
+        default: break;
+    }
+#endif
+    aabbsScalar(frustum, boxes, visible, done);
+}
+
+void FrustumCulling::cullSpheresParallel(const Frustum& frustum, const SphereArrays& spheres, uint8_t* visible, const Path path) {
+    Parallel::forRange(0, static_cast<int>(spheres.count), [&](const int begin, const int end) {
+        cullSpheres(frustum, subRange(spheres, begin, end), visible + begin, path);
+    }, MIN_PARALLEL_COUNT);
+}
+
+void FrustumCulling::cullAabbsParallel(const Frustum& frustum, const AabbArrays& boxes, uint8_t* visible, const Path path) {
+    Parallel::forRange(0, static_cast<int>(boxes.count), [&](const int begin, const int end) {
+        cullAabbs(frustum, subRange(boxes, begin, end), visible + begin, path);
+    }, MIN_PARALLEL_COUNT);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// View frustum as six planes extracted from a view-projection matrix (Gribb/Hartmann).
+// Normals point inside and are normalized, so dot(normal, p) + w is the signed distance of p to the plane.
+struct Frustum {
+    enum Plane { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+    glm::vec4 planes[PLANE_COUNT];
+
+    static Frustum fromViewProj(const glm::mat4& viewProj);
+
+    // Conservative: objects crossing a corner outside the frustum may still be reported as visible
+    [[nodiscard]] bool intersectsSphere(const glm::vec3& center, float radius) const;
+    [[nodiscard]] bool intersectsAabb(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+};
+
+// Bounds as separate arrays (structure of arrays), so the SIMD paths load 4 or 8 objects per instruction
+struct SphereArrays {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* radius;
+    size_t count;
+};
+
+struct AabbArrays {
+    const float* centerX;
+    const float* centerY;
+    const float* centerZ;
+    const float* extentX; // half size
+    const float* extentY;
+    const float* extentZ;
+    size_t count;
+};
+
+// Batched frustum tests shared by every CPU culling feature. visible[i] is set to 1 when object i intersects
+// the frustum and 0 otherwise. The SIMD paths give the same results as the scalar one.
+namespace FrustumCulling {
+    enum class Path {
+        Auto,   // AVX when the CPU supports it, otherwise SSE (scalar on non-x86)
+        Scalar,
+        SSE,    // 4 objects per iteration
+        AVX,    // 8 objects per iteration
+    };
+
+    // Below this many objects the parallel variants stay on the calling thread
+    constexpr int MIN_PARALLEL_COUNT = 16384;
+
+    void cullSpheres(const Frustum& frustum, const SphereArrays& spheres, uint8_t* visible, Path path = Path::Auto);
+    void cullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint8_t* visible, Path path = Path::Auto);
+
+    // Split into contiguous ranges over Parallel::forRange workers
+    void cullSpheresParallel(const Frustum& frustum, const SphereArrays& spheres, uint8_t* visible, Path path = Path::Auto);
+    void cullAabbsParallel(const Frustum& frustum, const AabbArrays& boxes, uint8_t* visible, Path path = Path::Auto);
+
+    [[nodiscard]] Path resolve(Path path); // what a request runs as on this CPU
+    [[nodiscard]] const char* getName(Path path);
+}
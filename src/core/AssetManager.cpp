@@ -3,8 +3,10 @@
 #include "AssetManager.h"
 
 #include "graphics/Texture.h"
+#include "graphics/TextureLoader.h"
 #include "graphics/Shader.h"
 #include "graphics/Model.h"
+#include "utils/Profiler.h"
 
 AssetManager &AssetManager::get() { // Meyers singleton
     static AssetManager instance;
@@ -14,18 +16,34 @@ AssetManager &AssetManager::get() { // Meyers singleton
 std::shared_ptr<Texture> AssetManager::loadTexture(
     const std::string &path,
     bool isColorData,
-    bool flipVertically) {
+    bool flipVertically,
+    const Texture::Usage usage) {
+    PROFILE_SCOPE("AssetManager::loadTexture");
     if (m_textures.contains(path)) {
         return m_textures[path]; // Return cached textures
     }
 
     auto texture = std::make_shared<Texture>(
-        path, isColorData, flipVertically);
+        path, isColorData, flipVertically, usage);
 
     m_textures[path] = texture; // Cache the loaded textures
     return texture; // Return copy of shared_ptr
 }
 
+std::shared_ptr<Texture> AssetManager::loadTextureAsync(
+    const std::string &path,
+    const Texture::Usage usage,
+    bool isColorData,
+    bool flipVertically) {
+    if (m_textures.contains(path)) {
+        return m_textures[path]; // Cached, possibly still loading
+    }
+
+    auto texture = TextureLoader::get().load(path, usage, isColorData, flipVertically);
+    m_textures[path] = texture;
+    return texture;
+}
+
 std::shared_ptr<Shader> AssetManager::loadShader(
     const std::string &vertPath,
     const std::string &fragPath) {
@@ -39,8 +57,19 @@ std::shared_ptr<Shader> AssetManager::loadShader(
     return shader;
 }
 
+std::shared_ptr<Shader> AssetManager::loadComputeShader(
+    const std::string &computePath) {
+    if (m_shaders.contains(computePath))
+        return m_shaders[computePath];
+
+    auto shader = std::make_shared<Shader>(computePath);
+    m_shaders[computePath] = shader;
+    return shader;
+}
+
 std::shared_ptr<Model> AssetManager::loadModel(
     const std::string &path) {
+    PROFILE_SCOPE("AssetManager::loadModel");
     if (m_models.contains(path))
         return m_models[path];
 
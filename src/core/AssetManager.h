@@ -4,7 +4,9 @@
 #include <string>
 #include <unordered_map>
 
-class Texture;
+#include "graphics/Texture.h"
+
+
 class Shader;
 class Model;
 
@@ -18,12 +20,23 @@ public:
     std::shared_ptr<Texture> loadTexture(
         const std::string& path,
         bool isColorData = true,
+        bool flipVertically = true,
+        Texture::Usage usage = Texture::Usage::Color);
+
+    // Returns at once, decoded and uploaded in the background by TextureLoader, binds the placeholder until then
+    std::shared_ptr<Texture> loadTextureAsync(
+        const std::string& path,
+        Texture::Usage usage,
+        bool isColorData = true,
         bool flipVertically = true);
 
     std::shared_ptr<Shader> loadShader(
         const std::string& vertPath,
         const std::string& fragPath);
 
+    std::shared_ptr<Shader> loadComputeShader(
+        const std::string& computePath);
+
     std::shared_ptr<Model> loadModel(
         const std::string& path);
 
@@ -0,0 +1,161 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "camera/Camera.h"
+#include "camera/CameraPath.h"
+#include "utils/GpuProfiler.h"
+#include "world/Terrain.h"
+
+namespace {
+    // One lap around the middle of the 2048x2048 terrain, looking at its centre
+    const glm::vec3 PATH_CENTER(1024.0f, 0.0f, 1024.0f);
+    constexpr float PATH_RADIUS = 800.0f;
+    constexpr float PATH_ALTITUDE = 220.0f;
+    constexpr float MIN_GROUND_CLEARANCE = 40.0f;
+
+    // Nearest-rank percentile of sorted values
+    double percentile(const std::vector<double>& sorted, const double p) {
+        if (sorted.empty()) return 0.0;
+        const auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void writeString(std::ostream& out, const std::string& text) {
+        out << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+Benchmark::Benchmark(const int frames, const int warmupFrames)
+    : m_frames(frames), m_warmupFrames(warmupFrames) {
+    m_frameTimes.reserve(frames);
+}
+
+Benchmark::Benchmark(const CameraPath& path, const int warmupFrames)
+    : Benchmark(static_cast<int>(std::ceil(path.getDuration() / FIXED_DELTA_TIME)) + 1, warmupFrames) {
+    m_path = &path;
+}
+
+void Benchmark::applyCameraPath(Camera& camera, const Terrain& terrain, const int frame) const {
+    if (m_path) {
+        m_path->apply(camera, getPathTime(std::max(0, frame - m_warmupFrames)));
+        return;
+    }
+
+    const float t = static_cast<float>(frame) / static_cast<float>(std::max(1, getTotalFrames()));
+    const float angle = t * glm::two_pi<float>();
+
+    glm::vec3 position = PATH_CENTER + glm::vec3(std::sin(angle), 0.0f, std::cos(angle)) * PATH_RADIUS;
+    position.y = PATH_ALTITUDE + 60.0f * std::sin(2.0f * angle);
+    position.y = std::max(position.y, terrain.getHeightAt(position.x, position.z) + MIN_GROUND_CLEARANCE);
+
+    // Yaw/pitch follow Camera::updateView: x = sin(yaw), z = -cos(yaw)
+    const glm::vec3 toCenter = PATH_CENTER - position;
+    const float yaw = glm::degrees(std::atan2(toCenter.x, -toCenter.z));
+    const float pitch = glm::degrees(std::atan2(toCenter.y, glm::length(glm::vec2(toCenter.x, toCenter.z))));
+
+    camera.setPosition(position);
+    camera.setOrientation(yaw, pitch);
+}
+
+bool Benchmark::writeFrameLog(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::BENCHMARK:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame,pathTime,frameMs\n";
+    for (size_t i = 0; i < m_frameTimes.size(); i++) {
+        file << i << ',' << getPathTime(static_cast<int>(i)) << ',' << m_frameTimes[i] << '\n';
+    }
+
+    std::cout << "Frame times written to " << path << std::endl;
+    return true;
+}
+
+void Benchmark::recordFrame(const int frame, const double ms) {
+    if (frame >= m_warmupFrames) {
+        m_frameTimes.push_back(ms);
+    }
+}
+
+bool Benchmark::writeResults(const std::string& path, const int width, const int height, const std::string& renderPath,
+                             const std::vector<StartupPhase>& startupPhases, const GpuProfiler& gpuProfiler) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::BENCHMARK:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    std::vector<double> sorted = m_frameTimes;
+    std::ranges::sort(sorted);
+    const double total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+    const double mean = sorted.empty() ? 0.0 : total / static_cast<double>(sorted.size());
+
+    const auto* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"renderer\": ";
+    writeString(file, renderer ? renderer : "unknown");
+    file << ",\n";
+    file << "  \"resolution\": [" << width << ", " << height << "],\n";
+    file << "  \"renderPath\": ";
+    writeString(file, renderPath);
+    file << ",\n";
+    file << "  \"frames\": " << m_frameTimes.size() << ",\n";
+    file << "  \"warmupFrames\": " << m_warmupFrames << ",\n";
+
+    file << "  \"frameTimeMs\": {\n";
+    file << "    \"mean\": " << mean << ",\n";
+    file << "    \"min\": " << (sorted.empty() ? 0.0 : sorted.front()) << ",\n";
+    file << "    \"p50\": " << percentile(sorted, 50.0) << ",\n";
+    file << "    \"p90\": " << percentile(sorted, 90.0) << ",\n";
+    file << "    \"p95\": " << percentile(sorted, 95.0) << ",\n";
+    file << "    \"p99\": " << percentile(sorted, 99.0) << ",\n";
+    file << "    \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "\n";
+    file << "  },\n";
+    file << "  \"fps\": " << (mean > 0.0 ? 1000.0 / mean : 0.0) << ",\n";
+
+    // Whole-run averages, the GPU profiler totals were reset when the warmup ended
+    const int gpuFrames = std::max(1, gpuProfiler.getTotalFrames());
+    file << "  \"gpuFrameMs\": " << gpuProfiler.getFrameGpuTotal() / gpuFrames << ",\n";
+    file << "  \"passes\": [\n";
+    const auto& zones = gpuProfiler.getZones();
+    for (size_t i = 0; i < zones.size(); i++) {
+        file << "    {\"name\": ";
+        writeString(file, zones[i].name);
+        file << ", \"cpuMs\": " << zones[i].cpuTotal / gpuFrames
+             << ", \"gpuMs\": " << zones[i].gpuTotal / gpuFrames << "}"
+             << (i + 1 < zones.size() ? "," : "") << "\n";
+    }
+    file << "  ],\n";
+
+    file << "  \"startupMs\": {\n";
+    for (size_t i = 0; i < startupPhases.size(); i++) {
+        file << "    ";
+        writeString(file, startupPhases[i].name);
+        file << ": " << startupPhases[i].ms << (i + 1 < startupPhases.size() ? "," : "") << "\n";
+    }
+    file << "  }\n";
+    file << "}\n";
+
+    std::cout << "Benchmark: " << m_frameTimes.size() << " frames, mean " << mean << " ms, p99 "
+              << percentile(sorted, 99.0) << " ms, written to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class Camera;
+class CameraPath;
+class Terrain;
+class GpuProfiler;
+
+// Deterministic benchmark run (scilla --benchmark). The camera flies a scripted path, or a recorded CameraPath,
+// that only depends on the frame index and the scene advances by a fixed time step, so two runs render the same frames.
+// Results are written as JSON: frame time percentiles, per-pass CPU/GPU times and startup phase durations.
+// Also drives windowed camera path playback, where the same fixed step replaces the measured frame time.
+class Benchmark {
+public:
+    struct StartupPhase {
+        std::string name;
+        double ms;
+    };
+
+    static constexpr float FIXED_DELTA_TIME = 1.0f / 60.0f;
+
+    Benchmark(int frames, int warmupFrames);
+    Benchmark(const CameraPath& path, int warmupFrames); // as many frames as the path lasts, warmup holds its start
+
+    void applyCameraPath(Camera& camera, const Terrain& terrain, int frame) const;
+    void recordFrame(int frame, double ms); // warmup frames are not recorded
+
+    // renderPath: which opaque path the run measured, so runs of both can be told apart when compared
+    bool writeResults(const std::string& path, int width, int height, const std::string& renderPath,
+                      const std::vector<StartupPhase>& startupPhases, const GpuProfiler& gpuProfiler) const;
+    bool writeFrameLog(const std::string& path) const; // CSV: frame, path time, frame time
+
+    [[nodiscard]] static float getPathTime(int measuredFrame) { return static_cast<float>(measuredFrame) * FIXED_DELTA_TIME; }
+
+    [[nodiscard]] int getTotalFrames() const { return m_warmupFrames + m_frames; }
+    [[nodiscard]] int getWarmupFrames() const { return m_warmupFrames; }
+
+private:
+    const CameraPath* m_path = nullptr; // null: scripted circle around the terrain
+    int m_frames;
+    int m_warmupFrames;
+    std::vector<double> m_frameTimes; // ms
+};
@@ -3,11 +3,16 @@
 // If we add physics or audio, those systems would also be managed here.
 
 #include "Engine.h"
+#include <chrono>
 #include <iostream>
 
 #include <imgui.h>
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "MicroBenchmarks.h"
+#include "graphics/MeshOptimizer.h"
+#include "graphics/TextureLoader.h"
+#include "utils/Profiler.h"
 
 void framebuffer_size_callback(GLFWwindow* window, const int width, const int height) {
     if(auto* engine = static_cast<Engine*>(glfwGetWindowUserPointer(window))) engine->handleResize(width, height);
@@ -25,8 +30,69 @@ void Engine::keyCallbackStatic(GLFWwindow* window, int key, int scancode, int ac
     }
 }
 
-bool Engine::initialize(const int width, const int height, const char* title) {
+bool Engine::initialize(const int width, const int height, const char* title, const EngineOptions& options) {
     std::cout << "Engine::initialize - this = " << this << std::endl;
+    m_options = options;
+
+    Profiler::setThreadName("Main");
+    if (m_options.traceFrames > 0) {
+        Profiler::beginCapture(); // include startup
+    }
+    PROFILE_SCOPE("Engine::initialize");
+    MeshOptimizer::setReporting(m_options.meshStats);
+
+    // Startup phase durations end up in the benchmark results
+    auto phaseStart = std::chrono::steady_clock::now();
+    const auto endPhase = [this, &phaseStart](const std::string& name) {
+        const auto now = std::chrono::steady_clock::now();
+        m_startupPhases.push_back({name, std::chrono::duration<double, std::milli>(now - phaseStart).count()});
+        phaseStart = now;
+    };
+
+    const bool headless = m_options.benchmark || !m_options.microbench.empty();
+    if (!(headless ? createHeadlessContext(width, height) : createWindow(width, height, title))) {
+        return false;
+    }
+    endPhase("context");
+
+    // Microbenchmarks only need the GL context
+    if (!m_options.microbench.empty()) {
+        return true;
+    }
+
+    // Initialize Components
+    m_inputHandler = std::make_unique<InputHandler>(m_window); // no window (and no input) when headless
+
+    m_renderer = std::make_unique<Renderer>();
+    m_renderer->setImGuiEnabled(!m_options.benchmark);
+    m_renderer->setVisibilityBuffer(m_options.visibilityBuffer);
+    m_renderer->setDynamicResolution(!m_options.benchmark); // benchmark runs compare a fixed workload
+    m_renderer->initialize();
+
+    // The framebuffer size callback only fires on changes, size the render targets for the initial window
+    int framebufferWidth = width, framebufferHeight = height;
+    if (m_window) {
+        glfwGetFramebufferSize(m_window, &framebufferWidth, &framebufferHeight);
+    }
+    m_renderer->resize(framebufferWidth, framebufferHeight);
+    endPhase("renderer");
+
+    m_scene = std::make_unique<Scene>();
+    m_scene->initialize();
+    m_scene->setFireflyCount(m_options.pointLights);
+    endPhase("scene");
+
+    // Textures stream in over the first frames when windowed, a benchmark measures the finished scene
+    if (m_options.benchmark) {
+        TextureLoader::get().finish();
+        endPhase("textures");
+    }
+
+    return true;
+}
+
+bool Engine::createWindow(const int width, const int height, const char* title) {
+    PROFILE_SCOPE("Engine::createWindow");
     glfwInit();
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -65,30 +131,64 @@ bool Engine::initialize(const int width, const int height, const char* title) {
     ImGui_ImplGlfw_InitForOpenGL(m_window, true);
     ImGui_ImplOpenGL3_Init("#version 460");
 
-    // Initialize Components
-    m_inputHandler = std::make_unique<InputHandler>(m_window);
+    return true;
+}
 
-    m_renderer = std::make_unique<Renderer>();
-    m_renderer->initialize();
+bool Engine::createHeadlessContext(const int width, const int height) {
+    PROFILE_SCOPE("Engine::createHeadlessContext");
+    m_headless = std::make_unique<HeadlessContext>();
+    return m_headless->create(width, height);
+}
 
-    m_scene = std::make_unique<Scene>();
-    m_scene->initialize();
+bool Engine::run() {
+    if (!m_options.microbench.empty()) {
+        return MicroBenchmarks::run(m_options.microbench, m_options.microbenchPath);
+    }
 
-    return true;
-}
+    if (m_options.benchmark) {
+        return runBenchmark();
+    }
+
+    bool succeeded = true;
+    if (!m_options.cameraPath.empty()) {
+        succeeded = m_cameraPath.load(m_options.cameraPath);
+        if (succeeded) startPlayback();
+    }
 
-void Engine::run() {
     while (!glfwWindowShouldClose(m_window)) {
+        PROFILE_SCOPE("Frame");
         m_frameTimer.update();
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        if (m_inputHandler->shouldToggleCapture()) {
+            toggleProfileCapture();
+            m_inputHandler->resetCaptureFlag();
+        }
+
+        if (m_inputHandler->shouldToggleRecording()) {
+            toggleRecording();
+            m_inputHandler->resetRecordingFlag();
+        }
 
         if (m_inputHandler->shouldReloadShaders()) {
             m_renderer->reloadShaders();
             m_inputHandler->resetReloadFlag();
         }
 
+        // Playback steps by the fixed time step instead of the measured one, so the flythrough and the
+        // scene animation are identical no matter how fast the frames are
+        const float deltaTime = m_playback ? Benchmark::FIXED_DELTA_TIME : m_frameTimer.getDeltaTime();
+
         // Logic
         if (m_scene) {
-            m_scene->update(m_frameTimer.getDeltaTime(), *m_inputHandler);
+            m_scene->update(deltaTime, *m_inputHandler);
+
+            if (m_playback) {
+                m_playback->applyCameraPath(m_scene->getCamera(), m_scene->getTerrain(), m_playbackFrame);
+            } else if (m_recording) {
+                m_cameraPath.addKeyframe(m_recordTime, m_scene->getCamera());
+                m_recordTime += deltaTime;
+            }
         }
 
         // Render
@@ -97,15 +197,129 @@ void Engine::run() {
         }
 
         glfwPollEvents();
-        glfwSwapBuffers(m_window);
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(m_window);
+        }
+
+        if (m_playback) {
+            m_playback->recordFrame(m_playbackFrame, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+            if (++m_playbackFrame == m_playback->getTotalFrames()) {
+                succeeded = finishPlayback() && succeeded;
+            }
+        }
+
+        updateTraceCapture();
+    }
+
+    if (m_recording) {
+        toggleRecording(); // don't lose a recording by closing the window
+    }
+    return succeeded;
+}
+
+void Engine::toggleRecording() {
+    if (m_playback) {
+        std::cout << "Camera path playback in progress, not recording" << std::endl;
+        return;
+    }
+
+    m_recording = !m_recording;
+    if (m_recording) {
+        m_cameraPath.clear();
+        m_cameraPath.setStartDayTime(m_scene->getDayTime());
+        m_recordTime = 0.0f;
+        std::cout << "Recording camera path (F8 to stop)" << std::endl;
+    } else {
+        m_cameraPath.save(m_options.recordPath);
+    }
+}
+
+void Engine::startPlayback() {
+    m_playback = std::make_unique<Benchmark>(m_cameraPath, 0);
+    m_playbackFrame = 0;
+    m_scene->setDayTime(m_cameraPath.getStartDayTime());
+    std::cout << "Playing camera path " << m_options.cameraPath << " (" << m_playback->getTotalFrames() << " frames)" << std::endl;
+}
+
+bool Engine::finishPlayback() {
+    std::cout << "Camera path playback finished" << std::endl;
+    const bool written = m_options.frameLogPath.empty() || m_playback->writeFrameLog(m_options.frameLogPath);
+    m_playback.reset();
+    return written;
+}
+
+bool Engine::runBenchmark() {
+    const bool recordedPath = !m_options.cameraPath.empty();
+    if (recordedPath && !m_cameraPath.load(m_options.cameraPath)) {
+        return false;
+    }
+
+    Benchmark benchmark = recordedPath ? Benchmark(m_cameraPath, m_options.warmupFrames)
+                                       : Benchmark(m_options.benchmarkFrames, m_options.warmupFrames);
+    GpuProfiler& gpuProfiler = m_renderer->getGpuProfiler();
+
+    std::cout << "Benchmark: " << benchmark.getWarmupFrames() << " warmup + "
+              << benchmark.getTotalFrames() - benchmark.getWarmupFrames() << " frames" << std::endl;
+
+    for (int frame = 0; frame < benchmark.getTotalFrames(); frame++) {
+        PROFILE_SCOPE("Frame");
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        if (frame == benchmark.getWarmupFrames()) {
+            gpuProfiler.flush(); // don't let late warmup readbacks into the totals
+            gpuProfiler.resetTotals();
+
+            if (recordedPath) {
+                m_scene->setDayTime(m_cameraPath.getStartDayTime()); // the measured frames light the scene like the recording
+            }
+        }
+
+        benchmark.applyCameraPath(m_scene->getCamera(), m_scene->getTerrain(), frame);
+        m_scene->update(Benchmark::FIXED_DELTA_TIME, *m_inputHandler);
+        m_renderer->render(*m_scene, *m_inputHandler);
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            m_headless->swapBuffers();
+        }
+
+        benchmark.recordFrame(frame, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        updateTraceCapture();
+    }
+
+    gpuProfiler.flush();
+    bool written = benchmark.writeResults(m_options.benchmarkPath, m_options.width, m_options.height,
+                                          m_renderer->isVisibilityBufferActive() ? "visibilityBuffer" : "forward",
+                                          m_startupPhases, gpuProfiler);
+    if (!m_options.frameLogPath.empty()) {
+        written = benchmark.writeFrameLog(m_options.frameLogPath) && written;
+    }
+    return written;
+}
+
+void Engine::updateTraceCapture() {
+    if (++m_frameIndex == m_options.traceFrames && Profiler::isCapturing()) {
+        Profiler::endCapture(m_options.tracePath);
+    }
+}
+
+void Engine::toggleProfileCapture() const {
+    if (Profiler::isCapturing()) {
+        Profiler::endCapture(m_options.tracePath);
+    } else {
+        Profiler::beginCapture();
     }
 }
 
 void Engine::shutdown() {
-    // Cleanup ImGui
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    TextureLoader::get().shutdown(); // its GL objects need the context, which glfwTerminate() destroys
+
+    // Cleanup ImGui, headless runs never create it
+    if (ImGui::GetCurrentContext()) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
 
     glfwTerminate();
 }
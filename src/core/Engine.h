@@ -1,17 +1,46 @@
 #pragma once
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "Benchmark.h"
+#include "HeadlessContext.h"
+#include "camera/CameraPath.h"
 #include "Renderer.h"
 #include "Scene.h"
 #include "input/InputHandler.h"
 #include "utils/FrameTimer.h"
+#include <string>
+
+// Command line options, see main.cpp
+struct EngineOptions {
+    int width = 1280;
+    int height = 960;
+
+    int traceFrames = 0; // > 0: capture a CPU profile of startup and the first N frames
+    std::string tracePath = "scilla_trace.json";
+
+    bool benchmark = false; // headless, vsync off, scripted camera, see Benchmark
+    int benchmarkFrames = 1000;
+    int warmupFrames = 60;
+    std::string benchmarkPath = "benchmark.json";
+
+    std::string cameraPath; // non-empty: fly this recording with a fixed time step, windowed or as the benchmark path
+    std::string recordPath = "camera_path.txt"; // F8 recordings
+    std::string frameLogPath; // non-empty: per-frame times of a benchmark or playback as CSV
+
+    int pointLights = 256; // fireflies over the terrain, see Scene::setFireflyCount
+    bool visibilityBuffer = false; // terrain and trees through the visibility buffer instead of forward
+    bool meshStats = false; // print MeshOptimizer's before/after analysis of every imported mesh and the terrain
+
+    std::string microbench; // non-empty: run this MicroBenchmarks entry headless instead of the engine
+    std::string microbenchPath = "microbench.json";
+};
 
 class Engine {
 public:
     Engine() = default;
 
-    bool initialize(int width, int height, const char* title);
-    void run();
+    bool initialize(int width, int height, const char* title, const EngineOptions& options = {});
+    bool run(); // false if a benchmark, playback or its results failed, for the exit code
     static void shutdown();
 
     // Prevent copying
@@ -26,10 +55,30 @@ public:
 
 private:
     GLFWwindow* m_window = nullptr;
+    std::unique_ptr<HeadlessContext> m_headless; // benchmark mode, declared first so GL objects are freed before it
 
     std::unique_ptr<Scene> m_scene;
     std::unique_ptr<InputHandler> m_inputHandler;
     std::unique_ptr<Renderer> m_renderer;
 
     FrameTimer m_frameTimer;
+
+    EngineOptions m_options;
+    int m_frameIndex = 0;
+    std::vector<Benchmark::StartupPhase> m_startupPhases;
+
+    CameraPath m_cameraPath;              // being recorded (F8) or played back
+    std::unique_ptr<Benchmark> m_playback; // windowed playback of m_cameraPath
+    int m_playbackFrame = 0;
+    bool m_recording = false;
+    float m_recordTime = 0.0f;
+
+    bool createWindow(int width, int height, const char* title);
+    bool createHeadlessContext(int width, int height);
+    bool runBenchmark();
+    void toggleProfileCapture() const;
+    void toggleRecording();
+    void startPlayback();
+    bool finishPlayback();
+    void updateTraceCapture();
 };
\ No newline at end of file
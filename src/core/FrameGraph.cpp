@@ -0,0 +1,393 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+#include "utils/GpuProfiler.h"
+#include "utils/Profiler.h"
+
+namespace {
+    constexpr GLuint UNKNOWN_FRAMEBUFFER = std::numeric_limits<GLuint>::max();
+}
+
+// Pass builder
+
+FrameGraph::ResourceHandle FrameGraph::PassBuilder::create(const std::string& name, const TextureDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+
+    m_graph.m_resources.push_back(resource);
+    return static_cast<ResourceHandle>(m_graph.m_resources.size()) - 1;
+}
+
+FrameGraph::ResourceHandle FrameGraph::PassBuilder::read(const ResourceHandle resource) {
+    m_graph.m_passes[m_passIndex].reads.push_back(resource);
+    return resource;
+}
+
+FrameGraph::ResourceHandle FrameGraph::PassBuilder::write(const ResourceHandle resource) {
+    Pass& pass = m_graph.m_passes[m_passIndex];
+    pass.writes.push_back(resource);
+
+    if (m_graph.m_resources[resource].imported) {
+        pass.sideEffect = true; // the result outlives the frame
+    }
+    return resource;
+}
+
+FrameGraph::ResourceHandle FrameGraph::PassBuilder::writeColor(const ResourceHandle resource, const LoadOp loadOp, const glm::vec4& clearColor) {
+    write(resource);
+    m_graph.m_passes[m_passIndex].colorAttachments.push_back({resource, loadOp, clearColor, 1.0f});
+    return resource;
+}
+
+FrameGraph::ResourceHandle FrameGraph::PassBuilder::writeDepth(const ResourceHandle resource, const LoadOp loadOp, const float clearDepth) {
+    write(resource);
+    m_graph.m_passes[m_passIndex].depthAttachment = {resource, loadOp, glm::vec4(0.0f), clearDepth};
+    return resource;
+}
+
+void FrameGraph::PassBuilder::sideEffect() {
+    m_graph.m_passes[m_passIndex].sideEffect = true;
+}
+
+// Resources
+
+GLuint FrameGraph::Resources::getTexture(const ResourceHandle resource) const {
+    return m_graph.m_resources[resource].texture;
+}
+
+const FrameGraph::TextureDesc& FrameGraph::Resources::getDesc(const ResourceHandle resource) const {
+    return m_graph.m_resources[resource].desc;
+}
+
+// Frame graph
+
+FrameGraph::~FrameGraph() {
+    for (const auto& [key, fbo] : m_framebuffers) {
+        glDeleteFramebuffers(1, &fbo);
+    }
+    for (const auto& pooled : m_pool) {
+        glDeleteTextures(1, &pooled.texture);
+    }
+}
+
+FrameGraph::ResourceHandle FrameGraph::importTexture(const std::string& name, const GLuint texture, const TextureDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.texture = texture;
+    resource.imported = true;
+
+    m_resources.push_back(resource);
+    return static_cast<ResourceHandle>(m_resources.size()) - 1;
+}
+
+FrameGraph::ResourceHandle FrameGraph::importBackbuffer(const std::string& name, const int width, const int height) {
+    const ResourceHandle handle = importTexture(name, 0, {width, height, GL_SRGB8_ALPHA8});
+    m_resources[handle].backbuffer = true;
+    return handle;
+}
+
+void FrameGraph::addPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute) {
+    // Passes are added every frame, interning each name only once keeps the profiler's lock off the frame
+    auto profileName = m_profileNames.find(name);
+    if (profileName == m_profileNames.end()) {
+        profileName = m_profileNames.emplace(name, Profiler::internName(name)).first;
+    }
+
+    Pass pass;
+    pass.name = name;
+    pass.profileName = profileName->second;
+    pass.execute = execute;
+    m_passes.push_back(std::move(pass));
+
+    PassBuilder builder(*this, static_cast<int>(m_passes.size()) - 1);
+    setup(builder);
+}
+
+void FrameGraph::compile() {
+    PROFILE_SCOPE("FrameGraph::compile");
+    m_stats = {};
+    m_stats.passesTotal = static_cast<int>(m_passes.size());
+
+    cullPasses();
+    computeLifetimes();
+    allocateTransients();
+    evictUnusedTextures();
+}
+
+// A resource is needed if it is imported or read by a live pass, a pass is live if it has side effects
+// or writes a needed resource. Iterate until nothing changes, graphs are a handful of passes.
+void FrameGraph::cullPasses() {
+    for (auto& pass : m_passes) {
+        pass.culled = false;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (auto& resource : m_resources) {
+            resource.refCount = resource.imported ? 1 : 0;
+        }
+        for (const auto& pass : m_passes) {
+            if (pass.culled) continue;
+            for (const ResourceHandle r : pass.reads) {
+                m_resources[r].refCount++;
+            }
+        }
+
+        for (auto& pass : m_passes) {
+            if (pass.culled || pass.sideEffect) continue;
+
+            pass.refCount = 0;
+            for (const ResourceHandle r : pass.writes) {
+                if (m_resources[r].refCount > 0) pass.refCount++;
+            }
+
+            if (pass.refCount == 0) {
+                pass.culled = true;
+                changed = true;
+            }
+        }
+    }
+
+    m_stats.passesCulled = static_cast<int>(std::ranges::count_if(m_passes, [](const Pass& p) { return p.culled; }));
+}
+
+void FrameGraph::computeLifetimes() {
+    for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+        const Pass& pass = m_passes[i];
+        if (pass.culled) continue;
+
+        const auto touch = [this, i](const ResourceHandle r) {
+            Resource& resource = m_resources[r];
+            if (resource.firstUse < 0) resource.firstUse = i;
+            resource.lastUse = i;
+        };
+
+        std::ranges::for_each(pass.reads, touch);
+        std::ranges::for_each(pass.writes, touch);
+    }
+}
+
+// Greedy interval assignment: walk transients in order of first use and hand each one a pooled texture
+// with the same description that is free again by then.
+void FrameGraph::allocateTransients() {
+    for (auto& pooled : m_pool) {
+        pooled.busyUntil = -1;
+    }
+
+    std::vector<int> order;
+    for (int i = 0; i < static_cast<int>(m_resources.size()); i++) {
+        if (!m_resources[i].imported && m_resources[i].firstUse >= 0) {
+            order.push_back(i);
+        }
+    }
+    std::ranges::sort(order, {}, [this](const int i) { return m_resources[i].firstUse; });
+
+    std::vector<bool> usedThisFrame(m_pool.size(), false);
+
+    for (const int index : order) {
+        Resource& resource = m_resources[index];
+
+        auto it = std::ranges::find_if(m_pool, [&resource](const PooledTexture& pooled) {
+            return pooled.desc == resource.desc && pooled.busyUntil < resource.firstUse;
+        });
+
+        if (it == m_pool.end()) {
+            PooledTexture pooled;
+            pooled.desc = resource.desc;
+
+            glCreateTextures(GL_TEXTURE_2D, 1, &pooled.texture);
+            glTextureStorage2D(pooled.texture, 1, resource.desc.format, resource.desc.width, resource.desc.height);
+
+            // Integer textures are incomplete with linear filtering, even for texelFetch
+            const bool nearest = isDepthFormat(resource.desc.format) || isIntegerFormat(resource.desc.format);
+            const GLint filter = nearest ? GL_NEAREST : GL_LINEAR;
+            glTextureParameteri(pooled.texture, GL_TEXTURE_MIN_FILTER, filter);
+            glTextureParameteri(pooled.texture, GL_TEXTURE_MAG_FILTER, filter);
+            glTextureParameteri(pooled.texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(pooled.texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            m_pool.push_back(pooled);
+            usedThisFrame.push_back(false);
+            it = m_pool.end() - 1;
+        }
+
+        it->busyUntil = resource.lastUse;
+        resource.texture = it->texture;
+        usedThisFrame[it - m_pool.begin()] = true;
+
+        m_stats.transientTextures++;
+        m_stats.transientBytes += textureBytes(resource.desc);
+    }
+
+    for (size_t i = 0; i < m_pool.size(); i++) {
+        if (usedThisFrame[i]) {
+            m_pool[i].unusedFrames = 0;
+            m_stats.physicalTextures++;
+            m_stats.physicalBytes += textureBytes(m_pool[i].desc);
+        } else {
+            m_pool[i].unusedFrames++;
+        }
+    }
+}
+
+void FrameGraph::evictUnusedTextures() {
+    const auto stale = [](const PooledTexture& pooled) { return pooled.unusedFrames > POOL_EVICT_FRAMES; };
+    if (std::ranges::none_of(m_pool, stale)) return;
+
+    for (const auto& pooled : m_pool) {
+        if (stale(pooled)) glDeleteTextures(1, &pooled.texture);
+    }
+    std::erase_if(m_pool, stale);
+
+    // Cached framebuffers may reference a deleted texture
+    for (const auto& [key, fbo] : m_framebuffers) {
+        glDeleteFramebuffers(1, &fbo);
+    }
+    m_framebuffers.clear();
+}
+
+void FrameGraph::execute(GpuProfiler* profiler) {
+    m_boundFramebuffer = UNKNOWN_FRAMEBUFFER; // outside code may have changed the binding since last frame
+
+    const Resources resources(*this);
+    for (const auto& pass : m_passes) {
+        if (pass.culled) continue;
+
+        if (profiler) profiler->beginZone(pass.name);
+        PROFILE_SCOPE(pass.profileName);
+
+        if (!pass.colorAttachments.empty() || pass.depthAttachment.resource != INVALID_RESOURCE) {
+            bindAttachments(pass);
+        }
+
+        pass.execute(resources);
+        if (pass.colorAttachments.empty() && pass.depthAttachment.resource == INVALID_RESOURCE) {
+            m_boundFramebuffer = UNKNOWN_FRAMEBUFFER; // passes without attachments may bind their own (shadow maps)
+        }
+
+        if (profiler) profiler->endZone();
+    }
+}
+
+void FrameGraph::bindAttachments(const Pass& pass) {
+    const bool toBackbuffer = std::ranges::any_of(pass.colorAttachments, [this](const Attachment& a) {
+        return m_resources[a.resource].backbuffer;
+    });
+
+    const GLuint fbo = toBackbuffer ? 0 : getFramebuffer(pass);
+    if (fbo != m_boundFramebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        m_boundFramebuffer = fbo;
+        m_stats.framebufferBinds++;
+    }
+
+    const ResourceHandle sizeSource = pass.colorAttachments.empty() ? pass.depthAttachment.resource : pass.colorAttachments[0].resource;
+    const TextureDesc& desc = m_resources[sizeSource].desc;
+    glViewport(0, 0, desc.width, desc.height);
+
+    // Passes are expected to leave the colour/depth write masks enabled, clears honour them
+    std::vector<GLenum> invalidate;
+    for (size_t i = 0; i < pass.colorAttachments.size(); i++) {
+        const Attachment& attachment = pass.colorAttachments[i];
+        if (attachment.loadOp == LoadOp::Clear) {
+            glClearNamedFramebufferfv(fbo, GL_COLOR, static_cast<GLint>(i), &attachment.clearColor[0]);
+            m_stats.clears++;
+        } else if (attachment.loadOp == LoadOp::DontCare) {
+            invalidate.push_back(toBackbuffer ? GL_COLOR : GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+        }
+    }
+
+    if (const Attachment& depth = pass.depthAttachment; depth.resource != INVALID_RESOURCE) {
+        if (depth.loadOp == LoadOp::Clear) {
+            glClearNamedFramebufferfv(fbo, GL_DEPTH, 0, &depth.clearDepth);
+            m_stats.clears++;
+        } else if (depth.loadOp == LoadOp::DontCare) {
+            invalidate.push_back(toBackbuffer ? GL_DEPTH : GL_DEPTH_ATTACHMENT);
+        }
+    }
+
+    if (!invalidate.empty()) {
+        glInvalidateNamedFramebufferData(fbo, static_cast<GLsizei>(invalidate.size()), invalidate.data());
+    }
+}
+
+GLuint FrameGraph::getFramebuffer(const Pass& pass) {
+    std::vector<GLuint> key;
+    for (const auto& attachment : pass.colorAttachments) {
+        key.push_back(m_resources[attachment.resource].texture);
+    }
+    key.push_back(pass.depthAttachment.resource != INVALID_RESOURCE ? m_resources[pass.depthAttachment.resource].texture : 0);
+
+    if (const auto it = m_framebuffers.find(key); it != m_framebuffers.end()) {
+        return it->second;
+    }
+
+    GLuint fbo = 0;
+    glCreateFramebuffers(1, &fbo);
+
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < pass.colorAttachments.size(); i++) {
+        const GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glNamedFramebufferTexture(fbo, attachment, key[i], 0);
+        drawBuffers.push_back(attachment);
+    }
+    if (key.back() != 0) {
+        glNamedFramebufferTexture(fbo, GL_DEPTH_ATTACHMENT, key.back(), 0);
+    }
+
+    if (drawBuffers.empty()) {
+        glNamedFramebufferDrawBuffer(fbo, GL_NONE);
+    } else {
+        glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+
+    if (glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::FRAME_GRAPH:: Framebuffer for pass '" << pass.name << "' is not complete" << std::endl;
+    }
+
+    m_framebuffers[key] = fbo;
+    return fbo;
+}
+
+void FrameGraph::reset() {
+    m_passes.clear();
+    m_resources.clear();
+}
+
+std::vector<std::string> FrameGraph::getPassNames(const bool culled) const {
+    std::vector<std::string> names;
+    for (const auto& pass : m_passes) {
+        if (pass.culled == culled) names.push_back(pass.name);
+    }
+    return names;
+}
+
+size_t FrameGraph::textureBytes(const TextureDesc& desc) {
+    size_t bytesPerPixel = 4;
+    switch (desc.format) {
+        case GL_R8: bytesPerPixel = 1; break;
+        case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: bytesPerPixel = 2; break;
+        case GL_RGBA16F: case GL_RG32F: case GL_RG32UI: bytesPerPixel = 8; break;
+        case GL_RGBA32F: bytesPerPixel = 16; break;
+        default: break; // RGBA8, SRGB8_ALPHA8, R32F, R32UI, DEPTH_COMPONENT32F, DEPTH24_STENCIL8, ...
+    }
+    return static_cast<size_t>(desc.width) * desc.height * bytesPerPixel;
+}
+
+bool FrameGraph::isIntegerFormat(const GLenum format) {
+    return format == GL_R32UI || format == GL_RG32UI || format == GL_RGBA32UI ||
+           format == GL_R32I || format == GL_RG32I || format == GL_RGBA32I;
+}
+
+bool FrameGraph::isDepthFormat(const GLenum format) {
+    return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F ||
+           format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
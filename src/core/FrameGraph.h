@@ -0,0 +1,163 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class GpuProfiler;
+
+// The FrameGraph is rebuilt every frame from the passes the Renderer adds.
+// Passes declare which textures they read and write, the graph then:
+//  - culls passes whose results are never consumed (unless they have side effects),
+//  - allocates transient textures from a pool, sharing one GL texture between resources with the same
+//    description whose lifetimes don't overlap (OpenGL has no memory heaps, so aliasing happens at texture level),
+//  - binds framebuffers for the declared attachments, skipping redundant binds and only clearing when asked to.
+class FrameGraph {
+public:
+    using ResourceHandle = int;
+    static constexpr ResourceHandle INVALID_RESOURCE = -1;
+
+    struct TextureDesc {
+        int width = 0;
+        int height = 0;
+        GLenum format = GL_RGBA8;
+
+        bool operator==(const TextureDesc&) const = default;
+    };
+
+    // What happens to an attachment's previous contents when a pass starts writing it
+    enum class LoadOp {
+        Load,     // keep
+        Clear,    // clear to the given value
+        DontCare  // pass overwrites everything, contents are invalidated instead of cleared
+    };
+
+    class Resources;
+    class PassBuilder;
+
+    using SetupFn = std::function<void(PassBuilder&)>;
+    using ExecuteFn = std::function<void(const Resources&)>;
+
+    class PassBuilder {
+    public:
+        ResourceHandle create(const std::string& name, const TextureDesc& desc);
+        ResourceHandle read(ResourceHandle resource);
+        ResourceHandle write(ResourceHandle resource); // storage/image writes, no attachment
+        ResourceHandle writeColor(ResourceHandle resource, LoadOp loadOp = LoadOp::Load, const glm::vec4& clearColor = glm::vec4(0.0f));
+        ResourceHandle writeDepth(ResourceHandle resource, LoadOp loadOp = LoadOp::Load, float clearDepth = 1.0f);
+        void sideEffect(); // never culled, e.g. writes GPU buffers the graph doesn't track
+
+    private:
+        friend class FrameGraph;
+        PassBuilder(FrameGraph& graph, int passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+        FrameGraph& m_graph;
+        int m_passIndex;
+    };
+
+    class Resources {
+    public:
+        [[nodiscard]] GLuint getTexture(ResourceHandle resource) const;
+        [[nodiscard]] const TextureDesc& getDesc(ResourceHandle resource) const;
+
+    private:
+        friend class FrameGraph;
+        explicit Resources(const FrameGraph& graph) : m_graph(graph) {}
+
+        const FrameGraph& m_graph;
+    };
+
+    struct Stats {
+        int passesTotal = 0;
+        int passesCulled = 0;
+        int transientTextures = 0;  // logical transient resources this frame
+        int physicalTextures = 0;   // GL textures backing them after aliasing
+        size_t transientBytes = 0;  // memory without aliasing
+        size_t physicalBytes = 0;   // memory actually allocated
+        int framebufferBinds = 0;
+        int clears = 0;
+    };
+
+    FrameGraph() = default;
+    ~FrameGraph();
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // Externally owned textures (persistent history like the Hi-Z pyramid). Writing to them counts as a side effect.
+    ResourceHandle importTexture(const std::string& name, GLuint texture, const TextureDesc& desc);
+    ResourceHandle importBackbuffer(const std::string& name, int width, int height); // default framebuffer
+
+    void addPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute);
+
+    void compile();
+    void execute(GpuProfiler* profiler = nullptr); // optionally times every pass
+    void reset(); // drops this frame's passes and resources, keeps the texture pool
+
+    [[nodiscard]] const Stats& getStats() const { return m_stats; }
+    [[nodiscard]] std::vector<std::string> getPassNames(bool culled) const;
+
+private:
+    struct Attachment {
+        ResourceHandle resource = INVALID_RESOURCE;
+        LoadOp loadOp = LoadOp::Load;
+        glm::vec4 clearColor{0.0f};
+        float clearDepth = 1.0f;
+    };
+
+    struct Pass {
+        std::string name;
+        const char* profileName = nullptr; // interned name, for the CPU profiler
+        ExecuteFn execute;
+        std::vector<ResourceHandle> reads;
+        std::vector<ResourceHandle> writes;
+        std::vector<Attachment> colorAttachments;
+        Attachment depthAttachment;
+        bool sideEffect = false;
+        bool culled = false;
+        int refCount = 0;
+    };
+
+    struct Resource {
+        std::string name;
+        TextureDesc desc;
+        GLuint texture = 0;
+        bool imported = false;
+        bool backbuffer = false;
+        int refCount = 0;
+        int firstUse = -1;
+        int lastUse = -1;
+    };
+
+    struct PooledTexture {
+        TextureDesc desc;
+        GLuint texture = 0;
+        int busyUntil = -1; // index of the last pass using it this frame
+        int unusedFrames = 0;
+    };
+
+    static constexpr int POOL_EVICT_FRAMES = 3; // pooled textures unused this long are freed (e.g. after a resize)
+
+    void cullPasses();
+    void computeLifetimes();
+    void allocateTransients();
+    void bindAttachments(const Pass& pass);
+    GLuint getFramebuffer(const Pass& pass);
+    void evictUnusedTextures();
+
+    static size_t textureBytes(const TextureDesc& desc);
+    static bool isDepthFormat(GLenum format);
+    static bool isIntegerFormat(GLenum format);
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PooledTexture> m_pool;
+
+    std::map<std::vector<GLuint>, GLuint> m_framebuffers; // attachment textures -> cached FBO
+    std::map<std::string, const char*, std::less<>> m_profileNames; // pass names -> Profiler::internName, kept across frames
+    GLuint m_boundFramebuffer = 0;
+
+    Stats m_stats;
+};
@@ -0,0 +1,92 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace {
+    // Prefer a display that needs no windowing system, fall back to the default one
+    EGLDisplay getDisplay() {
+        const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+        if (getPlatformDisplay) {
+            if (const EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    if (m_display == nullptr) return;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_context) eglDestroyContext(m_display, m_context);
+    if (m_surface) eglDestroySurface(m_display, m_surface);
+    eglTerminate(m_display);
+}
+
+bool HeadlessContext::create(const int width, const int height) {
+    m_display = getDisplay();
+    if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, nullptr, nullptr)) {
+        std::cerr << "ERROR::HEADLESS:: Could not initialize an EGL display" << std::endl;
+        m_display = nullptr;
+        return false;
+    }
+
+    constexpr EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(m_display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "ERROR::HEADLESS:: No pbuffer capable EGL config" << std::endl;
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    m_surface = eglCreatePbufferSurface(m_display, config, surfaceAttribs);
+    if (m_surface == EGL_NO_SURFACE) {
+        std::cerr << "ERROR::HEADLESS:: Could not create a " << width << "x" << height << " pbuffer" << std::endl;
+        m_surface = nullptr;
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+    constexpr EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (m_context == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR::HEADLESS:: Could not create an OpenGL 4.6 core context" << std::endl;
+        m_context = nullptr;
+        return false;
+    }
+
+    eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+    eglSwapInterval(m_display, 0); // never wait for a vertical blank
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        std::cerr << "ERROR::HEADLESS:: Failed to load OpenGL functions" << std::endl;
+        return false;
+    }
+
+    std::cout << "Headless context: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+    return true;
+}
+
+void HeadlessContext::swapBuffers() const {
+    eglSwapBuffers(m_display, m_surface);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// OpenGL 4.6 core context on an EGL pbuffer, used by --benchmark so Scilla runs without a window or display
+// (e.g. Mesa llvmpipe in CI). EGL types are kept out of the header, they pull in platform headers.
+class HeadlessContext {
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates the context, makes it current and loads the GL functions. Swap interval is set to 0.
+    bool create(int width, int height);
+    void swapBuffers() const;
+
+private:
+    void* m_display = nullptr; // EGLDisplay
+    void* m_surface = nullptr; // EGLSurface
+    void* m_context = nullptr; // EGLContext
+};
@@ -0,0 +1,377 @@
+#include "MicroBenchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "AssetManager.h"
+#include "camera/Frustum.h"
+#include "graphics/MeshOptimizer.h"
+#include "graphics/Model.h"
+#include "graphics/Shader.h"
+#include "graphics/buffers/StreamingBuffer.h"
+
+namespace {
+    constexpr int WARMUP_FRAMES = 30;
+    constexpr int MEASURED_FRAMES = 300;
+
+    // Typical per-frame upload patterns: per-draw constants, medium batches, one large block
+    struct StreamingCase {
+        const char* name;
+        GLsizeiptr chunkSize;
+        int chunksPerFrame;
+    };
+
+    constexpr StreamingCase STREAMING_CASES[] = {
+        {"per-draw 256 B x 1024", 256, 1024},
+        {"batch 64 KB x 16", 64 * 1024, 16},
+        {"block 4 MB x 1", 4 * 1024 * 1024, 1},
+    };
+
+    struct StreamingResult {
+        const char* method;
+        double msPerFrame;
+        double megabytesPerSecond;
+        int stalls;
+    };
+
+    GLsizeiptr alignUp(const GLsizeiptr value, const GLsizeiptr alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Binds a chunk as the shader's input and makes the GPU read it
+    void consume(const GLuint buffer, const GLintptr offset, const GLsizeiptr size) {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffer, offset, size);
+        glDispatchCompute(1, 1, 1);
+    }
+
+    // Runs warmup + measured frames of frameBody, including the time for the GPU to finish the last frame
+    template<typename FrameBody>
+    double measureFrames(FrameBody&& frameBody) {
+        for (int frame = 0; frame < WARMUP_FRAMES; frame++) {
+            frameBody();
+            glFlush();
+        }
+        glFinish();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < MEASURED_FRAMES; frame++) {
+            frameBody();
+            glFlush(); // stands in for SwapBuffers
+        }
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    constexpr int CULLING_OBJECTS = 1 << 20;
+    constexpr int CULLING_REPEATS = 50;
+
+    // Median milliseconds of repeated runs
+    template<typename Body>
+    double measureMedian(Body&& body, const int repeats = CULLING_REPEATS) {
+        std::vector<double> times(repeats);
+        for (double& ms : times) {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::ranges::nth_element(times, times.begin() + repeats / 2);
+        return times[repeats / 2];
+    }
+
+    constexpr const char* MODEL_PATHS[] = {"assets/models/tree/scene.gltf"};
+    constexpr int MODEL_REPEATS = 20;
+
+    struct ModelStats {
+        size_t meshes = 0;
+        size_t vertices = 0;
+        size_t indices = 0;
+        glm::vec3 boundsMin{0.0f};
+        glm::vec3 boundsMax{0.0f};
+    };
+
+    ModelStats describe(const Model& model) {
+        ModelStats stats{model.getMeshes().size(), 0, 0, model.getBoundsMin(), model.getBoundsMax()};
+        for (const Mesh& mesh : model.getMeshes()) {
+            stats.vertices += mesh.getVertices().size();
+            stats.indices += mesh.getIndices().size();
+        }
+        return stats;
+    }
+
+    // Both importers must produce the same geometry, up to float noise in the baked transforms
+    bool sameGeometry(const ModelStats& a, const ModelStats& b) {
+        const float tolerance = 1e-3f * std::max(1.0f, glm::length(a.boundsMax - a.boundsMin));
+        return a.meshes == b.meshes && a.vertices == b.vertices && a.indices == b.indices &&
+               glm::length(a.boundsMin - b.boundsMin) <= tolerance && glm::length(a.boundsMax - b.boundsMax) <= tolerance;
+    }
+}
+
+bool MicroBenchmarks::streaming(const std::string& path) {
+    const auto consumeShader = AssetManager::get().loadComputeShader("assets/shaders/stream_consume.comp");
+    if (!consumeShader) {
+        return false;
+    }
+
+    GLint storageAlignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+
+    GLuint resultBuffer;
+    glCreateBuffers(1, &resultBuffer);
+    glNamedBufferStorage(resultBuffer, 64 * 4 * sizeof(float), nullptr, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, resultBuffer);
+    consumeShader->use();
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::MICROBENCH:: Could not open " << path << " for writing" << std::endl;
+        glDeleteBuffers(1, &resultBuffer);
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"benchmark\": \"streaming\",\n  \"frames\": " << MEASURED_FRAMES << ",\n  \"cases\": [";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Streaming uploads, " << MEASURED_FRAMES << " frames per method" << std::endl;
+
+    bool firstCase = true;
+    for (const auto& [name, chunkSize, chunksPerFrame] : STREAMING_CASES) {
+        const GLsizeiptr stride = alignUp(chunkSize, storageAlignment);
+        const GLsizeiptr frameBytes = stride * chunksPerFrame;
+        const double uploadedMegabytes = static_cast<double>(chunkSize) * chunksPerFrame * MEASURED_FRAMES / (1024.0 * 1024.0);
+
+        // Different contents per chunk so nothing can be skipped as redundant
+        std::vector<char> source(chunkSize);
+        for (size_t i = 0; i < source.size(); i++) {
+            source[i] = static_cast<char>(i * 31);
+        }
+
+        std::vector<StreamingResult> results;
+
+        // glNamedBufferSubData into a buffer the GPU may still be reading from the previous frames.
+        // The driver has to copy the data aside or wait.
+        {
+            GLuint buffer;
+            glCreateBuffers(1, &buffer);
+            glNamedBufferStorage(buffer, frameBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+            const double ms = measureFrames([&] {
+                for (int chunk = 0; chunk < chunksPerFrame; chunk++) {
+                    source[0] = static_cast<char>(chunk);
+                    glNamedBufferSubData(buffer, chunk * stride, chunkSize, source.data());
+                    consume(buffer, chunk * stride, chunkSize);
+                }
+            });
+            results.push_back({"glNamedBufferSubData", ms / MEASURED_FRAMES, uploadedMegabytes / (ms / 1000.0), 0});
+
+            glDeleteBuffers(1, &buffer);
+        }
+
+        // Persistently mapped ring, written directly and fenced per frame
+        {
+            StreamingBuffer buffer;
+            buffer.generate(frameBytes);
+
+            const double ms = measureFrames([&] {
+                buffer.beginFrame();
+                for (int chunk = 0; chunk < chunksPerFrame; chunk++) {
+                    source[0] = static_cast<char>(chunk);
+                    const GLintptr offset = buffer.write(source.data(), chunkSize, storageAlignment);
+                    if (offset >= 0) consume(buffer.getID(), offset, chunkSize);
+                }
+                buffer.endFrame();
+            });
+            results.push_back({"StreamingBuffer", ms / MEASURED_FRAMES, uploadedMegabytes / (ms / 1000.0), buffer.getStallCount()});
+        }
+
+        std::cout << "  " << name << std::endl;
+        file << (firstCase ? "" : ",") << "\n    {\"name\": \"" << name << "\", \"chunkBytes\": " << chunkSize
+             << ", \"chunksPerFrame\": " << chunksPerFrame << ", \"methods\": [";
+
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& [method, msPerFrame, megabytesPerSecond, stalls] = results[i];
+            std::cout << "    " << std::left << std::setw(22) << method << std::right
+                      << std::setw(9) << msPerFrame << " ms/frame" << std::setw(11) << megabytesPerSecond << " MB/s"
+                      << "  (" << stalls << " stalls)" << std::endl;
+
+            file << (i == 0 ? "" : ", ") << "{\"method\": \"" << method << "\", \"msPerFrame\": " << msPerFrame
+                 << ", \"megabytesPerSecond\": " << megabytesPerSecond << ", \"stalls\": " << stalls << "}";
+        }
+
+        std::cout << "    speedup " << results[0].msPerFrame / std::max(results[1].msPerFrame, 1e-6) << "x" << std::endl;
+        file << "]}";
+        firstCase = false;
+    }
+
+    file << "\n  ]\n}\n";
+    std::cout << "Results written to " << path << std::endl;
+
+    glDeleteBuffers(1, &resultBuffer);
+    return true;
+}
+
+bool MicroBenchmarks::culling(const std::string& path) {
+    using FrustumCulling::Path;
+
+    // Objects scattered over the terrain's extent, the camera in the middle looking along +x
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(0.0f, 2048.0f);
+    std::uniform_real_distribution<float> size(0.5f, 8.0f);
+
+    std::vector<float> x(CULLING_OBJECTS), y(CULLING_OBJECTS), z(CULLING_OBJECTS);
+    std::vector<float> radius(CULLING_OBJECTS), extentX(CULLING_OBJECTS), extentY(CULLING_OBJECTS), extentZ(CULLING_OBJECTS);
+    for (int i = 0; i < CULLING_OBJECTS; i++) {
+        x[i] = position(rng);
+        y[i] = position(rng) * 0.25f;
+        z[i] = position(rng);
+        extentX[i] = size(rng);
+        extentY[i] = size(rng);
+        extentZ[i] = size(rng);
+        radius[i] = glm::length(glm::vec3(extentX[i], extentY[i], extentZ[i]));
+    }
+
+    const SphereArrays spheres{x.data(), y.data(), z.data(), radius.data(), static_cast<size_t>(CULLING_OBJECTS)};
+    const AabbArrays boxes{x.data(), y.data(), z.data(), extentX.data(), extentY.data(), extentZ.data(), static_cast<size_t>(CULLING_OBJECTS)};
+
+    const glm::mat4 view = glm::lookAt(glm::vec3(1024.0f, 200.0f, 1024.0f), glm::vec3(2048.0f, 100.0f, 1024.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 3000.0f);
+    const Frustum frustum = Frustum::fromViewProj(projection * view);
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::MICROBENCH:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"benchmark\": \"culling\",\n  \"objects\": " << CULLING_OBJECTS << ",\n  \"results\": [";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Frustum culling, " << CULLING_OBJECTS << " objects, median of " << CULLING_REPEATS << " runs" << std::endl;
+
+    std::vector<uint8_t> reference(CULLING_OBJECTS), visible(CULLING_OBJECTS);
+    bool first = true;
+    bool allMatch = true;
+
+    for (const bool isSphere : {true, false}) {
+        const char* shape = isSphere ? "sphere" : "aabb";
+        const auto cull = [&](const Path p, const bool parallel, std::vector<uint8_t>& out) {
+            if (isSphere) {
+                parallel ? FrustumCulling::cullSpheresParallel(frustum, spheres, out.data(), p)
+                         : FrustumCulling::cullSpheres(frustum, spheres, out.data(), p);
+            } else {
+                parallel ? FrustumCulling::cullAabbsParallel(frustum, boxes, out.data(), p)
+                         : FrustumCulling::cullAabbs(frustum, boxes, out.data(), p);
+            }
+        };
+
+        cull(Path::Scalar, false, reference);
+        const auto visibleCount = std::ranges::count(reference, 1);
+        std::cout << "  " << shape << " (" << visibleCount << " visible)" << std::endl;
+
+        double scalarMs = 0.0;
+        for (const bool parallel : {false, true}) {
+            for (const Path requested : {Path::Scalar, Path::SSE, Path::AVX}) {
+                const Path p = FrustumCulling::resolve(requested);
+                if (p != requested) continue; // not available on this CPU
+
+                const double ms = measureMedian([&] { cull(p, parallel, visible); });
+                const bool matches = visible == reference;
+                allMatch = allMatch && matches;
+                if (p == Path::Scalar && !parallel) scalarMs = ms;
+
+                const std::string name = std::string(FrustumCulling::getName(p)) + (parallel ? " mt" : "");
+                const double millionsPerSecond = CULLING_OBJECTS / (ms * 1000.0);
+                std::cout << "    " << std::left << std::setw(12) << name << std::right << std::setw(8) << ms << " ms"
+                          << std::setw(10) << millionsPerSecond << " M/s" << std::setw(8) << scalarMs / ms << "x"
+                          << (matches ? "" : "  MISMATCH") << std::endl;
+
+                file << (first ? "" : ",") << "\n    {\"shape\": \"" << shape << "\", \"path\": \"" << FrustumCulling::getName(p)
+                     << "\", \"threaded\": " << (parallel ? "true" : "false") << ", \"ms\": " << ms
+                     << ", \"millionObjectsPerSecond\": " << millionsPerSecond << ", \"matchesScalar\": " << (matches ? "true" : "false") << "}";
+                first = false;
+            }
+        }
+    }
+
+    file << "\n  ]\n}\n";
+    std::cout << "Results written to " << path << std::endl;
+
+    if (!allMatch) {
+        std::cerr << "ERROR::MICROBENCH:: SIMD culling results differ from the scalar path" << std::endl;
+    }
+    return allMatch;
+}
+
+bool MicroBenchmarks::models(const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::MICROBENCH:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"benchmark\": \"models\",\n  \"repeats\": " << MODEL_REPEATS << ",\n  \"results\": [";
+
+    bool first = true;
+    bool allMatch = true;
+    for (const char* modelPath : MODEL_PATHS) {
+        // Warm up both paths: the textures land in the AssetManager cache and the files in the page cache, so only
+        // parsing and building the meshes is measured. The warmup loads also print the mesh optimizer's analysis,
+        // which stays out of the timed loads.
+        const bool reporting = MeshOptimizer::isReporting();
+        MeshOptimizer::setReporting(true);
+        const ModelStats native = describe(Model(modelPath, false, Model::Importer::Auto));
+        const ModelStats assimp = describe(Model(modelPath, false, Model::Importer::Assimp));
+        MeshOptimizer::setReporting(reporting);
+        const bool matches = sameGeometry(native, assimp);
+        allMatch = allMatch && matches;
+
+        const double nativeMs = measureMedian([&] { Model model(modelPath, false, Model::Importer::Auto); }, MODEL_REPEATS);
+        const double assimpMs = measureMedian([&] { Model model(modelPath, false, Model::Importer::Assimp); }, MODEL_REPEATS);
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Model loading, " << modelPath << " (" << native.meshes << " meshes, " << native.vertices
+                  << " vertices), median of " << MODEL_REPEATS << " runs" << std::endl;
+        std::cout << "    native  " << std::setw(8) << nativeMs << " ms" << std::endl;
+        std::cout << "    assimp  " << std::setw(8) << assimpMs << " ms" << std::endl;
+        std::cout << "    speedup " << assimpMs / std::max(nativeMs, 1e-6) << "x" << (matches ? "" : "  MISMATCH") << std::endl;
+
+        file << (first ? "" : ",") << "\n    {\"model\": \"" << modelPath << "\", \"meshes\": " << native.meshes
+             << ", \"vertices\": " << native.vertices << ", \"indices\": " << native.indices
+             << ", \"nativeMs\": " << nativeMs << ", \"assimpMs\": " << assimpMs
+             << ", \"matchesAssimp\": " << (matches ? "true" : "false") << "}";
+        first = false;
+    }
+
+    file << "\n  ]\n}\n";
+    std::cout << "Results written to " << path << std::endl;
+
+    if (!allMatch) {
+        std::cerr << "ERROR::MICROBENCH:: Native glTF geometry differs from Assimp's" << std::endl;
+    }
+    return allMatch;
+}
+
+bool MicroBenchmarks::run(const std::string& name, const std::string& path) {
+    if (name == "streaming") {
+        return streaming(path);
+    }
+    if (name == "culling") {
+        return culling(path);
+    }
+    if (name == "models") {
+        return models(path);
+    }
+
+    std::cerr << "ERROR::MICROBENCH:: Unknown benchmark '" << name << "', available: streaming, culling, models" << std::endl;
+    return false;
+}
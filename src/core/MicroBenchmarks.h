@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+
+// Focused measurements of single engine subsystems (scilla --microbench <name>), run on the headless context
+// without loading a scene. Each writes a small JSON file with its results next to the console summary.
+namespace MicroBenchmarks {
+    // Per-frame uploads through StreamingBuffer vs glNamedBufferSubData, consumed by a compute dispatch
+    bool streaming(const std::string& path);
+
+    // FrustumCulling spheres and AABBs through every code path, single and multithreaded. Needs no GL.
+    bool culling(const std::string& path);
+
+    // Native glTF loading vs Assimp on the engine's models, checking both produce the same geometry.
+    // Also prints the mesh optimizer's analysis of every mesh.
+    bool models(const std::string& path);
+
+    // Dispatches by name, prints the available names for unknown ones
+    bool run(const std::string& name, const std::string& path);
+}
@@ -2,6 +2,7 @@
 // It manages shaders, render passes, and drawing objects.
 
 #include "Renderer.h"
+#include <algorithm>
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -10,14 +11,45 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "graphics/Cube.h"
+#include "graphics/TextureLoader.h"
+#include "graphics/buffers/IndirectCommand.h"
+#include "utils/Profiler.h"
 
 void Renderer::initialize() {
+    PROFILE_SCOPE("Renderer::initialize");
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_FRAMEBUFFER_SRGB); // Gamma correction
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
+    m_frameUBO.initialize();
     setupShaders();
     setupLightCube();
+    m_fullscreenVao.generate();
+
+    m_culler.initialize();
+    m_clusteredLighting.initialize();
+    m_shadows.initialize();
+    m_skyIrradiance.initialize();
+    m_visibilityBuffer.initialize();
+    m_autoExposure.initialize();
+    m_gpuProfiler.initialize();
+    resize(screenWidth, screenHeight);
+}
+
+void Renderer::resize(const int width, const int height) {
+    screenWidth = width;
+    screenHeight = height;
+    glViewport(0, 0, width, height);
+
+    updateRenderSize();
+}
+
+void Renderer::updateRenderSize() {
+    const glm::ivec2 renderSize = m_dynamicResolution.getRenderSize(screenWidth, screenHeight);
+    if (renderSize == m_renderSize) return;
+
+    m_renderSize = renderSize;
+    m_culler.resize(renderSize.x, renderSize.y); // the Hi-Z pyramid is built from the scene depth
 }
 
 void Renderer::setupShaders() {
@@ -26,18 +58,31 @@ void Renderer::setupShaders() {
 
     m_shaders["object"] = assetManager.loadShader(path + "vertex_shader.vert", path + "fragment_shader.frag");
     m_shaders["light"]  = assetManager.loadShader(path + "vertex_shader.vert", path + "lightSource.frag");
-    m_shaders["skybox"] = assetManager.loadShader(path + "skybox.vert", path + "procedural_sky.frag");
+    m_shaders["sky"] = assetManager.loadShader(path + "sky.vert", path + "sky.frag");
+    m_shaders["skyUpsample"] = assetManager.loadShader(path + "sky.vert", path + "sky_upsample.frag");
     m_shaders["terrain"] = assetManager.loadShader(path + "terrain.vert", path + "terrain.frag");
     m_shaders["vegetation"] = assetManager.loadShader(path + "vegetation.vert", path + "vegetation.frag");
 
+    // Depth pre-pass variants share the vertex shaders so positions match exactly
+    m_shaders["terrainDepth"] = assetManager.loadShader(path + "terrain.vert", path + "depth_only.frag");
+    m_shaders["objectDepth"] = assetManager.loadShader(path + "vertex_shader.vert", path + "depth_only.frag");
+    m_shaders["vegetationDepth"] = assetManager.loadShader(path + "vegetation.vert", path + "depth_alpha.frag");
+
+    // Static objects batched per model
+    m_shaders["objectInstanced"] = assetManager.loadShader(path + "object_instanced.vert", path + "fragment_shader.frag");
+    m_shaders["objectInstancedDepth"] = assetManager.loadShader(path + "object_instanced.vert", path + "depth_only.frag");
+
+    m_shaders["tonemap"] = assetManager.loadShader(path + "fullscreen.vert", path + "tonemap.frag");
+
     // Configure Light/Material Uniforms
-    const auto objectShader = m_shaders["object"];
-    objectShader->use();
-    objectShader->setVec3("light.position", glm::vec3(1.2f, 1.0f, 2.0f));
-    objectShader->setVec3("light.ambient", glm::vec3(0.05f));
-    objectShader->setVec3("light.diffuse", glm::vec3(0.5f));
-    objectShader->setVec3("light.specular", glm::vec3(1.0f));
-    objectShader->setFloat("material.shininess", 64.0f);
+    for (const auto& name : {"object", "objectInstanced"}) {
+        const auto objectShader = m_shaders[name];
+        objectShader->use();
+        objectShader->setVec3("light.position", glm::vec3(1.2f, 1.0f, 2.0f));
+        objectShader->setVec3("light.diffuse", glm::vec3(0.5f));
+        objectShader->setVec3("light.specular", glm::vec3(1.0f));
+        objectShader->setFloat("material.shininess", 64.0f);
+    }
 
     const auto vegShader = m_shaders["vegetation"];
     vegShader->use();
@@ -47,67 +92,408 @@ void Renderer::setupShaders() {
 }
 
 void Renderer::render(Scene &scene, const InputHandler &inputHandler) {
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // Start imGui frame
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
+    PROFILE_SCOPE("Renderer::render");
+    if (m_imguiEnabled) {
+        PROFILE_SCOPE("ImGui");
+
+        // Start imGui frame
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        // Draw ImGui
+        scene.imGui();
+        imGui();
+        m_gpuProfiler.imGui();
+    }
 
-    // Draw ImGui
-    scene.imGui();
+    TextureLoader::get().update(); // streams in decoded textures, the placeholders are bound until then
+    m_dynamicResolution.update(m_gpuProfiler);
+    updateRenderSize();
 
-    // Update Camera UBO (Sends View/Proj/Pos to binding point 0)
+    // Update the frame constants (camera, frustum, sun, time) at binding point 0
     const Camera &cam = scene.getCamera();
-    m_cameraUBO.setViewProjection(
-        cam.getViewMatrix(),
-        cam.getProjectionMatrix(static_cast<float>(screenWidth), static_cast<float>(screenHeight)),
-        cam.getCameraPos());
+    const glm::mat4 view = cam.getViewMatrix();
+    const glm::mat4 projection = cam.getProjectionMatrix(static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    m_frameUBO.setSkyIrradiance(m_skyIrradiance.getCoefficients());
+    m_frameUBO.setFog(scene.getFog().getShaderParams(cam.getFarPlane()));
+    m_frameUBO.update(view, projection, cam.getCameraPos(), scene.getSunDirection(), scene.getTime(), scene.getDayTime(),
+                      m_renderSize.x, m_renderSize.y);
+    const glm::mat4 &viewProj = m_frameUBO.getData().viewProj;
+    cullObjects(scene);
+    if (scene.getTerrainVersion() != m_shadowTerrainVersion) {
+        m_shadowTerrainVersion = scene.getTerrainVersion();
+        m_shadows.invalidate();
+    }
+    m_shadows.update(m_frameUBO.getData(), scene.getSunDirection());
+
+    buildFrameGraph(scene, inputHandler, viewProj, projection);
+    m_frameGraph.compile();
+    m_gpuProfiler.beginFrame();
+    m_frameGraph.execute(&m_gpuProfiler);
+    m_gpuProfiler.endFrame();
+    m_frameUBO.endFrame();
+    m_clusteredLighting.endFrame();
+    m_shadows.endFrame();
+    m_frameGraph.reset();
+}
+
+void Renderer::buildFrameGraph(Scene &scene, const InputHandler &inputHandler, const glm::mat4 &viewProj,
+                               const glm::mat4 &projection) {
+    using LoadOp = FrameGraph::LoadOp;
+    FrameGraph &graph = m_frameGraph;
+
+    // The scene renders at the dynamic resolution, the tonemap upscales it to the window
+    const FrameGraph::ResourceHandle backbuffer = graph.importBackbuffer("Backbuffer", screenWidth, screenHeight);
+    const int renderWidth = m_renderSize.x;
+    const int renderHeight = m_renderSize.y;
+    const FrameGraph::ResourceHandle hiZ = m_culler.getHiZTexture() != 0
+        ? graph.importTexture("HiZ", m_culler.getHiZTexture(), {m_culler.getHiZWidth(), m_culler.getHiZHeight(), GL_R32F})
+        : FrameGraph::INVALID_RESOURCE;
+
+    FrameGraph::ResourceHandle sceneColor = FrameGraph::INVALID_RESOURCE;
+    FrameGraph::ResourceHandle sceneDepth = FrameGraph::INVALID_RESOURCE;
+
+    // Before the camera's culling, the cascades reuse its indirect buffers
+    graph.addPass("Shadows",
+        [](FrameGraph::PassBuilder &builder) { builder.sideEffect(); }, // renders into the cascade array
+        [this, &scene](const FrameGraph::Resources &) { renderShadowPass(scene); });
+
+    m_cullingActive = m_occlusionCulling;
+    if (m_cullingActive) {
+        graph.addPass("Culling",
+            [&](FrameGraph::PassBuilder &builder) {
+                if (hiZ != FrameGraph::INVALID_RESOURCE) builder.read(hiZ);
+                builder.sideEffect(); // writes the indirect command buffers
+            },
+            [this, &scene, viewProj](const FrameGraph::Resources &) { cullPass(scene, viewProj); });
+    }
+
+    // Point light lists per cluster, read by every lit pass
+    graph.addPass("LightCulling",
+        [](FrameGraph::PassBuilder &builder) { builder.sideEffect(); }, // writes the cluster light buffers
+        [this, &scene, projection](const FrameGraph::Resources &) {
+            m_clusteredLighting.update(scene.getLights(), m_frameUBO.getFrustum(), projection);
+        });
+
+    // Sky LUTs, read by the sky and by the aerial perspective of the lit passes. The ambient light projected
+    // from them reaches the shaders through the frame constants a few frames later.
+    graph.addPass("SkyLuts",
+        [](FrameGraph::PassBuilder &builder) { builder.sideEffect(); }, // rebuilds the LUT textures when out of date
+        [this, &scene](const FrameGraph::Resources &) {
+            Skybox &skybox = scene.getSkybox();
+            skybox.update(scene.getSunDirection(), scene.getCamera().getCameraPos());
+            m_skyIrradiance.update(skybox.getAmbientIntensity() / skybox.getSunIntensity());
+        });
+
+    // Terrain and trees either through the visibility buffer, shaded once per pixel, or forward below
+    const InstancedModel *trees = scene.getVegetation().getTrees();
+    m_visibilityBufferActive = m_visibilityBufferMode && m_visibilityBuffer.prepare(trees);
+    if (m_visibilityBufferActive) {
+        FrameGraph::ResourceHandle visibility = FrameGraph::INVALID_RESOURCE;
+        graph.addPass("VisibilityBuffer",
+            [&](FrameGraph::PassBuilder &builder) {
+                visibility = builder.create("Visibility", {renderWidth, renderHeight, VisibilityBuffer::FORMAT});
+                builder.writeColor(visibility, LoadOp::DontCare); // the resolve skips pixels left at the far plane
+                sceneDepth = builder.create("SceneDepth", {renderWidth, renderHeight, GL_DEPTH_COMPONENT32F});
+                builder.writeDepth(sceneDepth, LoadOp::Clear, 1.0f);
+            },
+            [this, &scene, trees](const FrameGraph::Resources &) {
+                m_visibilityBuffer.renderGeometry(*this, scene.getTerrain(), trees, m_cullingActive);
+            });
+
+        graph.addPass("VisibilityResolve",
+            [&](FrameGraph::PassBuilder &builder) {
+                builder.read(visibility);
+                builder.read(sceneDepth);
+                sceneColor = builder.create("SceneColor", {renderWidth, renderHeight, GL_RGBA16F});
+                builder.writeColor(sceneColor, LoadOp::DontCare); // covered by the resolve or the skybox
+            },
+            [this, &scene, trees, visibility, sceneDepth](const FrameGraph::Resources &resources) {
+                m_visibilityBuffer.resolve(scene.getTerrain(), trees, resources.getTexture(visibility),
+                                           resources.getTexture(sceneDepth), m_cullingActive);
+            });
+    } else if (m_depthPrePass) {
+        graph.addPass("DepthPrePass",
+            [&](FrameGraph::PassBuilder &builder) {
+                sceneDepth = builder.create("SceneDepth", {renderWidth, renderHeight, GL_DEPTH_COMPONENT32F});
+                builder.writeDepth(sceneDepth, LoadOp::Clear, 1.0f);
+            },
+            [this, &scene](const FrameGraph::Resources &) { renderDepthPrePass(scene); });
+    }
+
+    graph.addPass("Opaque",
+        [&](FrameGraph::PassBuilder &builder) {
+            if (sceneColor == FrameGraph::INVALID_RESOURCE) {
+                sceneColor = builder.create("SceneColor", {renderWidth, renderHeight, GL_RGBA16F});
+                builder.writeColor(sceneColor, LoadOp::DontCare); // every pixel is covered by geometry or the skybox
+            } else {
+                builder.writeColor(sceneColor, LoadOp::Load);
+            }
+            if (sceneDepth == FrameGraph::INVALID_RESOURCE) {
+                sceneDepth = builder.create("SceneDepth", {renderWidth, renderHeight, GL_DEPTH_COMPONENT32F});
+                builder.writeDepth(sceneDepth, LoadOp::Clear, 1.0f);
+            } else {
+                builder.writeDepth(sceneDepth, LoadOp::Load);
+            }
+        },
+        [this, &scene, &inputHandler](const FrameGraph::Resources &) {
+            if (m_visibilityBufferActive) {
+                renderOpaquePass(scene, inputHandler, false); // the rest depth tests against the resolved geometry
+                return;
+            }
+            if (m_depthPrePass) {
+                glDepthFunc(GL_LEQUAL);
+                glDepthMask(GL_FALSE); // depth is final, the colour pass only shades the visible fragments
+            }
+            renderOpaquePass(scene, inputHandler, true);
+            glDepthMask(GL_TRUE);
+            glDepthFunc(GL_LESS);
+        });
+
+    graph.addPass("LightSource",
+        [&](FrameGraph::PassBuilder &builder) {
+            builder.writeColor(sceneColor);
+            builder.writeDepth(sceneDepth);
+        },
+        [this](const FrameGraph::Resources &) { renderLightSource(); }); // Draw the light cube
+
+    // The sky is smooth, a quarter of the pixels and bilinear upsampling look the same
+    FrameGraph::ResourceHandle skyLowRes = FrameGraph::INVALID_RESOURCE;
+    if (scene.getSkybox().isQuarterResolution()) {
+        graph.addPass("SkyLowRes",
+            [&](FrameGraph::PassBuilder &builder) {
+                skyLowRes = builder.create("SkyLowRes", {std::max(1, renderWidth / 2), std::max(1, renderHeight / 2), GL_RGBA16F});
+                builder.writeColor(skyLowRes, LoadOp::DontCare);
+            },
+            [this, &scene](const FrameGraph::Resources &) { renderSkybox(scene, 0); });
+    }
+
+    graph.addPass("Skybox",
+        [&](FrameGraph::PassBuilder &builder) {
+            if (skyLowRes != FrameGraph::INVALID_RESOURCE) builder.read(skyLowRes);
+            builder.writeColor(sceneColor);
+            builder.writeDepth(sceneDepth);
+        },
+        [this, &scene, skyLowRes](const FrameGraph::Resources &resources) { // Draw skybox last, reducing fragment shader calls
+            renderSkybox(scene, skyLowRes != FrameGraph::INVALID_RESOURCE ? resources.getTexture(skyLowRes) : 0);
+        });
+
+    // Next frame's occlusion tests run against this frame's depth
+    if (m_occlusionCulling && hiZ != FrameGraph::INVALID_RESOURCE) {
+        graph.addPass("HiZBuild",
+            [&](FrameGraph::PassBuilder &builder) {
+                builder.read(sceneDepth);
+                builder.write(hiZ);
+            },
+            [this, sceneDepth, viewProj](const FrameGraph::Resources &resources) {
+                m_culler.buildHiZ(resources.getTexture(sceneDepth), viewProj);
+            });
+    }
+
+    // Scene time, so paused or fixed step runs adapt like they animate
+    const float exposureDeltaTime = std::max(scene.getTime() - m_lastSceneTime, 0.0f);
+    m_lastSceneTime = scene.getTime();
+    graph.addPass("Exposure",
+        [&](FrameGraph::PassBuilder &builder) {
+            builder.read(sceneColor);
+            builder.sideEffect(); // writes the exposure buffer the tonemap reads
+        },
+        [this, sceneColor, exposureDeltaTime, renderWidth, renderHeight](const FrameGraph::Resources &resources) {
+            m_autoExposure.update(resources.getTexture(sceneColor), renderWidth, renderHeight, exposureDeltaTime);
+        });
+
+    graph.addPass("Tonemap",
+        [&](FrameGraph::PassBuilder &builder) {
+            builder.read(sceneColor);
+            builder.writeColor(backbuffer, LoadOp::DontCare);
+        },
+        [this, sceneColor](const FrameGraph::Resources &resources) { renderTonemap(resources.getTexture(sceneColor)); });
+
+    if (m_imguiEnabled) {
+        graph.addPass("ImGui",
+            [&](FrameGraph::PassBuilder &builder) { builder.writeColor(backbuffer); },
+            [](const FrameGraph::Resources &) {
+                // Finalize imGui frame
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            });
+    }
+}
+
+void Renderer::imGui() {
+    ImGui::Begin("Renderer");
 
-    // Render Passes
-    renderOpaquePass(scene, inputHandler);
-    renderLightSource(); // Draw the light cube
-    renderSkybox(scene); // Draw skybox last, reducing fragment shader calls
+    ImGui::Checkbox("Depth Pre-Pass", &m_depthPrePass);
+    if (m_visibilityBuffer.isSupported()) {
+        ImGui::Checkbox("Visibility Buffer (terrain, trees)", &m_visibilityBufferMode);
+        if (m_visibilityBufferMode && !m_visibilityBufferActive) ImGui::TextDisabled("Falling back to forward");
+    }
+    ImGui::Checkbox("Occlusion Culling (Hi-Z)", &m_occlusionCulling);
+
+    if (m_occlusionCulling) {
+        const auto &stats = m_culler.getStats();
+        const auto culledPercent = [](const GLuint tested, const GLuint visible) {
+            return tested > 0 ? 100.0f * static_cast<float>(tested - visible) / static_cast<float>(tested) : 0.0f;
+        };
+
+        ImGui::Text("Instances culled: %.1f%% (%u of %u)",
+                    culledPercent(stats.instancesTested, stats.instancesVisible),
+                    stats.instancesTested - stats.instancesVisible, stats.instancesTested);
+        ImGui::Text("Terrain chunks culled: %.1f%% (%u of %u)",
+                    culledPercent(stats.chunksTested, stats.chunksVisible),
+                    stats.chunksTested - stats.chunksVisible, stats.chunksTested);
+    }
+
+    const auto visibleObjects = std::ranges::count(m_objectVisibility, 1);
+    ImGui::Text("Objects frustum culled: %d of %d (%s)",
+                static_cast<int>(m_objectVisibility.size() - visibleObjects), static_cast<int>(m_objectVisibility.size()),
+                FrustumCulling::getName(FrustumCulling::resolve(FrustumCulling::Path::Auto)));
+
+    ImGui::Text("Point lights: %d visible of %d (clustered %dx%dx%d)",
+                m_clusteredLighting.getVisibleLightCount(), m_clusteredLighting.getTotalLightCount(),
+                ClusteredLighting::GRID_X, ClusteredLighting::GRID_Y, ClusteredLighting::GRID_Z);
+
+    m_shadows.imGui();
+    m_autoExposure.imGui();
+    m_dynamicResolution.imGui();
+    TextureLoader::get().imGui();
+
+    if (ImGui::CollapsingHeader("Frame Graph")) {
+        const auto &stats = m_frameGraph.getStats();
+        ImGui::Text("Passes: %d (%d culled)", stats.passesTotal, stats.passesCulled);
+        ImGui::Text("Transient textures: %d -> %d physical", stats.transientTextures, stats.physicalTextures);
+        ImGui::Text("Transient memory: %.1f MB -> %.1f MB",
+                    static_cast<float>(stats.transientBytes) / (1024.0f * 1024.0f),
+                    static_cast<float>(stats.physicalBytes) / (1024.0f * 1024.0f));
+        ImGui::Text("Framebuffer binds: %d, clears: %d", stats.framebufferBinds, stats.clears);
+    }
+
+    ImGui::End();
+}
+
+void Renderer::cullPass(const Scene &scene, const glm::mat4 &viewProj) {
+    m_culler.beginCulling(viewProj);
+    m_culler.cullTerrain(scene.getTerrain());
+    scene.getVegetation().cull(m_culler);
+    scene.getStaticBatches().cull(m_culler);
+    m_culler.endCulling();
+}
 
-    // Finalize imGui frame
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+void Renderer::cullObjects(const Scene &scene) {
+    PROFILE_SCOPE("Renderer::cullObjects");
+    const SceneObjectView objects = scene.getObjects();
+    m_objectVisibility.resize(objects.size());
+    FrustumCulling::cullSpheresParallel(m_frameUBO.getFrustum(), objects.bounds, m_objectVisibility.data());
 }
 
-void Renderer::renderOpaquePass(const Scene &scene, const InputHandler &inputHandler) {
-    const glm::vec3 sunDir = scene.getSunDirection();
+void Renderer::renderShadowPass(const Scene &scene) {
+    // Every cascade culls its casters into the buffers the camera's culling overwrites afterwards
+    const bool cameraCulling = m_cullingActive;
+    m_cullingActive = true;
 
-    const auto terrainShader = m_shaders["terrain"];
-    const auto& material = scene.getTerrainMaterial();
+    const SceneObjectView objects = scene.getObjects();
+    m_shadowVisibility.resize(objects.size());
+
+    for (int cascade = 0; cascade < ShadowCascades::CASCADE_COUNT; cascade++) {
+        if (!m_shadows.needsRender(cascade)) continue;
+
+        const glm::mat4 &view = m_shadows.getView(cascade);
+        const glm::mat4 &projection = m_shadows.getProjection(cascade);
+        m_frameUBO.bindView(view, projection); // the depth shaders read viewProj from the frame constants
+
+        m_culler.beginFrustumCulling(projection * view);
+        m_culler.cullTerrain(scene.getTerrain());
+        scene.getVegetation().cullShadowCasters(m_culler);
+        scene.getStaticBatches().cull(m_culler);
+        OcclusionCuller::endFrustumCulling();
+        FrustumCulling::cullSpheres(m_shadows.getFrustum(cascade), objects.bounds, m_shadowVisibility.data());
+
+        m_shadows.beginCascade(cascade);
+
+        const auto terrainShader = m_shaders["terrainDepth"];
+        terrainShader->use();
+        setTerrainTransform(*terrainShader, scene.getTerrain());
+        scene.getTerrain().renderDepth(true);
+
+        scene.getVegetation().renderShadowCasters(*this, *m_shaders["vegetationDepth"]);
+
+        const auto objShader = m_shaders["objectDepth"];
+        objShader->use();
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (!m_shadowVisibility[i]) continue;
+            objShader->setMat4("model", objects.worldMatrices[i]);
+            objects.models[i]->render(*objShader);
+        }
+
+        scene.getStaticBatches().render(*this, *m_shaders["objectInstancedDepth"]);
+    }
+
+    m_shadows.endCascades();
+    m_frameUBO.bind();
+    m_cullingActive = cameraCulling;
+}
+
+void Renderer::renderDepthPrePass(const Scene &scene) {
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    const auto terrainShader = m_shaders["terrainDepth"];
     terrainShader->use();
-    terrainShader->setVec3("u_SunDirection", sunDir);
-    terrainShader->setMat4("model", scene.getTerrain().getModelMatrix());
-    terrainShader->setFloat("u_RockHeight", material.rockHeight);
-    terrainShader->setFloat("u_SnowHeight", material.snowHeight);
-    scene.getTerrain().render(*terrainShader);
+    setTerrainTransform(*terrainShader, scene.getTerrain());
+    scene.getTerrain().renderDepth(m_cullingActive);
 
-    const auto vegShader = m_shaders["vegetation"];; // vegetation shader for trees, grass, etc.
-    vegShader->use();
-    vegShader->setVec3("u_SunDirection", sunDir); // sun moves so we set this uniform every frame
+    scene.getVegetation().render(*this, *m_shaders["vegetationDepth"]); // alpha tested, needs the diffuse texture
+
+    const auto objShader = m_shaders["objectDepth"];
+    objShader->use();
+    const SceneObjectView objects = scene.getObjects();
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!m_objectVisibility[i]) continue;
+        objShader->setMat4("model", objects.worldMatrices[i]);
+        objects.models[i]->render(*objShader);
+    }
+
+    scene.getStaticBatches().render(*this, *m_shaders["objectInstancedDepth"]);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void Renderer::renderOpaquePass(const Scene &scene, const InputHandler &inputHandler, const bool terrainAndVegetation) {
+    if (terrainAndVegetation) {
+        // The sun direction comes from the frame constants
+        const auto terrainShader = m_shaders["terrain"];
+        terrainShader->use();
+        setTerrainTransform(*terrainShader, scene.getTerrain());
+        scene.getTerrain().render(*terrainShader, m_cullingActive);
+
+        const auto vegShader = m_shaders["vegetation"]; // vegetation shader for trees, grass, etc.
+        scene.getVegetation().render(*this, *vegShader);
+    }
 
     const auto objShader = m_shaders["object"]; // object shader for things like trees, buildings, etc.
     objShader->use();
-    objShader->setVec3("u_SunDirection", sunDir);
     objShader->setBool("enableNormalMapping", inputHandler.isNormalMappingEnabled());
-    scene.getVegetation().render(*this, *vegShader);
 
-    for (const auto &object : scene.getObjects()) {
-        glm::mat4 modelMatrix = object.getTransform();
+    // Matrices are cached by SceneObjects, the normal matrix already handles non-uniform scaling
+    const SceneObjectView objects = scene.getObjects();
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!m_objectVisibility[i]) continue;
+        objShader->setMat4("model", objects.worldMatrices[i]);
+        objShader->setMat3("normalMatrix", objects.normalMatrices[i]);
 
-        // handle non-uniform scaling
-        auto normalMatrix = glm::mat3(glm::transpose(glm::inverse(modelMatrix)));
+        objects.models[i]->render(*objShader);
+    }
 
-        objShader->setMat4("model", modelMatrix);
-        objShader->setMat3("normalMatrix", normalMatrix);
+    const auto instancedShader = m_shaders["objectInstanced"];
+    instancedShader->use();
+    instancedShader->setBool("enableNormalMapping", inputHandler.isNormalMappingEnabled());
+    scene.getStaticBatches().render(*this, *instancedShader);
+}
 
-        object.model->render(*objShader);
-    }
+void Renderer::setTerrainTransform(const Shader &shader, const Terrain &terrain) {
+    const glm::mat4 model = terrain.getModelMatrix();
+    shader.setMat4("model", model);
+    shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
 }
 
 void Renderer::renderInstanced(const InstancedModel &batch, const Shader &shader) {
@@ -115,19 +501,33 @@ void Renderer::renderInstanced(const InstancedModel &batch, const Shader &shader
 
     shader.use();
 
-    for (const auto &mesh : batch.getModel()->getMeshes()) {
+    const auto &meshes = batch.getModel()->getMeshes();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const auto &mesh = meshes[i];
         mesh.getMaterial().bind(shader);
+        shader.setUInt("u_Mesh", static_cast<unsigned int>(i)); // only read by the visibility buffer pass
 
         const auto& vao = mesh.getVAO();
+        batch.bindInstances(vao, m_cullingActive);
         glBindVertexArray(vao.getID());
 
-        glDrawElementsInstanced(
-            GL_TRIANGLES,
-            static_cast<GLsizei>(mesh.getIndexCount()),
-            GL_UNSIGNED_INT,
-            nullptr,
-            batch.getInstanceCount()
-        );
+        if (m_cullingActive) {
+            // instanceCount was written by the culling compute shader
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.getCommandBufferID());
+            glDrawElementsIndirect(
+                GL_TRIANGLES,
+                GL_UNSIGNED_INT,
+                reinterpret_cast<const void *>(i * sizeof(DrawElementsIndirectCommand))
+            );
+        } else {
+            glDrawElementsInstanced(
+                GL_TRIANGLES,
+                static_cast<GLsizei>(mesh.getIndexCount()),
+                GL_UNSIGNED_INT,
+                nullptr,
+                batch.getInstanceCount()
+            );
+        }
     }
 }
 
@@ -158,19 +558,39 @@ void Renderer::setupLightCube() {
     m_lightSourceVao.bind();
 }
 
-void Renderer::renderSkybox(const Scene &scene) {
-    glDepthFunc(GL_LEQUAL);
+void Renderer::renderTonemap(const GLuint sceneColor) {
+    glDisable(GL_DEPTH_TEST); // the window's depth buffer is never cleared
 
-    const auto shader = m_shaders["skybox"];
+    const auto shader = m_shaders["tonemap"];
     shader->use();
+    glBindTextureUnit(0, sceneColor);
+    shader->setTextureUnit("u_Source", 0);
+    shader->setFloat("u_Sharpness", m_dynamicResolution.getSharpness());
+    m_autoExposure.bind(*shader);
+
+    m_fullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+void Renderer::renderSkybox(const Scene &scene, const GLuint lowResSky) {
+    const Skybox &skybox = scene.getSkybox();
 
-    scene.getSkybox().render(
-        *shader,
-        scene.getSunDirection(),
-        scene.getDayTime()
-    );
+    if (lowResSky != 0) {
+        const auto shader = m_shaders["skyUpsample"];
+        shader->use();
+        glBindTextureUnit(0, lowResSky);
+        shader->setTextureUnit("u_Sky", 0);
+        skybox.render(*shader);
+        return;
+    }
 
-    glDepthFunc(GL_LESS);
+    // Full resolution, or the low resolution target itself, which leaves the sun disc to the upsampling
+    const auto shader = m_shaders["sky"];
+    shader->use();
+    shader->setBool("u_SunDisc", !skybox.isQuarterResolution());
+    skybox.render(*shader);
 }
 
 void Renderer::reloadShaders() {
@@ -7,10 +7,19 @@
 #include "graphics/buffers/VAO.h"
 #include "graphics/buffers/VBO.h"
 #include "../graphics/buffers/EBO.h"
-#include "camera/CameraUBO.h"
+#include "camera/FrameUBO.h"
 #include <memory>
 
 #include "graphics/InstancedModel.h"
+#include "graphics/OcclusionCuller.h"
+#include "graphics/AutoExposure.h"
+#include "graphics/ClusteredLighting.h"
+#include "graphics/DynamicResolution.h"
+#include "graphics/ShadowCascades.h"
+#include "graphics/SkyIrradiance.h"
+#include "graphics/VisibilityBuffer.h"
+#include "FrameGraph.h"
+#include "utils/GpuProfiler.h"
 
 
 class Renderer {
@@ -24,32 +33,70 @@ public:
         screenWidth = width;
         screenHeight = height;
     }
-    void resize(const int width, const int height) {
-        screenWidth = width;
-        screenHeight = height;
-        glViewport(0, 0, width, height);
-    }
+    void resize(int width, int height);
+    void setImGuiEnabled(const bool enabled) { m_imguiEnabled = enabled; } // off for headless runs without a window
+    void setVisibilityBuffer(const bool enabled) { m_visibilityBufferMode = enabled; } // terrain and trees deferred
+    void setDynamicResolution(const bool enabled) { m_dynamicResolution.setEnabled(enabled); }
+
+    [[nodiscard]] bool isVisibilityBufferActive() const { return m_visibilityBufferActive; } // this frame's path
+
+    [[nodiscard]] const GpuProfiler& getGpuProfiler() const { return m_gpuProfiler; }
+    [[nodiscard]] GpuProfiler& getGpuProfiler() { return m_gpuProfiler; }
+    [[nodiscard]] const FrameData& getFrameData() const { return m_frameUBO.getData(); } // this frame's camera and frustum
 
 private:
     // Resources
     std::unordered_map<std::string, std::shared_ptr<Shader>> m_shaders;
-    CameraUBO m_cameraUBO;
+    FrameUBO m_frameUBO;
 
     // Light Source Visualization
     VAO m_lightSourceVao;
     VBO m_lightVbo;
     EBO m_lightEbo;
 
+    // Passes are declared every frame, the graph allocates the offscreen targets and binds the framebuffers
+    FrameGraph m_frameGraph;
+    VAO m_fullscreenVao; // empty, the fullscreen triangle is generated from gl_VertexID
+    OcclusionCuller m_culler;
+    ClusteredLighting m_clusteredLighting;
+    ShadowCascades m_shadows;
+    SkyIrradiance m_skyIrradiance;
+    VisibilityBuffer m_visibilityBuffer;
+    AutoExposure m_autoExposure;
+    DynamicResolution m_dynamicResolution;
+    GpuProfiler m_gpuProfiler;
+
+    bool m_imguiEnabled = true;
+    bool m_depthPrePass = true;
+    bool m_occlusionCulling = true;
+    bool m_visibilityBufferMode = false;
+    bool m_visibilityBufferActive = false; // mode on, and supported by the driver and the vegetation model
+    bool m_cullingActive = false; // culling results are valid for the draws of the current frame
+    std::vector<uint8_t> m_objectVisibility; // per dynamic scene object, from the CPU frustum test
+    std::vector<uint8_t> m_shadowVisibility; // the same for the shadow cascade being rendered
+    int m_shadowTerrainVersion = 0; // cached cascades are dropped when the terrain is regenerated
+    float m_lastSceneTime = 0.0f; // for the exposure's adaptation
+
     // Render Passes
-    void renderOpaquePass(const Scene& scene, const InputHandler& inputHandler);
-    void renderSkybox(const Scene& scene);
+    void buildFrameGraph(Scene& scene, const InputHandler& inputHandler, const glm::mat4& viewProj, const glm::mat4& projection);
+    void cullPass(const Scene& scene, const glm::mat4& viewProj);
+    void cullObjects(const Scene& scene); // dynamic objects, on the CPU against the FrameUBO frustum
+    void renderShadowPass(const Scene& scene); // the cascades ShadowCascades wants re-rendered this frame
+    void renderDepthPrePass(const Scene& scene);
+    void renderOpaquePass(const Scene& scene, const InputHandler& inputHandler, bool terrainAndVegetation);
+    void renderSkybox(const Scene& scene, GLuint lowResSky); // lowResSky: 0 to draw the sky itself, else upsample it
     void renderLightSource(); // Renders the white cube
+    void renderTonemap(GLuint sceneColor); // HDR scene colour to the window, exposed by m_autoExposure and upscaled
+    static void setTerrainTransform(const Shader& shader, const Terrain& terrain); // model and normal matrix
 
     // Helpers
+    void imGui();
     void setupShaders();
     void setupLightCube();
+    void updateRenderSize(); // the dynamic resolution of the window, resizes what depends on it
 
     // Screen dimensions
     int screenWidth = 800;
     int screenHeight = 600;
+    glm::ivec2 m_renderSize{0}; // offscreen targets, screen size times the dynamic resolution scale
 };
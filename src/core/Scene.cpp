@@ -3,20 +3,24 @@
 
 #include "Scene.h"
 #include <cmath> // For sin/cos
+#include <random>
 #include <imgui.h>
 
 #include "AssetManager.h"
 #include "world/Terrain.h"
 #include "world/TerrainGenerator.h"
+#include "utils/Profiler.h"
 
 Scene::Scene() = default;
 
 void Scene::initialize() {
+    PROFILE_SCOPE("Scene::initialize");
     auto& assets = AssetManager::get();
     m_skybox = std::make_unique<Skybox>();
 
     auto heightData = TerrainGenerator::generateHeights(2048, 2048, m_terrainParams);
     m_terrain = std::make_unique<Terrain>(2048, 2048, heightData);
+    m_terrain->updateSplatMap(m_terrainMaterial);
 
     m_vegetation = std::make_unique<VegetationPlacer>();
     m_vegetation->generate(*m_terrain, heightData, 2048);
@@ -25,8 +29,12 @@ void Scene::initialize() {
 }
 
 void Scene::update(const float deltaTime, const InputHandler& inputHandler) {
-    m_camera.processInput(inputHandler.getWindow(), deltaTime);
+    PROFILE_SCOPE("Scene::update");
+    if (inputHandler.getWindow()) { // headless benchmark runs drive the camera themselves
+        m_camera.processInput(inputHandler.getWindow(), deltaTime);
+    }
 
+    m_time += deltaTime;
     m_dayTime += deltaTime * 0.01f;
 
     const float x = std::cos(m_dayTime);
@@ -39,13 +47,65 @@ void Scene::update(const float deltaTime, const InputHandler& inputHandler) {
     m_sunDirection.z = y * std::sin(tilt) * -1.0f;
 
     m_sunDirection = glm::normalize(m_sunDirection);
+
+    // Nothing beyond the point where the fog hides all geometry needs rendering
+    m_fog.update(m_sunDirection);
+    m_camera.setFarPlane(m_fog.getVisibilityDistance(m_camera.getCameraPos(), m_terrain->getMaxHeight()));
+
+    for (size_t i = 0; i < m_lights.size(); i++) {
+        const glm::vec3& anchor = m_fireflyAnchors[i];
+        const float phase = static_cast<float>(i) * 1.618f; // golden ratio spreads the phases
+        m_lights.setPosition(i, anchor + glm::vec3(std::sin(m_time * 0.5f + phase) * 6.0f,
+                                                   std::sin(m_time * 1.3f + phase * 2.0f) * 1.5f,
+                                                   std::cos(m_time * 0.4f + phase) * 6.0f));
+    }
+
+    m_objects.updateTransforms(); // only objects moved since last frame
+    m_staticObjects.updateTransforms();
+    m_staticBatches.sync(m_staticObjects);
+}
+
+SceneObjects::Handle Scene::addStaticObject(const SceneObject& object) {
+    const SceneObjects::Handle handle = m_staticObjects.add(object);
+    m_staticBatches.add(handle, object.model);
+    return handle;
+}
+
+void Scene::removeStaticObject(const SceneObjects::Handle handle) {
+    m_staticBatches.remove(handle);
+    m_staticObjects.remove(handle);
+}
+
+void Scene::setFireflyCount(const int count) {
+    m_lights.clear();
+    m_fireflyAnchors.clear();
+
+    std::mt19937 rng(1337); // same lights every run
+    std::uniform_real_distribution<float> offset(-400.0f, 400.0f);
+    std::uniform_real_distribution<float> height(2.0f, 12.0f);
+    std::uniform_real_distribution<float> hue(0.0f, 1.0f);
+
+    for (int i = 0; i < count; i++) {
+        const float x = 1024.0f + offset(rng);
+        const float z = 1024.0f + offset(rng);
+        const glm::vec3 anchor(x, m_terrain->getHeightAt(x, z) + height(rng), z);
+        m_fireflyAnchors.push_back(anchor);
+
+        // Warm yellow to green
+        const glm::vec3 color = glm::mix(glm::vec3(1.0f, 0.8f, 0.3f), glm::vec3(0.5f, 1.0f, 0.3f), hue(rng)) * 40.0f;
+        m_lights.add(anchor, 15.0f, color);
+    }
 }
 
 void Scene::regenerateTerrain() {
+    PROFILE_SCOPE("Scene::regenerateTerrain");
     auto heightData = TerrainGenerator::generateHeights(2048, 2048, m_terrainParams);
     m_terrain = std::make_unique<Terrain>(2048, 2048, heightData);
+    m_terrain->updateSplatMap(m_terrainMaterial);
+    m_terrainVersion++;
 
     m_vegetation->generate(*m_terrain, heightData, 2048);
+    setFireflyCount(static_cast<int>(m_lights.size())); // back onto the new surface
 }
 
 void Scene::imGui() {
@@ -66,9 +126,25 @@ void Scene::imGui() {
 
     // Material & Shader Controls
     if (ImGui::TreeNode("Material & Shader")) {
-        ImGui::SliderFloat("Grass Limit", &m_terrainMaterial.grassHeight, 0.0f, 50.0f);
-        ImGui::SliderFloat("Rock Limit", &m_terrainMaterial.rockHeight, 0.0f, 100.0f);
-        ImGui::SliderFloat("Snow Limit", &m_terrainMaterial.snowHeight, 50.0f, 200.0f);
+        ImGui::SliderFloat("Grass Limit", &m_terrainMaterial.grassHeight, 0.0f, 50.0f); // not part of the splat weights
+        bool changed = false;
+        changed |= ImGui::SliderFloat("Rock Limit", &m_terrainMaterial.rockHeight, 0.0f, 100.0f);
+        changed |= ImGui::SliderFloat("Snow Limit", &m_terrainMaterial.snowHeight, 50.0f, 200.0f);
+
+        if (changed) {
+            m_terrain->updateSplatMap(m_terrainMaterial); // incremental, only tiles near the moved limits
+        }
+        ImGui::TreePop();
+    }
+
+    m_skybox->imGui();
+    m_fog.imGui(m_camera.getFarPlane());
+
+    if (ImGui::TreeNode("Point Lights")) {
+        int fireflies = static_cast<int>(m_lights.size());
+        if (ImGui::SliderInt("Fireflies", &fireflies, 0, 4096)) {
+            setFireflyCount(fireflies);
+        }
         ImGui::TreePop();
     }
 
@@ -5,9 +5,12 @@
 
 #include "camera/Camera.h"
 #include "graphics/Model.h"
+#include "world/HeightFog.h"
 #include "world/Skybox.h"
 #include "input/InputHandler.h"
-#include "SceneObject.h"
+#include "SceneObjects.h"
+#include "graphics/PointLights.h"
+#include "StaticBatcher.h"
 #include "world/Terrain.h"
 #include "world/VegetationPlacer.h"
 
@@ -26,16 +29,34 @@ public:
     Camera& getCamera() { return m_camera; }
     [[nodiscard]] const Camera& getCamera() const { return m_camera; }
 
-    [[nodiscard]] std::vector<SceneObject> getObjects() const { return m_objects; }
+    // Dynamic objects are drawn one by one, static ones are instanced per Model by the StaticBatcher
+    SceneObjects::Handle addObject(const SceneObject& object) { return m_objects.add(object); }
+    void removeObject(const SceneObjects::Handle handle) { m_objects.remove(handle); }
+    SceneObjects::Handle addStaticObject(const SceneObject& object);
+    void removeStaticObject(SceneObjects::Handle handle);
+
+    [[nodiscard]] SceneObjectView getObjects() const { return m_objects.view(); }
+    [[nodiscard]] SceneObjects& getObjectStorage() { return m_objects; }
+    [[nodiscard]] SceneObjects& getStaticObjectStorage() { return m_staticObjects; } // moving one re-uploads its matrix
+    [[nodiscard]] const StaticBatcher& getStaticBatches() const { return m_staticBatches; }
 
     [[nodiscard]] const Terrain& getTerrain() const { return *m_terrain; }
     void regenerateTerrain();
+    [[nodiscard]] int getTerrainVersion() const { return m_terrainVersion; } // changes with every regeneration
 
+    Skybox& getSkybox() { return *m_skybox; }
     [[nodiscard]] const Skybox& getSkybox() const { return *m_skybox; }
     [[nodiscard]] const VegetationPlacer& getVegetation() const { return *m_vegetation; }
+    [[nodiscard]] const HeightFog& getFog() const { return m_fog; }
 
     [[nodiscard]] glm::vec3 getSunDirection() const { return m_sunDirection; }
     [[nodiscard]] float getDayTime() const { return m_dayTime; }
+    void setDayTime(const float dayTime) { m_dayTime = dayTime; } // camera path playback starts where the recording did
+    [[nodiscard]] float getTime() const { return m_time; } // seconds of simulated time
+
+    // Fireflies drifting over the terrain centre, placed deterministically so benchmark runs match
+    void setFireflyCount(int count);
+    [[nodiscard]] const PointLights& getLights() const { return m_lights; }
 
     [[nodiscard]] const TerrainMaterial& getTerrainMaterial() const { return m_terrainMaterial; }
     [[nodiscard]] TerrainMaterial& getTerrainMaterialEdit() { return m_terrainMaterial; }
@@ -45,14 +66,22 @@ public:
 private:
     Camera m_camera;
     std::unique_ptr<Skybox> m_skybox;
+    HeightFog m_fog;
     std::unique_ptr<Terrain> m_terrain;
     std::unique_ptr<VegetationPlacer> m_vegetation;
 
     TerrainParams m_terrainParams;
     TerrainMaterial m_terrainMaterial;
+    int m_terrainVersion = 0;
+
+    SceneObjects m_objects;
+    SceneObjects m_staticObjects;
+    StaticBatcher m_staticBatches;
 
-    std::vector<SceneObject> m_objects;
+    PointLights m_lights;
+    std::vector<glm::vec3> m_fireflyAnchors; // the lights wander around these
 
+    float m_time = 0.0f;
     float m_dayTime = 0.0f;
     glm::vec3 m_sunDirection = glm::vec3(0.0f, 1.0f, 0.0f);
 };
@@ -0,0 +1,179 @@
+#include "SceneObjects.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "graphics/Model.h"
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
+namespace {
+    // Same matrix as SceneObject::getTransform (T * Ry * Rx * Rz * S), built directly from sines and cosines.
+    // The normal matrix of a rotation and scale is R * S^-1, so no general inverse is needed.
+    void composeTransform(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale,
+                          glm::mat4& world, glm::mat3& normal) {
+        const glm::vec3 r = glm::radians(rotation);
+        const float sx = std::sin(r.x), cx = std::cos(r.x);
+        const float sy = std::sin(r.y), cy = std::cos(r.y);
+        const float sz = std::sin(r.z), cz = std::cos(r.z);
+
+        // Columns of Ry * Rx * Rz
+        const glm::vec3 c0(cy * cz + sy * sx * sz, cx * sz, -sy * cz + cy * sx * sz);
+        const glm::vec3 c1(-cy * sz + sy * sx * cz, cx * cz, sy * sz + cy * sx * cz);
+        const glm::vec3 c2(sy * cx, -sx, cy * cx);
+
+        world[0] = glm::vec4(c0 * scale.x, 0.0f);
+        world[1] = glm::vec4(c1 * scale.y, 0.0f);
+        world[2] = glm::vec4(c2 * scale.z, 0.0f);
+        world[3] = glm::vec4(position, 1.0f);
+
+        normal[0] = c0 / scale.x;
+        normal[1] = c1 / scale.y;
+        normal[2] = c2 / scale.z;
+    }
+
+    // Sphere around the model's local bounding box, scaled by the largest axis scale
+    glm::vec4 boundingSphere(const Model* model, const glm::mat4& world) {
+        if (!model) return {glm::vec3(world[3]), 0.0f};
+
+        const glm::vec3 center = (model->getBoundsMin() + model->getBoundsMax()) * 0.5f;
+        const float radius = glm::length(model->getBoundsMax() - center);
+        const float maxScale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])),
+                                         glm::length(glm::vec3(world[2]))});
+        return {glm::vec3(world * glm::vec4(center, 1.0f)), radius * maxScale};
+    }
+}
+
+SceneObjects::Handle SceneObjects::add(const SceneObject& object) {
+    const auto index = static_cast<uint32_t>(m_models.size());
+
+    Handle handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_handleToIndex[handle] = index;
+    } else {
+        handle = static_cast<Handle>(m_handleToIndex.size());
+        m_handleToIndex.push_back(index);
+    }
+
+    m_positions.push_back(object.position);
+    m_rotations.push_back(object.rotation);
+    m_scales.push_back(object.scale);
+    m_worldMatrices.emplace_back(1.0f);
+    m_normalMatrices.emplace_back(1.0f);
+    m_models.push_back(object.model);
+    m_boundsX.push_back(0.0f);
+    m_boundsY.push_back(0.0f);
+    m_boundsZ.push_back(0.0f);
+    m_boundsRadius.push_back(0.0f);
+    m_isDirty.push_back(0);
+    m_indexToHandle.push_back(handle);
+
+    markDirty(index);
+    return handle;
+}
+
+void SceneObjects::remove(const Handle handle) {
+    const uint32_t index = m_handleToIndex[handle];
+    const auto last = static_cast<uint32_t>(m_models.size() - 1);
+
+    // A dirty entry for the removed object must not survive, and one for the moved object must follow it
+    if (m_isDirty[index]) std::erase(m_dirty, index);
+    if (index != last && m_isDirty[last]) std::ranges::replace(m_dirty, last, index);
+
+    const auto moveLast = [index]<typename T>(std::vector<T>& values) {
+        values[index] = std::move(values.back());
+        values.pop_back();
+    };
+
+    moveLast(m_positions);
+    moveLast(m_rotations);
+    moveLast(m_scales);
+    moveLast(m_worldMatrices);
+    moveLast(m_normalMatrices);
+    moveLast(m_models);
+    moveLast(m_boundsX);
+    moveLast(m_boundsY);
+    moveLast(m_boundsZ);
+    moveLast(m_boundsRadius);
+    moveLast(m_isDirty);
+    moveLast(m_indexToHandle);
+
+    if (index != last) {
+        m_handleToIndex[m_indexToHandle[index]] = index;
+    }
+    m_handleToIndex[handle] = UINT32_MAX;
+    m_freeHandles.push_back(handle);
+}
+
+void SceneObjects::clear() {
+    m_positions.clear();
+    m_rotations.clear();
+    m_scales.clear();
+    m_worldMatrices.clear();
+    m_normalMatrices.clear();
+    m_models.clear();
+    m_boundsX.clear();
+    m_boundsY.clear();
+    m_boundsZ.clear();
+    m_boundsRadius.clear();
+    m_isDirty.clear();
+    m_dirty.clear();
+    m_updated.clear();
+    m_handleToIndex.clear();
+    m_indexToHandle.clear();
+    m_freeHandles.clear();
+}
+
+void SceneObjects::setPosition(const Handle handle, const glm::vec3& position) {
+    const uint32_t index = m_handleToIndex[handle];
+    m_positions[index] = position;
+    markDirty(index);
+}
+
+void SceneObjects::setRotation(const Handle handle, const glm::vec3& rotation) {
+    const uint32_t index = m_handleToIndex[handle];
+    m_rotations[index] = rotation;
+    markDirty(index);
+}
+
+void SceneObjects::setScale(const Handle handle, const glm::vec3& scale) {
+    const uint32_t index = m_handleToIndex[handle];
+    m_scales[index] = scale;
+    markDirty(index);
+}
+
+void SceneObjects::markDirty(const uint32_t index) {
+    if (!m_isDirty[index]) {
+        m_isDirty[index] = 1;
+        m_dirty.push_back(index);
+    }
+}
+
+void SceneObjects::updateTransforms() {
+    m_updated.clear();
+    if (m_dirty.empty()) return;
+    PROFILE_SCOPE("SceneObjects::updateTransforms");
+
+    // Each dirty index is unique, so workers never write the same object
+    Parallel::forRange(0, static_cast<int>(m_dirty.size()), [this](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            const uint32_t index = m_dirty[i];
+            composeTransform(m_positions[index], m_rotations[index], m_scales[index],
+                             m_worldMatrices[index], m_normalMatrices[index]);
+
+            const glm::vec4 sphere = boundingSphere(m_models[index].get(), m_worldMatrices[index]);
+            m_boundsX[index] = sphere.x;
+            m_boundsY[index] = sphere.y;
+            m_boundsZ[index] = sphere.z;
+            m_boundsRadius[index] = sphere.w;
+            m_isDirty[index] = 0;
+        }
+    }, MIN_PARALLEL_BATCH);
+
+    for (const uint32_t index : m_dirty) {
+        m_updated.push_back(m_indexToHandle[index]);
+    }
+    m_dirty.clear();
+}
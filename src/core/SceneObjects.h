@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "SceneObject.h"
+#include "camera/Frustum.h"
+
+class Model;
+
+// Non-owning view of the scene objects for the Renderer. Index i of every span refers to the same object.
+// Only valid until objects are added or removed.
+struct SceneObjectView {
+    std::span<const std::shared_ptr<Model>> models;
+    std::span<const glm::mat4> worldMatrices;
+    std::span<const glm::mat3> normalMatrices;
+    SphereArrays bounds; // world-space bounding spheres for FrustumCulling
+
+    [[nodiscard]] size_t size() const { return models.size(); }
+    [[nodiscard]] bool empty() const { return models.empty(); }
+};
+
+// Structure-of-arrays storage for the scene objects. World and normal matrices are cached and only
+// recomputed for objects whose transform changed since the last updateTransforms().
+// Objects are addressed through stable handles, removal swaps the last object into the hole.
+class SceneObjects {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+    Handle add(const SceneObject& object);
+    void remove(Handle handle);
+    void clear();
+
+    void setPosition(Handle handle, const glm::vec3& position);
+    void setRotation(Handle handle, const glm::vec3& rotation); // degrees, applied Y, X, Z like SceneObject
+    void setScale(Handle handle, const glm::vec3& scale);
+
+    [[nodiscard]] const glm::vec3& getPosition(Handle handle) const { return m_positions[m_handleToIndex[handle]]; }
+    [[nodiscard]] const glm::vec3& getRotation(Handle handle) const { return m_rotations[m_handleToIndex[handle]]; }
+    [[nodiscard]] const glm::vec3& getScale(Handle handle) const { return m_scales[m_handleToIndex[handle]]; }
+    [[nodiscard]] const glm::mat4& getWorldMatrix(Handle handle) const { return m_worldMatrices[m_handleToIndex[handle]]; }
+    [[nodiscard]] const std::shared_ptr<Model>& getModel(Handle handle) const { return m_models[m_handleToIndex[handle]]; }
+
+    // Recomputes the cached matrices and bounds of the dirty objects, on worker threads for large batches
+    void updateTransforms();
+
+    [[nodiscard]] SceneObjectView view() const {
+        return {m_models, m_worldMatrices, m_normalMatrices,
+                {m_boundsX.data(), m_boundsY.data(), m_boundsZ.data(), m_boundsRadius.data(), m_models.size()}};
+    }
+    [[nodiscard]] size_t size() const { return m_models.size(); }
+    [[nodiscard]] size_t getDirtyCount() const { return m_dirty.size(); }
+    [[nodiscard]] std::span<const Handle> getUpdatedHandles() const { return m_updated; } // by the last updateTransforms()
+
+private:
+    static constexpr int MIN_PARALLEL_BATCH = 1024; // below this, threads cost more than they save
+
+    void markDirty(uint32_t index);
+
+    // Hot data first, one array per attribute
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_rotations;
+    std::vector<glm::vec3> m_scales;
+    std::vector<glm::mat4> m_worldMatrices;
+    std::vector<glm::mat3> m_normalMatrices;
+    std::vector<std::shared_ptr<Model>> m_models;
+    std::vector<float> m_boundsX; // bounding sphere centre and radius, one array per component
+    std::vector<float> m_boundsY;
+    std::vector<float> m_boundsZ;
+    std::vector<float> m_boundsRadius;
+    std::vector<uint8_t> m_isDirty; // per object, keeps m_dirty free of duplicates
+
+    std::vector<uint32_t> m_dirty; // indices to recompute
+    std::vector<Handle> m_updated;
+
+    std::vector<uint32_t> m_handleToIndex;
+    std::vector<Handle> m_indexToHandle;
+    std::vector<Handle> m_freeHandles;
+};
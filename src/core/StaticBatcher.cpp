@@ -0,0 +1,83 @@
+#include "StaticBatcher.h"
+
+#include "Renderer.h"
+#include "graphics/OcclusionCuller.h"
+#include "utils/Profiler.h"
+
+void StaticBatcher::add(const SceneObjects::Handle handle, const std::shared_ptr<Model>& model) {
+    Batch& batch = m_batches[model.get()];
+    if (!batch.instances) {
+        batch.instances = std::make_unique<InstancedModel>(model);
+    }
+
+    // The world matrix isn't computed yet, the instance is appended in sync()
+    m_members[handle] = {model.get(), -1};
+}
+
+void StaticBatcher::remove(const SceneObjects::Handle handle) {
+    const auto it = m_members.find(handle);
+    if (it == m_members.end()) return;
+
+    const auto [model, slot] = it->second;
+    m_members.erase(it);
+    if (slot < 0) return;
+
+    Batch& batch = m_batches[model];
+    batch.instances->removeInstance(slot);
+
+    // The last instance of the group now lives in the removed slot
+    const SceneObjects::Handle moved = batch.slotToHandle.back();
+    batch.slotToHandle[slot] = moved;
+    batch.slotToHandle.pop_back();
+    if (moved != handle) {
+        m_members[moved].slot = slot;
+    }
+
+    batch.dirty = true;
+}
+
+void StaticBatcher::clear() {
+    m_batches.clear();
+    m_members.clear();
+}
+
+void StaticBatcher::sync(const SceneObjects& objects) {
+    PROFILE_SCOPE("StaticBatcher::sync");
+
+    for (const SceneObjects::Handle handle : objects.getUpdatedHandles()) {
+        const auto it = m_members.find(handle);
+        if (it == m_members.end()) continue;
+
+        Member& member = it->second;
+        Batch& batch = m_batches[member.model];
+        const glm::mat4& world = objects.getWorldMatrix(handle);
+
+        if (member.slot < 0) {
+            member.slot = batch.instances->getInstanceCount();
+            batch.instances->addInstance(world);
+            batch.slotToHandle.push_back(handle);
+        } else {
+            batch.instances->updateInstance(member.slot, world);
+        }
+        batch.dirty = true;
+    }
+
+    for (auto& [model, batch] : m_batches) {
+        if (batch.dirty) {
+            batch.instances->finalize(); // uploads only the changed range
+            batch.dirty = false;
+        }
+    }
+}
+
+void StaticBatcher::render(Renderer& renderer, const Shader& shader) const {
+    for (const auto& [model, batch] : m_batches) {
+        renderer.renderInstanced(*batch.instances, shader);
+    }
+}
+
+void StaticBatcher::cull(const OcclusionCuller& culler) const {
+    for (const auto& [model, batch] : m_batches) {
+        culler.cullInstances(*batch.instances);
+    }
+}
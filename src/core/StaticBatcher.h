@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "SceneObjects.h"
+#include "graphics/InstancedModel.h"
+
+class Renderer;
+class Shader;
+class OcclusionCuller;
+
+// Groups static scene objects by Model and draws every group as one InstancedModel, through the same
+// instanced (and GPU culled) path as the vegetation.
+// Changes are incremental: adding an object appends one matrix, removing one moves the last matrix of its group
+// into the hole, and only the changed range of a group's instance buffer is uploaded.
+class StaticBatcher {
+public:
+    void add(SceneObjects::Handle handle, const std::shared_ptr<Model>& model);
+    void remove(SceneObjects::Handle handle);
+    void clear();
+
+    // Picks up the transforms recomputed by objects.updateTransforms() and uploads the groups that changed
+    void sync(const SceneObjects& objects);
+
+    void render(Renderer& renderer, const Shader& shader) const;
+    void cull(const OcclusionCuller& culler) const;
+
+    [[nodiscard]] size_t getBatchCount() const { return m_batches.size(); }
+
+private:
+    struct Batch {
+        std::unique_ptr<InstancedModel> instances;
+        std::vector<SceneObjects::Handle> slotToHandle;
+        bool dirty = false;
+    };
+
+    struct Member {
+        const Model* model;
+        GLsizei slot; // -1 until its first transform is known
+    };
+
+    std::unordered_map<const Model*, Batch> m_batches;
+    std::unordered_map<SceneObjects::Handle, Member> m_members;
+};
@@ -0,0 +1,69 @@
+#include "AutoExposure.h"
+
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+#include "Shader.h"
+#include "core/AssetManager.h"
+
+AutoExposure::~AutoExposure() {
+    if (m_histogram != 0) glDeleteBuffers(1, &m_histogram);
+    if (m_state != 0) glDeleteBuffers(1, &m_state);
+}
+
+void AutoExposure::initialize() {
+    auto& assetManager = AssetManager::get();
+    m_histogramShader = assetManager.loadComputeShader("assets/shaders/exposure_histogram.comp");
+    m_averageShader = assetManager.loadComputeShader("assets/shaders/exposure_average.comp");
+
+    // Both start zeroed, the averaging pass clears the histogram again after reading it
+    glCreateBuffers(1, &m_histogram);
+    glNamedBufferStorage(m_histogram, HISTOGRAM_BINS * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glClearNamedBufferData(m_histogram, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    constexpr float initialState[2] = {0.0f, 1.0f}; // not adapted yet, unit exposure
+    glCreateBuffers(1, &m_state);
+    glNamedBufferStorage(m_state, sizeof(initialState), initialState, 0);
+}
+
+void AutoExposure::update(const GLuint sceneColor, const int width, const int height, const float deltaTime) {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HISTOGRAM_BINDING, m_histogram);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_BINDING, m_state);
+
+    m_histogramShader->use();
+    bind(*m_histogramShader);
+    glBindTextureUnit(SCENE_UNIT, sceneColor);
+    glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_averageShader->use();
+    bind(*m_averageShader);
+    m_averageShader->setFloat("u_PixelCount", static_cast<float>(width) * static_cast<float>(height));
+    m_averageShader->setFloat("u_DeltaTime", deltaTime);
+    m_averageShader->setFloat("u_AdaptationRate", m_adaptationRate);
+    m_averageShader->setFloat("u_MinExposure", std::exp2(m_minEv));
+    m_averageShader->setFloat("u_MaxExposure", std::exp2(m_maxEv));
+    m_averageShader->setFloat("u_Compensation", std::exp2(m_compensation));
+    m_averageShader->setBool("u_Auto", m_auto);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // read by the tonemap and the next frame's passes
+}
+
+void AutoExposure::bind(const Shader& shader) const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_BINDING, m_state);
+    shader.setFloat("u_MinLogLuminance", m_minLogLuminance);
+    shader.setFloat("u_LogLuminanceRange", std::max(m_maxLogLuminance - m_minLogLuminance, 1.0f));
+}
+
+void AutoExposure::imGui() {
+    if (!ImGui::CollapsingHeader("Exposure")) return;
+
+    ImGui::Checkbox("Automatic", &m_auto);
+    ImGui::SliderFloat(m_auto ? "Compensation (EV)" : "Exposure (EV)", &m_compensation, -6.0f, 6.0f);
+    if (m_auto) {
+        ImGui::SliderFloat("Adaptation Rate", &m_adaptationRate, 0.1f, 10.0f);
+        ImGui::DragFloatRange2("Limits (EV)", &m_minEv, &m_maxEv, 0.1f, -12.0f, 12.0f);
+        ImGui::DragFloatRange2("Histogram (log2 lum)", &m_minLogLuminance, &m_maxLogLuminance, 0.1f, -16.0f, 16.0f);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <glad/glad.h>
+
+class Shader;
+
+// Exposure of the HDR scene colour, adapted over time like an eye. A compute pass bins the scene's log luminance
+// into a histogram, a second single workgroup pass reduces it to the average and eases the exposure towards
+// it. The result stays in a storage buffer that tonemap.frag reads, nothing is read back, and the cost only
+// depends on the resolution, not on what is in view.
+class AutoExposure {
+public:
+    static constexpr int HISTOGRAM_BINS = 256; // must match exposure.glsl
+
+    // Must match exposure.glsl
+    static constexpr GLuint HISTOGRAM_BINDING = 0;  // storage buffer, only used by the compute passes
+    static constexpr GLuint STATE_BINDING = 13;     // storage buffer, after the visibility buffer's
+    static constexpr GLuint SCENE_UNIT = 0;
+
+    AutoExposure() = default;
+    ~AutoExposure();
+
+    AutoExposure(const AutoExposure&) = delete;
+    AutoExposure& operator=(const AutoExposure&) = delete;
+
+    void initialize();
+
+    // Measures the scene colour and updates the exposure for the tonemap, which must come after
+    void update(GLuint sceneColor, int width, int height, float deltaTime);
+
+    void bind(const Shader& shader) const; // the state buffer and the uniforms exposure.glsl declares
+
+    void imGui();
+
+private:
+    std::shared_ptr<Shader> m_histogramShader;
+    std::shared_ptr<Shader> m_averageShader;
+    GLuint m_histogram = 0;
+    GLuint m_state = 0;
+
+    // Settings
+    bool m_auto = true;
+    float m_compensation = 0.0f;     // EV, the whole exposure when not automatic
+    float m_minEv = -4.0f;           // limits of the automatic exposure, keeps nights dark
+    float m_maxEv = 6.0f;
+    float m_adaptationRate = 1.5f;   // 1 / seconds
+    float m_minLogLuminance = -10.0f;
+    float m_maxLogLuminance = 6.0f;
+};
@@ -0,0 +1,196 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Interpolation weights of BC7's 4-bit indices, out of 64
+    constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Blocks are little-endian bit streams
+    class BitWriter {
+    public:
+        explicit BitWriter(uint8_t* out) : m_out(out) {}
+
+        void put(const uint32_t value, const int bits) {
+            for (int i = 0; i < bits; i++, m_position++) {
+                if ((value >> i) & 1u) {
+                    m_out[m_position >> 3] |= static_cast<uint8_t>(1u << (m_position & 7));
+                }
+            }
+        }
+
+    private:
+        uint8_t* m_out;
+        int m_position = 0;
+    };
+
+    // 7 bits per channel plus a p-bit shared by the endpoint's channels, which becomes the lowest bit of all four
+    struct Endpoint {
+        int channels[4];
+        int pBit;
+    };
+
+    Endpoint quantizeEndpoint(const float value[4]) {
+        Endpoint best{};
+        float bestError = -1.0f;
+        for (int pBit = 0; pBit < 2; pBit++) {
+            Endpoint candidate{{}, pBit};
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                candidate.channels[c] = std::clamp(static_cast<int>(std::lround((value[c] - pBit) * 0.5f)), 0, 127);
+                const float difference = static_cast<float>(candidate.channels[c] << 1 | pBit) - value[c];
+                error += difference * difference;
+            }
+            if (bestError < 0.0f || error < bestError) {
+                best = candidate;
+                bestError = error;
+            }
+        }
+        return best;
+    }
+
+    // Principal axis of the block's colours by power iteration on their covariance, zero for a flat block
+    void principalAxis(const uint8_t rgba[64], const float mean[4], float axis[4]) {
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++) {
+            float d[4];
+            for (int c = 0; c < 4; c++) d[c] = rgba[i * 4 + c] - mean[c];
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) covariance[r][c] += d[r] * d[c];
+            }
+        }
+
+        // Start from the row of the channel that varies most, it can't be orthogonal to the principal axis
+        int start = 0;
+        for (int c = 1; c < 4; c++) {
+            if (covariance[c][c] > covariance[start][start]) start = c;
+        }
+        std::memcpy(axis, covariance[start], sizeof(float) * 4);
+
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float length = 0.0f;
+            for (int c = 0; c < 4; c++) length += axis[c] * axis[c];
+            length = std::sqrt(length);
+            if (length < 1e-6f) {
+                std::fill_n(axis, 4, 0.0f);
+                return;
+            }
+
+            float next[4] = {};
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) next[r] += covariance[r][c] * axis[c] / length;
+            }
+            std::memcpy(axis, next, sizeof(next));
+        }
+
+        float length = 0.0f;
+        for (int c = 0; c < 4; c++) length += axis[c] * axis[c];
+        length = std::sqrt(length);
+        for (int c = 0; c < 4; c++) axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+    }
+}
+
+void BlockCompression::encodeBC4(const uint8_t values[16], uint8_t out[8]) {
+    const auto [lowest, highest] = std::minmax_element(values, values + 16);
+    const int lo = *lowest;
+    const int hi = *highest;
+
+    // red0 > red1 selects the 8-value mode: codes 0 and 1 are the endpoints, 2-7 the 6 steps from red0 to red1
+    out[0] = static_cast<uint8_t>(hi);
+    out[1] = static_cast<uint8_t>(lo);
+
+    uint64_t bits = 0;
+    if (hi > lo) {
+        const float scale = 7.0f / static_cast<float>(hi - lo);
+        for (int i = 0; i < 16; i++) {
+            const auto step = static_cast<int>(std::lround(static_cast<float>(hi - values[i]) * scale));
+            const uint64_t code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            bits |= code << (3 * i);
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+void BlockCompression::encodeBC5(const uint8_t red[16], const uint8_t green[16], uint8_t out[16]) {
+    encodeBC4(red, out);
+    encodeBC4(green, out + 8);
+}
+
+void BlockCompression::encodeBC7(const uint8_t rgba[64], uint8_t out[16]) {
+    float mean[4] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) mean[c] += rgba[i * 4 + c] / 16.0f;
+    }
+
+    float axis[4];
+    principalAxis(rgba, mean, axis);
+
+    // Range fit: the endpoints are the extreme projections onto the axis
+    float tMin = 0.0f, tMax = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < 4; c++) t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    float ends[2][4];
+    for (int c = 0; c < 4; c++) {
+        ends[0][c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+        ends[1][c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+    }
+    Endpoint endpoints[2] = {quantizeEndpoint(ends[0]), quantizeEndpoint(ends[1])};
+
+    // Indices against the palette the decoder will actually build from the quantized endpoints
+    int indices[16];
+    const auto selectIndices = [&] {
+        int palette[16][4];
+        for (int w = 0; w < 16; w++) {
+            for (int c = 0; c < 4; c++) {
+                const int e0 = endpoints[0].channels[c] << 1 | endpoints[0].pBit;
+                const int e1 = endpoints[1].channels[c] << 1 | endpoints[1].pBit;
+                palette[w][c] = ((64 - BC7_WEIGHTS[w]) * e0 + BC7_WEIGHTS[w] * e1 + 32) >> 6;
+            }
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int bestError = 1 << 30;
+            for (int w = 0; w < 16; w++) {
+                int error = 0;
+                for (int c = 0; c < 4; c++) {
+                    const int difference = palette[w][c] - rgba[i * 4 + c];
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    indices[i] = w;
+                }
+            }
+        }
+    };
+    selectIndices();
+
+    // The first texel's index is stored with 3 bits, its top bit must be 0: swap the endpoints otherwise
+    if (indices[0] >= 8) {
+        std::swap(endpoints[0], endpoints[1]);
+        for (int& index : indices) index = 15 - index;
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer(out);
+    writer.put(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.put(endpoints[0].channels[c], 7);
+        writer.put(endpoints[1].channels[c], 7);
+    }
+    writer.put(endpoints[0].pBit, 1);
+    writer.put(endpoints[1].pBit, 1);
+    for (int i = 0; i < 16; i++) {
+        writer.put(indices[i], i == 0 ? 3 : 4);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// CPU encoders for the block compressed formats the texture cache cooks to. Every call encodes one 4x4 block of
+// texels given in row-major order. They favour speed over the last bit of quality: the endpoints are fitted once
+// along the block's principal axis (range fit) instead of being searched.
+namespace BlockCompression {
+    // BC4 (GL_COMPRESSED_RED_RGTC1): one channel, 8 bytes
+    void encodeBC4(const uint8_t values[16], uint8_t out[8]);
+
+    // BC5 (GL_COMPRESSED_RG_RGTC2): two independent BC4 blocks, 16 bytes
+    void encodeBC5(const uint8_t red[16], const uint8_t green[16], uint8_t out[16]);
+
+    // BC7 (GL_COMPRESSED_RGBA_BPTC_UNORM and its sRGB variant), mode 6 only: one subset, RGBA endpoints with
+    // 7 bits and a p-bit each, 16 interpolation steps. 16 bytes.
+    void encodeBC7(const uint8_t rgba[64], uint8_t out[16]);
+}
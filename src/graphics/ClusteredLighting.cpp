@@ -0,0 +1,104 @@
+#include "ClusteredLighting.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Shader.h"
+#include "camera/Frustum.h"
+#include "core/AssetManager.h"
+#include "utils/Profiler.h"
+
+namespace {
+    constexpr int BOUNDS_GROUP_SIZE = 64;  // cluster_bounds.comp
+    constexpr int ASSIGN_GROUP_SIZE = 128; // cluster_assign.comp
+
+    GLuint groupCount(const int items, const int groupSize) {
+        return static_cast<GLuint>((items + groupSize - 1) / groupSize);
+    }
+}
+
+ClusteredLighting::~ClusteredLighting() {
+    if (m_clusterBounds != 0) glDeleteBuffers(1, &m_clusterBounds);
+    if (m_lightCounts != 0) glDeleteBuffers(1, &m_lightCounts);
+    if (m_lightIndices != 0) glDeleteBuffers(1, &m_lightIndices);
+}
+
+void ClusteredLighting::initialize() {
+    const std::string path = "assets/shaders/";
+    auto& assetManager = AssetManager::get();
+
+    m_boundsShader = assetManager.loadComputeShader(path + "cluster_bounds.comp");
+    m_assignShader = assetManager.loadComputeShader(path + "cluster_assign.comp");
+
+    // Written and read only by the GPU
+    glCreateBuffers(1, &m_clusterBounds);
+    glNamedBufferStorage(m_clusterBounds, CLUSTER_COUNT * 2 * sizeof(glm::vec4), nullptr, 0);
+    glCreateBuffers(1, &m_lightCounts);
+    glNamedBufferStorage(m_lightCounts, CLUSTER_COUNT * sizeof(GLuint), nullptr, 0);
+    glCreateBuffers(1, &m_lightIndices);
+    glNamedBufferStorage(m_lightIndices, CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(GLuint), nullptr, 0);
+
+    // Parameters and the lights share one streamed region per frame, padded for the two alignments
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &m_storageAlignment);
+    m_stream.generate(2 * std::max<GLsizeiptr>(m_storageAlignment, 256) + sizeof(ClusterParams) + MAX_LIGHTS * sizeof(GpuPointLight));
+    m_visible.reserve(MAX_LIGHTS);
+}
+
+void ClusteredLighting::update(const PointLights& lights, const Frustum& frustum, const glm::mat4& projection) {
+    PROFILE_SCOPE("ClusteredLighting::update");
+
+    // Only lights touching the frustum can reach a cluster
+    m_visible.resize(lights.size());
+    FrustumCulling::cullSpheresParallel(frustum, lights.spheres(), m_visible.data());
+
+    m_stream.beginFrame();
+
+    const auto lightCount = static_cast<int>(std::min<size_t>(std::ranges::count(m_visible, 1), MAX_LIGHTS));
+    m_lightsSize = std::max<GLsizeiptr>(1, lightCount) * static_cast<GLsizeiptr>(sizeof(GpuPointLight)); // empty ranges can't be bound
+    const StreamingBuffer::Allocation lightAllocation = m_stream.allocate(m_lightsSize, m_storageAlignment);
+    m_lightsOffset = lightAllocation.offset;
+
+    auto* gpuLights = static_cast<GpuPointLight*>(lightAllocation.data);
+    int written = 0;
+    for (size_t i = 0; i < lights.size() && written < lightCount; i++) {
+        if (!m_visible[i]) continue;
+        gpuLights[written++] = {glm::vec4(lights.x[i], lights.y[i], lights.z[i], lights.radius[i]), glm::vec4(lights.color[i], 0.0f)};
+    }
+    m_visibleLightCount = written;
+
+    // Near and far back out of the OpenGL perspective matrix
+    const float near = projection[3][2] / (projection[2][2] - 1.0f);
+    const float far = projection[3][2] / (projection[2][2] + 1.0f);
+    const float logDepthRange = std::log(far / near);
+
+    const ClusterParams params{
+        glm::uvec4(GRID_X, GRID_Y, GRID_Z, written),
+        glm::vec4(GRID_Z / logDepthRange, -GRID_Z * std::log(near) / logDepthRange, near, far)
+    };
+    m_paramsOffset = m_stream.write(&params, sizeof(ClusterParams));
+
+    bind();
+
+    if (projection != m_boundsProjection) {
+        m_boundsProjection = projection;
+        m_boundsShader->use();
+        glDispatchCompute(groupCount(CLUSTER_COUNT, BOUNDS_GROUP_SIZE), 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    m_assignShader->use();
+    glDispatchCompute(groupCount(CLUSTER_COUNT, ASSIGN_GROUP_SIZE), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // the lit passes read the light lists
+}
+
+void ClusteredLighting::endFrame() {
+    m_stream.endFrame();
+}
+
+void ClusteredLighting::bind() const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, PARAMS_BINDING, m_stream.getID(), m_paramsOffset, sizeof(ClusterParams));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, LIGHTS_BINDING, m_stream.getID(), m_lightsOffset, m_lightsSize);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_COUNTS_BINDING, m_lightCounts);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDICES_BINDING, m_lightIndices);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BOUNDS_BINDING, m_clusterBounds);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "PointLights.h"
+#include "buffers/StreamingBuffer.h"
+
+class Shader;
+struct Frustum;
+
+// Clustered forward shading. The view frustum is split into GRID_X * GRID_Y screen tiles and GRID_Z exponential
+// depth slices. Every frame the lights inside the frustum (FrustumCulling on the CPU) are streamed to the GPU and
+// a compute shader writes each cluster's light list. Fragment shaders (clustered_lighting.glsl) look up their
+// cluster and only loop over its lights, so the cost per pixel follows the local light density, not the total.
+class ClusteredLighting {
+public:
+    // Must match cluster_common.glsl
+    static constexpr int GRID_X = 16;
+    static constexpr int GRID_Y = 9;
+    static constexpr int GRID_Z = 24;
+    static constexpr int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+    static constexpr int MAX_LIGHTS = 4096; // visible lights per frame, the rest are dropped
+    static constexpr int MAX_LIGHTS_PER_CLUSTER = 128;
+
+    // Binding points, shared by the compute and fragment shaders
+    static constexpr GLuint PARAMS_BINDING = 1;         // uniform block
+    static constexpr GLuint LIGHTS_BINDING = 4;         // storage blocks from here on
+    static constexpr GLuint LIGHT_COUNTS_BINDING = 5;
+    static constexpr GLuint LIGHT_INDICES_BINDING = 6;
+    static constexpr GLuint CLUSTER_BOUNDS_BINDING = 7;
+
+    ClusteredLighting() = default;
+    ~ClusteredLighting();
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    void initialize();
+
+    // Culls and uploads the lights, rebuilds the cluster bounds if the projection changed, assigns lights to
+    // clusters and leaves everything bound for the lit passes. Needs the frame constants bound.
+    void update(const PointLights& lights, const Frustum& frustum, const glm::mat4& projection);
+    void endFrame(); // after the frame's commands are submitted, fences the streamed lights
+
+    [[nodiscard]] int getVisibleLightCount() const { return m_visibleLightCount; }
+    [[nodiscard]] int getTotalLightCount() const { return static_cast<int>(m_visible.size()); }
+
+private:
+    // std430 layout of PointLight in cluster_common.glsl
+    struct GpuPointLight {
+        glm::vec4 positionRadius;
+        glm::vec4 color;
+    };
+
+    // std140 layout of ClusterParams in cluster_common.glsl
+    struct ClusterParams {
+        glm::uvec4 gridSize; // w: light count
+        glm::vec4 zParams;   // slice scale, slice bias, near, far
+    };
+
+    void bind() const;
+
+    std::shared_ptr<Shader> m_boundsShader;
+    std::shared_ptr<Shader> m_assignShader;
+
+    GLuint m_clusterBounds = 0;
+    GLuint m_lightCounts = 0;
+    GLuint m_lightIndices = 0;
+    StreamingBuffer m_stream; // parameters and lights, rewritten every frame
+    GLint m_storageAlignment = 256;
+
+    GLintptr m_paramsOffset = 0;
+    GLintptr m_lightsOffset = 0;
+    GLsizeiptr m_lightsSize = 0;
+
+    glm::mat4 m_boundsProjection{0.0f}; // projection the cluster bounds were built for
+    std::vector<uint8_t> m_visible;
+    int m_visibleLightCount = 0;
+};
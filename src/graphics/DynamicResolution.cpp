@@ -0,0 +1,55 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+#include "utils/GpuProfiler.h"
+
+void DynamicResolution::update(const GpuProfiler& profiler) {
+    if (!m_enabled || profiler.getRecordedFrames() == m_lastRecordedFrame) return;
+    m_lastRecordedFrame = profiler.getRecordedFrames();
+
+    // Frames rendered before the last change are still in the measurements for a while
+    if (m_cooldown > 0) {
+        m_cooldown--;
+        return;
+    }
+
+    const float frameMs = profiler.getFrameGpuLast();
+    m_smoothedMs = m_smoothedMs > 0.0f ? glm::mix(m_smoothedMs, frameMs, 0.2f) : frameMs;
+
+    // GPU time is roughly proportional to the pixel count, the square of the scale. Down is fast, up is one step.
+    float scale = m_scale;
+    if (m_smoothedMs > m_targetMs) {
+        const float wanted = m_scale * std::sqrt(m_targetMs * RAISE_THRESHOLD / m_smoothedMs);
+        scale = std::min(std::floor(wanted / SCALE_STEP) * SCALE_STEP, m_scale - SCALE_STEP);
+    } else if (m_smoothedMs < m_targetMs * RAISE_THRESHOLD * RAISE_THRESHOLD) {
+        scale = m_scale + SCALE_STEP;
+    }
+    scale = std::clamp(scale, m_minScale, m_maxScale);
+
+    if (std::abs(scale - m_scale) > 0.5f * SCALE_STEP) {
+        m_scale = scale;
+        m_smoothedMs = 0.0f;
+        m_cooldown = COOLDOWN_FRAMES;
+    }
+}
+
+glm::ivec2 DynamicResolution::getRenderSize(const int width, const int height) const {
+    const float scale = getScale();
+    return {std::max(1, static_cast<int>(std::lround(static_cast<float>(width) * scale))),
+            std::max(1, static_cast<int>(std::lround(static_cast<float>(height) * scale)))};
+}
+
+void DynamicResolution::imGui() {
+    if (!ImGui::CollapsingHeader("Dynamic Resolution")) return;
+
+    ImGui::Checkbox("Enabled", &m_enabled);
+    ImGui::SliderFloat("Target Frame Time (ms)", &m_targetMs, 4.0f, 50.0f);
+    if (ImGui::DragFloatRange2("Scale Limits", &m_minScale, &m_maxScale, 0.01f, 0.25f, 1.0f)) {
+        m_scale = std::clamp(m_scale, m_minScale, m_maxScale);
+    }
+    ImGui::SliderFloat("Sharpness", &m_sharpness, 0.0f, 1.0f);
+    ImGui::Text("Scale: %.0f%%, GPU %.2f ms (smoothed)", getScale() * 100.0f, m_smoothedMs);
+}
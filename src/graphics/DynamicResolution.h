@@ -0,0 +1,39 @@
+#pragma once
+#include <glm/glm.hpp>
+
+class GpuProfiler;
+
+// Scales the resolution the scene is rendered at to keep the GPU frame time within a budget. The scale drops as
+// soon as frames run over the target and only climbs back once they are well below it (hysteresis), with a
+// cooldown between changes since every measurement arrives a few frames late.
+// Scales snap to SCALE_STEP, so the frame graph's pooled render targets are only reallocated on an actual change.
+// The tonemap pass upscales to the window with bilinear filtering and contrast adaptive sharpening.
+class DynamicResolution {
+public:
+    static constexpr float SCALE_STEP = 0.05f;
+
+    void update(const GpuProfiler& profiler); // once per frame, before the render size is used
+
+    [[nodiscard]] glm::ivec2 getRenderSize(int width, int height) const; // of a window this size
+    [[nodiscard]] float getScale() const { return m_enabled ? m_scale : 1.0f; }
+    [[nodiscard]] float getSharpness() const { return getScale() < 1.0f ? m_sharpness : 0.0f; }
+
+    void setEnabled(const bool enabled) { m_enabled = enabled; }
+
+    void imGui();
+
+private:
+    static constexpr int COOLDOWN_FRAMES = 30;
+    static constexpr float RAISE_THRESHOLD = 0.85f; // of the target frame time, below it the scale may grow
+
+    bool m_enabled = true;
+    float m_targetMs = 16.6f;
+    float m_minScale = 0.5f; // per axis
+    float m_maxScale = 1.0f;
+    float m_sharpness = 0.5f;
+
+    float m_scale = 1.0f;
+    float m_smoothedMs = 0.0f; // 0 until the first sample after a change
+    int m_lastRecordedFrame = 0;
+    int m_cooldown = 0;
+};
@@ -0,0 +1,332 @@
+#include "GltfLoader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glm/glm.hpp>
+
+#include "MeshOptimizer.h"
+#include "core/AssetManager.h"
+#include "utils/Json.h"
+#include "utils/MappedFile.h"
+#include "utils/Profiler.h"
+
+namespace {
+    // glTF enums
+    constexpr int COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr int COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr int COMPONENT_UNSIGNED_INT = 5125;
+    constexpr int COMPONENT_FLOAT = 5126;
+    constexpr int MODE_TRIANGLES = 4;
+
+    int componentSize(const int componentType) {
+        switch (componentType) {
+            case COMPONENT_UNSIGNED_BYTE: return 1;
+            case COMPONENT_UNSIGNED_SHORT: return 2;
+            case COMPONENT_UNSIGNED_INT: case COMPONENT_FLOAT: return 4;
+            default: return 0;
+        }
+    }
+
+    int componentCount(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    // An accessor resolved to its bytes in a mapped buffer
+    struct Accessor {
+        const unsigned char* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0; // bytes between elements
+        int componentType = 0;
+        int components = 0;
+
+        [[nodiscard]] const float* floatAt(const size_t i) const {
+            return reinterpret_cast<const float*>(data + i * stride);
+        }
+
+        [[nodiscard]] uint32_t indexAt(const size_t i) const {
+            const unsigned char* element = data + i * stride;
+            switch (componentType) {
+                case COMPONENT_UNSIGNED_BYTE: return *element;
+                case COMPONENT_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, element, 2); return v; }
+                default: { uint32_t v; std::memcpy(&v, element, 4); return v; }
+            }
+        }
+    };
+
+    class Document {
+    public:
+        bool open(const std::string& path) {
+            std::ifstream file(path);
+            if (!file.is_open()) return warn("could not open " + path);
+            std::stringstream text;
+            text << file.rdbuf();
+
+            std::string error;
+            auto json = JsonValue::parse(text.str(), error);
+            if (!json) return warn(path + ": " + error);
+            m_json = std::move(*json);
+
+            if (!m_json["asset"]["version"].asString().starts_with("2")) return warn("not glTF 2.0");
+            if (m_json["extensionsRequired"].size() > 0) return warn("requires extensions");
+
+            m_directory = path.substr(0, path.find_last_of('/'));
+
+            const JsonValue& buffers = m_json["buffers"];
+            m_buffers.resize(buffers.size());
+            for (size_t i = 0; i < buffers.size(); i++) {
+                const std::string& uri = buffers[i]["uri"].asString();
+                if (uri.empty() || uri.starts_with("data:")) return warn("embedded buffers are not supported");
+                if (!m_buffers[i].open(m_directory + "/" + uri)) return warn("could not map " + uri);
+                if (m_buffers[i].getSize() < static_cast<size_t>(buffers[i]["byteLength"].asNumber())) {
+                    return warn(uri + " is shorter than its byteLength");
+                }
+            }
+            return true;
+        }
+
+        // Bounds checked against the buffer view and the mapped file
+        bool accessor(const JsonValue& index, Accessor& out) const {
+            const JsonValue& accessor = m_json["accessors"][static_cast<size_t>(index.asInt(-1))];
+            if (!accessor.isObject()) return warn("missing accessor");
+            if (accessor.contains("sparse")) return warn("sparse accessors are not supported");
+
+            const JsonValue& view = m_json["bufferViews"][static_cast<size_t>(accessor["bufferView"].asInt(-1))];
+            const auto bufferIndex = static_cast<size_t>(view["buffer"].asInt(-1));
+            if (!view.isObject() || bufferIndex >= m_buffers.size()) return warn("missing buffer view");
+
+            out.componentType = accessor["componentType"].asInt();
+            out.components = componentCount(accessor["type"].asString());
+            out.count = static_cast<size_t>(accessor["count"].asNumber());
+            const size_t elementSize = static_cast<size_t>(componentSize(out.componentType)) * out.components;
+            if (elementSize == 0) return warn("unsupported accessor type");
+
+            out.stride = view.contains("byteStride") ? static_cast<size_t>(view["byteStride"].asNumber()) : elementSize;
+            const size_t viewOffset = static_cast<size_t>(view["byteOffset"].asNumber());
+            const size_t viewLength = static_cast<size_t>(view["byteLength"].asNumber());
+            const size_t offset = static_cast<size_t>(accessor["byteOffset"].asNumber());
+
+            const size_t end = out.count == 0 ? offset : offset + (out.count - 1) * out.stride + elementSize;
+            if (end > viewLength || viewOffset + viewLength > m_buffers[bufferIndex].getSize()) {
+                return warn("accessor out of bounds");
+            }
+
+            out.data = m_buffers[bufferIndex].getData() + viewOffset + offset;
+            return true;
+        }
+
+        [[nodiscard]] const JsonValue& json() const { return m_json; }
+        [[nodiscard]] const std::string& directory() const { return m_directory; }
+
+        static bool warn(const std::string& reason) {
+            std::cerr << "WARNING::GLTF:: " << reason << ", falling back to Assimp" << std::endl;
+            return false;
+        }
+
+    private:
+        JsonValue m_json;
+        std::string m_directory;
+        std::vector<MappedFile> m_buffers;
+    };
+
+    // glTF matrices are column-major like glm's, TRS nodes compose translation * rotation * scale
+    glm::mat4 localTransform(const JsonValue& node) {
+        glm::mat4 result(1.0f);
+        const JsonValue& matrix = node["matrix"];
+        if (matrix.size() == 16) {
+            for (int c = 0; c < 4; c++) {
+                for (int r = 0; r < 4; r++) result[c][r] = static_cast<float>(matrix[c * 4 + r].asNumber());
+            }
+            return result;
+        }
+
+        const JsonValue& t = node["translation"];
+        const JsonValue& q = node["rotation"];
+        const JsonValue& s = node["scale"];
+        const float x = static_cast<float>(q[0].asNumber()), y = static_cast<float>(q[1].asNumber());
+        const float z = static_cast<float>(q[2].asNumber()), w = static_cast<float>(q[3].asNumber(1.0));
+
+        const glm::mat3 rotation(
+            glm::vec3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w)),
+            glm::vec3(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w)),
+            glm::vec3(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y)));
+        for (int c = 0; c < 3; c++) {
+            result[c] = glm::vec4(rotation[c] * static_cast<float>(s[static_cast<size_t>(c)].asNumber(1.0)), 0.0f);
+        }
+        result[3] = glm::vec4(static_cast<float>(t[0].asNumber()), static_cast<float>(t[1].asNumber()),
+                              static_cast<float>(t[2].asNumber()), 1.0f);
+        return result;
+    }
+
+    // One output mesh per material
+    struct MeshBuilder {
+        int material = -1;
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    class Loader {
+    public:
+        explicit Loader(const Document& document) : m_document(document) {}
+
+        bool visit(const size_t nodeIndex, const glm::mat4& parent, const int depth) {
+            const JsonValue& node = m_document.json()["nodes"][nodeIndex];
+            if (!node.isObject() || depth > 64) return Document::warn("invalid node hierarchy");
+
+            const glm::mat4 transform = parent * localTransform(node);
+            if (node.contains("mesh")) {
+                const JsonValue& primitives = m_document.json()["meshes"][static_cast<size_t>(node["mesh"].asInt(-1))]["primitives"];
+                for (size_t i = 0; i < primitives.size(); i++) {
+                    if (!addPrimitive(primitives[i], transform)) return false;
+                }
+            }
+
+            const JsonValue& children = node["children"];
+            for (size_t i = 0; i < children.size(); i++) {
+                if (!visit(static_cast<size_t>(children[i].asInt(-1)), transform, depth + 1)) return false;
+            }
+            return true;
+        }
+
+        std::vector<MeshBuilder>& getBuilders() { return m_builders; }
+
+    private:
+        const Document& m_document;
+        std::vector<MeshBuilder> m_builders;
+
+        MeshBuilder& builderFor(const int material) {
+            for (MeshBuilder& builder : m_builders) {
+                if (builder.material == material) return builder;
+            }
+            MeshBuilder& builder = m_builders.emplace_back();
+            builder.material = material;
+            return builder;
+        }
+
+        bool addPrimitive(const JsonValue& primitive, const glm::mat4& transform) {
+            if (primitive["mode"].asInt(MODE_TRIANGLES) != MODE_TRIANGLES) return Document::warn("non-triangle primitive");
+
+            const JsonValue& attributes = primitive["attributes"];
+            if (!attributes.contains("NORMAL") || !attributes.contains("TANGENT")) {
+                return Document::warn("missing normals or tangents"); // Assimp generates them
+            }
+
+            Accessor positions, normals, tangents, texCoords;
+            if (!m_document.accessor(attributes["POSITION"], positions) ||
+                !m_document.accessor(attributes["NORMAL"], normals) ||
+                !m_document.accessor(attributes["TANGENT"], tangents)) {
+                return false;
+            }
+            const bool hasTexCoords = attributes.contains("TEXCOORD_0");
+            if (hasTexCoords && !m_document.accessor(attributes["TEXCOORD_0"], texCoords)) return false;
+
+            const auto isFloat = [&](const Accessor& a, const int components) {
+                return a.componentType == COMPONENT_FLOAT && a.components == components && a.count == positions.count;
+            };
+            if (!isFloat(positions, 3) || !isFloat(normals, 3) || !isFloat(tangents, 4) ||
+                (hasTexCoords && !isFloat(texCoords, 2))) {
+                return Document::warn("unsupported vertex attribute format");
+            }
+
+            MeshBuilder& builder = builderFor(primitive["material"].asInt(-1));
+            const auto baseVertex = static_cast<unsigned int>(builder.vertices.size());
+
+            const glm::mat3 linear(transform);
+            const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+
+            builder.vertices.resize(builder.vertices.size() + positions.count);
+            Vertex* out = builder.vertices.data() + baseVertex;
+            for (size_t i = 0; i < positions.count; i++) {
+                const float* p = positions.floatAt(i);
+                const float* n = normals.floatAt(i);
+                const float* t = tangents.floatAt(i);
+
+                Vertex& vertex = out[i];
+                vertex.Position = glm::vec3(transform * glm::vec4(p[0], p[1], p[2], 1.0f));
+                vertex.Normal = glm::normalize(normalMatrix * glm::vec3(n[0], n[1], n[2]));
+                vertex.Tangent = glm::normalize(linear * glm::vec3(t[0], t[1], t[2]));
+                vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * t[3]; // w is the handedness
+
+                // Assimp flips v into its bottom-left origin, kept so both paths sample the textures alike
+                if (hasTexCoords) {
+                    const float* uv = texCoords.floatAt(i);
+                    vertex.TexCoords = glm::vec2(uv[0], 1.0f - uv[1]);
+                }
+            }
+
+            if (!primitive.contains("indices")) {
+                for (size_t i = 0; i < positions.count; i++) {
+                    builder.indices.push_back(baseVertex + static_cast<unsigned int>(i));
+                }
+                return true;
+            }
+
+            Accessor indices;
+            if (!m_document.accessor(primitive["indices"], indices)) return false;
+            if (indices.components != 1 || indices.componentType == COMPONENT_FLOAT) return Document::warn("invalid indices");
+
+            const size_t first = builder.indices.size();
+            builder.indices.resize(first + indices.count);
+            for (size_t i = 0; i < indices.count; i++) {
+                const uint32_t index = indices.indexAt(i);
+                if (index >= positions.count) return Document::warn("index out of range");
+                builder.indices[first + i] = baseVertex + index;
+            }
+            return true;
+        }
+    };
+
+    std::shared_ptr<Texture> loadTexture(const Document& document, const JsonValue& textureInfo, const bool isSRGB,
+                                         const Texture::Usage usage) {
+        if (!textureInfo.isObject()) return nullptr;
+
+        const JsonValue& texture = document.json()["textures"][static_cast<size_t>(textureInfo["index"].asInt(-1))];
+        const std::string& uri = document.json()["images"][static_cast<size_t>(texture["source"].asInt(-1))]["uri"].asString();
+        if (uri.empty() || uri.starts_with("data:")) return nullptr;
+
+        return AssetManager::get().loadTexture(document.directory() + "/" + uri, isSRGB, false, usage);
+    }
+
+    // The same maps the Assimp path picks up: base colour as diffuse, metallic-roughness as ARM
+    Material loadMaterial(const Document& document, const int index) {
+        Material material;
+        const JsonValue& source = document.json()["materials"][static_cast<size_t>(index)];
+        if (!source.isObject()) return material;
+
+        material.diffuseMap = loadTexture(document, source["pbrMetallicRoughness"]["baseColorTexture"], true, Texture::Usage::Color);
+        material.normalMap = loadTexture(document, source["normalTexture"], false, Texture::Usage::Normal);
+        material.armMap = loadTexture(document, source["pbrMetallicRoughness"]["metallicRoughnessTexture"], false, Texture::Usage::Color);
+        return material;
+    }
+}
+
+bool GltfLoader::load(const std::string& path, std::vector<Mesh>& meshes) {
+    PROFILE_SCOPE("GltfLoader::load");
+    Document document;
+    if (!document.open(path)) return false;
+
+    const JsonValue& json = document.json();
+    const JsonValue& scene = json["scenes"][static_cast<size_t>(json["scene"].asInt(0))];
+    if (!scene.isObject()) return Document::warn("no scene");
+
+    Loader loader(document);
+    const JsonValue& roots = scene["nodes"];
+    for (size_t i = 0; i < roots.size(); i++) {
+        if (!loader.visit(static_cast<size_t>(roots[i].asInt(-1)), glm::mat4(1.0f), 0)) return false;
+    }
+
+    const bool reporting = MeshOptimizer::isReporting();
+    for (MeshBuilder& builder : loader.getBuilders()) {
+        MeshOptimizer::Report report;
+        MeshOptimizer::optimize(builder.vertices, builder.indices, true, reporting ? &report : nullptr);
+        if (reporting) report.print(path + " mesh " + std::to_string(meshes.size()));
+        meshes.emplace_back(std::move(builder.vertices), std::move(builder.indices), loadMaterial(document, builder.material));
+    }
+    return true;
+}
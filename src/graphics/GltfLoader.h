@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Mesh.h"
+
+// Native glTF 2.0 (.gltf + .bin) path for Model, bypassing Assimp. The JSON is parsed with JsonValue, the binary
+// buffers are memory mapped and every accessor range is read straight from the mapping into the meshes' vertex and
+// index arrays, with the node transforms baked in. Primitives sharing a material become one mesh, like Assimp's
+// OptimizeMeshes/OptimizeGraph did, so both paths produce the same meshes.
+// Both then reorder them with MeshOptimizer.
+//
+// Anything the fast path doesn't handle (.glb, data URIs, sparse or non-float attributes, missing normals or
+// tangents, non-triangle primitives, required extensions) returns false and Model falls back to Assimp.
+namespace GltfLoader {
+    bool load(const std::string& path, std::vector<Mesh>& meshes);
+}
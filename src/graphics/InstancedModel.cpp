@@ -3,10 +3,17 @@
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "buffers/IndirectCommand.h"
+
 InstancedModel::InstancedModel(std::shared_ptr<Model> model)
     : m_model(std::move(model)) {
 }
 
+InstancedModel::~InstancedModel() {
+    if (m_visibleBufferID != 0) glDeleteBuffers(1, &m_visibleBufferID);
+    if (m_commandBufferID != 0) glDeleteBuffers(1, &m_commandBufferID);
+}
+
 // we only rotate around Y axis because trees/plants.
 // to look varied but not topple over.
 void InstancedModel::addInstance(const glm::vec3& position, const glm::vec3& scale, const float rotationY) {
@@ -18,11 +25,45 @@ void InstancedModel::addInstance(const glm::vec3& position, const glm::vec3& sca
     m_buffer.addData(model);
 }
 
+void InstancedModel::addInstance(const glm::mat4& transform) {
+    m_buffer.addData(transform);
+}
+
+void InstancedModel::updateInstance(const GLsizei index, const glm::mat4& transform) {
+    m_buffer.updateData(index, transform);
+}
+
+void InstancedModel::removeInstance(const GLsizei index) {
+    m_buffer.removeData(index);
+}
+
 void InstancedModel::finalize() {
     m_buffer.generate();
 
     m_buffer.setData();
 
+    if (getInstanceCount() == 0) return;
+
+    // Culling targets: compacted visible matrices and one indirect command per mesh.
+    // instanceCount is filled in by the culling compute shader every frame.
+    if (m_visibleCapacity < m_buffer.getCapacity()) {
+        if (m_visibleBufferID != 0) glDeleteBuffers(1, &m_visibleBufferID);
+        m_visibleCapacity = m_buffer.getCapacity();
+        glCreateBuffers(1, &m_visibleBufferID);
+        glNamedBufferStorage(m_visibleBufferID, m_visibleCapacity * sizeof(glm::mat4), nullptr, 0);
+    }
+
+    if (m_vaoConfigured) return; // the instance buffer itself is bound per draw, see bindInstances
+    m_vaoConfigured = true;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    commands.reserve(m_model->getMeshes().size());
+    for (const auto& mesh : m_model->getMeshes()) {
+        commands.push_back({static_cast<GLuint>(mesh.getIndexCount()), 0, 0, 0, 0});
+    }
+    glCreateBuffers(1, &m_commandBufferID);
+    glNamedBufferStorage(m_commandBufferID, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), 0);
+
     for (const auto& meshes = m_model->getMeshes(); const auto& mesh : meshes) {
         const auto& vao = mesh.getVAO();
         const GLuint vaoID = vao.getID();
@@ -47,4 +88,9 @@ void InstancedModel::finalize() {
             vao.setAttribFormat(loc, 4, GL_FLOAT, GL_FALSE, offset, 1);
         }
     }
-}
\ No newline at end of file
+}
+
+void InstancedModel::bindInstances(const VAO& vao, const bool culled) const {
+    const GLuint bufferID = culled ? m_visibleBufferID : m_buffer.getID();
+    glVertexArrayVertexBuffer(vao.getID(), 1, bufferID, 0, sizeof(glm::mat4));
+}
@@ -8,14 +8,35 @@
 class InstancedModel {
 public:
     explicit InstancedModel(std::shared_ptr<Model> model);
+    ~InstancedModel();
+
+    InstancedModel(const InstancedModel&) = delete;
+    InstancedModel& operator=(const InstancedModel&) = delete;
 
     void addInstance(const glm::vec3& position, const glm::vec3& scale, float rotationY);
-    void finalize(); // Generates buffers, uploads data, configures VAO
+    void addInstance(const glm::mat4& transform);
+    void updateInstance(GLsizei index, const glm::mat4& transform);
+    void removeInstance(GLsizei index); // the last instance takes over the index
+    void finalize(); // Generates buffers, uploads data, configures VAO. Call again after changing instances.
+
+    // Points binding 1 of the mesh VAO at either all instances or the GPU-culled visible ones.
+    // Done per draw since several batches may share the same Model (and therefore the same VAOs).
+    void bindInstances(const VAO& vao, bool culled) const;
 
     [[nodiscard]] const std::shared_ptr<Model>& getModel() const { return m_model; }
     [[nodiscard]] GLsizei getInstanceCount() const { return m_buffer.getCount(); }
 
+    // GPU culling outputs, written by OcclusionCuller
+    [[nodiscard]] GLuint getInstanceBufferID() const { return m_buffer.getID(); }
+    [[nodiscard]] GLuint getVisibleBufferID() const { return m_visibleBufferID; }
+    [[nodiscard]] GLuint getCommandBufferID() const { return m_commandBufferID; } // one command per mesh
+
 private:
     std::shared_ptr<Model> m_model;
     InstanceBuffer m_buffer;
-};
\ No newline at end of file
+
+    GLuint m_visibleBufferID = 0;
+    GLsizei m_visibleCapacity = 0;
+    GLuint m_commandBufferID = 0;
+    bool m_vaoConfigured = false;
+};
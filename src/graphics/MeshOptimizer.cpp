@@ -0,0 +1,291 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+namespace {
+    constexpr size_t FETCH_LINE_SIZE = 64; // bytes
+    constexpr unsigned int FETCH_CACHE_LINES = 256; // 16 KB
+
+    // FIFO cache by timestamps: an entry is resident while fewer than `size` misses happened after it was loaded.
+    // Flushing advances the clock past every entry.
+    class FifoCache {
+    public:
+        FifoCache(const size_t entries, const unsigned int size) : m_timestamps(entries, 0), m_size(size), m_time(size + 1) {}
+
+        bool access(const unsigned int entry) { // true on a miss
+            if (m_time - m_timestamps[entry] <= m_size) return false;
+            m_timestamps[entry] = m_time++;
+            return true;
+        }
+
+        void flush() { m_time += m_size + 1; }
+
+    private:
+        std::vector<unsigned int> m_timestamps;
+        unsigned int m_size;
+        unsigned int m_time;
+    };
+
+    glm::vec3 positionOf(const float* positions, const size_t stride, const unsigned int vertex) {
+        const float* p = positions + static_cast<size_t>(vertex) * stride;
+        return {p[0], p[1], p[2]};
+    }
+}
+
+void MeshOptimizer::Report::print(const std::string& name) const {
+    std::ostringstream line; // leaves std::cout's formatting alone
+    line << std::fixed << std::setprecision(2)
+         << "  Optimized " << name << ": " << verticesBefore << " -> " << verticesAfter << " vertices, ACMR "
+         << cacheBefore.getAcmr() << " -> " << cacheAfter.getAcmr() << ", ATVR "
+         << cacheBefore.getAtvr() << " -> " << cacheAfter.getAtvr() << ", overfetch "
+         << fetchBefore.getOverfetch() << " -> " << fetchAfter.getOverfetch();
+    std::cout << line.str() << std::endl;
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::span<const unsigned int> indices,
+                                                                  const size_t vertexCount) {
+    VertexCacheStats stats;
+    stats.triangles = indices.size() / 3;
+
+    FifoCache cache(vertexCount, CACHE_SIZE);
+    std::vector<bool> used(vertexCount, false);
+    for (const unsigned int index : indices) {
+        stats.transforms += cache.access(index);
+        if (!used[index]) {
+            used[index] = true;
+            stats.vertices++;
+        }
+    }
+    return stats;
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::analyzeVertexFetch(const std::span<const unsigned int> indices,
+                                                                  const size_t vertexCount, const size_t vertexSize) {
+    VertexFetchStats stats;
+
+    // Only post-transform cache misses fetch
+    FifoCache vertexCache(vertexCount, CACHE_SIZE);
+    FifoCache cache((vertexCount * vertexSize + FETCH_LINE_SIZE - 1) / FETCH_LINE_SIZE, FETCH_CACHE_LINES);
+    std::vector<bool> used(vertexCount, false);
+    for (const unsigned int index : indices) {
+        if (!used[index]) {
+            used[index] = true;
+            stats.bytesUsed += vertexSize;
+        }
+        if (!vertexCache.access(index)) continue;
+
+        const size_t first = index * vertexSize / FETCH_LINE_SIZE;
+        const size_t last = ((index + 1) * vertexSize - 1) / FETCH_LINE_SIZE;
+        for (size_t line = first; line <= last; line++) {
+            if (cache.access(static_cast<unsigned int>(line))) stats.bytesFetched += FETCH_LINE_SIZE;
+        }
+    }
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(const std::span<unsigned int> indices, const size_t vertexCount,
+                                        std::vector<unsigned int>* clusters) {
+    const size_t triangleCount = indices.size() / 3;
+    if (clusters) clusters->clear();
+    if (triangleCount == 0) return;
+
+    // Triangles around every vertex, and how many of them are still to be emitted
+    std::vector<unsigned int> live(vertexCount, 0);
+    for (const unsigned int index : indices) live[index]++;
+
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    std::inclusive_scan(live.begin(), live.end(), offsets.begin() + 1);
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) {
+        adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd; // recently used vertices, to restart from when the fan runs out
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    deadEnd.reserve(indices.size());
+    result.reserve(indices.size());
+
+    unsigned int time = CACHE_SIZE + 1;
+    size_t cursor = 0; // scan position for when the dead-end stack is exhausted too
+    unsigned int fanning = indices[0];
+    bool restarted = true;
+
+    while (fanning != NO_VERTEX) {
+        if (restarted && clusters) clusters->push_back(static_cast<unsigned int>(result.size() / 3));
+
+        // Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (unsigned int k = offsets[fanning]; k < offsets[fanning + 1]; k++) {
+            const unsigned int triangle = adjacency[k];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+
+            for (int corner = 0; corner < 3; corner++) {
+                const unsigned int vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                if (time - timestamps[vertex] > CACHE_SIZE) timestamps[vertex] = time++;
+            }
+        }
+
+        // Next, the candidate that's been in the cache longest but will still be there after its own fan
+        unsigned int next = NO_VERTEX;
+        int bestPriority = -1;
+        for (const unsigned int vertex : candidates) {
+            if (live[vertex] == 0) continue;
+            int priority = 0;
+            if (time - timestamps[vertex] + 2 * live[vertex] <= CACHE_SIZE) {
+                priority = static_cast<int>(time - timestamps[vertex]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+
+        restarted = next == NO_VERTEX;
+        while (next == NO_VERTEX && !deadEnd.empty()) {
+            const unsigned int vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[vertex] > 0) next = vertex;
+        }
+        while (next == NO_VERTEX && cursor < vertexCount) {
+            if (live[cursor] > 0) next = static_cast<unsigned int>(cursor);
+            else cursor++;
+        }
+        fanning = next;
+    }
+
+    std::ranges::copy(result, indices.begin());
+}
+
+void MeshOptimizer::optimizeOverdraw(const std::span<unsigned int> indices, const std::vector<unsigned int>& clusters,
+                                     const float* positions, const size_t stride, const size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || clusters.empty()) return;
+
+    FifoCache cache(vertexCount, CACHE_SIZE);
+    const auto misses = [&](const size_t triangle) {
+        return cache.access(indices[triangle * 3]) + cache.access(indices[triangle * 3 + 1]) +
+               cache.access(indices[triangle * 3 + 2]);
+    };
+
+    // Split every hard cluster wherever the part so far already reaches the whole cluster's ACMR (within the
+    // threshold), treating each part as starting with a cold cache
+    std::vector<size_t> softClusters;
+    for (size_t c = 0; c < clusters.size(); c++) {
+        const size_t begin = clusters[c];
+        const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        cache.flush();
+        size_t clusterMisses = 0;
+        for (size_t t = begin; t < end; t++) clusterMisses += misses(t);
+        const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        cache.flush();
+        softClusters.push_back(begin);
+        size_t partBegin = begin;
+        size_t partMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            partMisses += misses(t);
+            const float partAcmr = static_cast<float>(partMisses) / static_cast<float>(t - partBegin + 1);
+            if (t + 1 < end && partAcmr <= clusterAcmr * OVERDRAW_THRESHOLD) {
+                softClusters.push_back(t + 1);
+                partBegin = t + 1;
+                partMisses = 0;
+                cache.flush();
+            }
+        }
+    }
+
+    // Area-weighted centroid and normal of every cluster
+    const size_t clusterCount = softClusters.size();
+    std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        const size_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+        float clusterArea = 0.0f;
+        for (size_t t = softClusters[c]; t < end; t++) {
+            const glm::vec3 a = positionOf(positions, stride, indices[t * 3]);
+            const glm::vec3 b = positionOf(positions, stride, indices[t * 3 + 1]);
+            const glm::vec3 v = positionOf(positions, stride, indices[t * 3 + 2]);
+            const glm::vec3 normal = glm::cross(b - a, v - a); // length is twice the area
+            const float area = glm::length(normal);
+
+            centroids[c] += (a + b + v) * (area / 3.0f);
+            normals[c] += normal;
+            clusterArea += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += clusterArea;
+        centroids[c] = clusterArea > 0.0f ? centroids[c] / clusterArea : centroids[c];
+    }
+    if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+    // Clusters facing away from the centre are drawn first
+    std::vector<float> outwardness(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float length = glm::length(normals[c]);
+        outwardness[c] = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&](const size_t a, const size_t b) { return outwardness[a] > outwardness[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const size_t c : order) {
+        const size_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+        result.insert(result.end(), indices.begin() + softClusters[c] * 3, indices.begin() + end * 3);
+    }
+    std::ranges::copy(result, indices.begin());
+}
+
+size_t MeshOptimizer::generateDeduplicationRemap(const std::span<const unsigned int> indices, const void* vertices,
+                                                 const size_t vertexCount, const size_t vertexSize,
+                                                 std::vector<unsigned int>& remap) {
+    remap.assign(vertexCount, NO_VERTEX);
+
+    const auto* bytes = static_cast<const char*>(vertices);
+    std::unordered_map<std::string_view, unsigned int> unique;
+    unique.reserve(vertexCount);
+
+    unsigned int next = 0;
+    for (const unsigned int index : indices) {
+        if (remap[index] != NO_VERTEX) continue;
+        const auto [it, inserted] = unique.try_emplace(std::string_view(bytes + index * vertexSize, vertexSize), next);
+        if (inserted) next++;
+        remap[index] = it->second;
+    }
+    return next;
+}
+
+size_t MeshOptimizer::generateFetchRemap(const std::span<const unsigned int> indices, const size_t vertexCount,
+                                         std::vector<unsigned int>& remap) {
+    remap.assign(vertexCount, NO_VERTEX);
+
+    unsigned int next = 0;
+    for (const unsigned int index : indices) {
+        if (remap[index] == NO_VERTEX) remap[index] = next++;
+    }
+    return next;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+// Import-time reordering of indexed triangle meshes, so the GPU transforms and fetches every vertex as few times as
+// possible. Models go through optimize(), the terrain only runs the vertex cache stage on each of its chunks.
+//
+// The stages, in the order they must run:
+//  1. Deduplication: bitwise identical vertices are merged (importers often split them per face).
+//  2. Vertex cache: Tipsify (Sander et al. 2007) reorders triangles around recently used vertices so the
+//     post-transform cache hits. It also reports the hard cluster boundaries where it had to jump.
+//  3. Overdraw: the clusters are split further wherever that costs little cache efficiency, then sorted so
+//     outward-facing ones come first. They occlude the rest of the mesh early, which matters for dense foliage.
+//  4. Vertex fetch: vertices are renumbered in the order the index buffer first uses them.
+//
+// The analyzers simulate a FIFO cache of CACHE_SIZE vertices and report ACMR (vertex shader invocations per
+// triangle, 0.5 at best on large regular meshes, 3 at worst) and ATVR (invocations per unique vertex, 1 at best).
+// They run over every index, so imports only analyze and print while reporting is on (--mesh-stats, and the
+// models micro-benchmark's untimed loads).
+namespace MeshOptimizer {
+    constexpr unsigned int CACHE_SIZE = 16;       // vertices, conservative for current GPUs
+    constexpr float OVERDRAW_THRESHOLD = 1.05f;   // ACMR a cluster may lose to finer overdraw sorting
+    constexpr unsigned int NO_VERTEX = ~0u;       // in remaps: the vertex is unused
+
+    struct VertexCacheStats {
+        size_t triangles = 0;
+        size_t transforms = 0; // cache misses
+        size_t vertices = 0;   // unique vertices referenced
+
+        [[nodiscard]] float getAcmr() const { return triangles ? static_cast<float>(transforms) / triangles : 0.0f; }
+        [[nodiscard]] float getAtvr() const { return vertices ? static_cast<float>(transforms) / vertices : 0.0f; }
+    };
+
+    struct VertexFetchStats {
+        size_t bytesFetched = 0; // whole cache lines
+        size_t bytesUsed = 0;    // the referenced vertices
+
+        [[nodiscard]] float getOverfetch() const { return bytesUsed ? static_cast<float>(bytesFetched) / bytesUsed : 0.0f; }
+    };
+
+    inline std::atomic<bool> g_reporting{false};
+    inline bool isReporting() { return g_reporting.load(std::memory_order_relaxed); }
+    inline void setReporting(const bool enabled) { g_reporting.store(enabled, std::memory_order_relaxed); }
+
+    struct Report {
+        size_t verticesBefore = 0;
+        size_t verticesAfter = 0;
+        VertexCacheStats cacheBefore;
+        VertexCacheStats cacheAfter;
+        VertexFetchStats fetchBefore;
+        VertexFetchStats fetchAfter;
+
+        void print(const std::string& name) const;
+    };
+
+    [[nodiscard]] VertexCacheStats analyzeVertexCache(std::span<const unsigned int> indices, size_t vertexCount);
+
+    // Post-transform misses fetch through a 16 KB cache of 64 byte lines, like the GPU's vertex fetch. Overfetch is
+    // the bytes fetched per byte of referenced vertices, 1 when every vertex is read from memory exactly once.
+    [[nodiscard]] VertexFetchStats analyzeVertexFetch(std::span<const unsigned int> indices, size_t vertexCount, size_t vertexSize);
+
+    // Tipsify. clusters, if given, receives the first triangle of every hard cluster for optimizeOverdraw.
+    void optimizeVertexCache(std::span<unsigned int> indices, size_t vertexCount, std::vector<unsigned int>* clusters = nullptr);
+
+    // Sorts the clusters of an optimizeVertexCache order. positions: x, y, z floats, stride in floats.
+    void optimizeOverdraw(std::span<unsigned int> indices, const std::vector<unsigned int>& clusters,
+                          const float* positions, size_t stride, size_t vertexCount);
+
+    // remap[old] = new or NO_VERTEX, new vertices numbered in order of first use. Return the new vertex count.
+    size_t generateDeduplicationRemap(std::span<const unsigned int> indices, const void* vertices, size_t vertexCount,
+                                      size_t vertexSize, std::vector<unsigned int>& remap);
+    size_t generateFetchRemap(std::span<const unsigned int> indices, size_t vertexCount, std::vector<unsigned int>& remap);
+
+    template<typename V>
+    void remapVertices(std::vector<V>& vertices, std::span<unsigned int> indices, const std::vector<unsigned int>& remap,
+                       const size_t newCount) {
+        std::vector<V> result(newCount);
+        for (size_t i = 0; i < vertices.size(); i++) {
+            if (remap[i] != NO_VERTEX) result[remap[i]] = vertices[i];
+        }
+        vertices = std::move(result);
+
+        for (unsigned int& index : indices) {
+            index = remap[index];
+        }
+    }
+
+    // Every stage on one mesh. V needs a glm::vec3 Position and no padding (bytes are compared).
+    // The analysis before and after only runs when a report is asked for.
+    template<typename V>
+    void optimize(std::vector<V>& vertices, std::vector<unsigned int>& indices, const bool overdraw,
+                  Report* report = nullptr) {
+        if (report) {
+            report->verticesBefore = vertices.size();
+            report->cacheBefore = analyzeVertexCache(indices, vertices.size());
+            report->fetchBefore = analyzeVertexFetch(indices, vertices.size(), sizeof(V));
+        }
+
+        std::vector<unsigned int> remap;
+        size_t count = generateDeduplicationRemap(indices, vertices.data(), vertices.size(), sizeof(V), remap);
+        remapVertices(vertices, indices, remap, count);
+
+        std::vector<unsigned int> clusters;
+        optimizeVertexCache(indices, vertices.size(), overdraw ? &clusters : nullptr);
+        if (overdraw && !vertices.empty()) {
+            optimizeOverdraw(indices, clusters, &vertices[0].Position.x, sizeof(V) / sizeof(float), vertices.size());
+        }
+
+        count = generateFetchRemap(indices, vertices.size(), remap);
+        remapVertices(vertices, indices, remap, count);
+
+        if (report) {
+            report->verticesAfter = vertices.size();
+            report->cacheAfter = analyzeVertexCache(indices, vertices.size());
+            report->fetchAfter = analyzeVertexFetch(indices, vertices.size(), sizeof(V));
+        }
+    }
+}
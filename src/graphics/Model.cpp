@@ -1,7 +1,11 @@
 #include "Model.h"
+#include "GltfLoader.h"
+#include "MeshOptimizer.h"
 #include <assimp/postprocess.h>
 #include <iostream>
+#include <limits>
 #include <src/core/AssetManager.h>
+#include "utils/Profiler.h"
 
 void Model::render(const Shader &shader) const {
     for (const auto &mesh : m_meshes) {
@@ -9,7 +13,21 @@ void Model::render(const Shader &shader) const {
     }
 }
 
-void Model::loadModel(const std::string &path) {
+void Model::loadModel(const std::string &path, const Importer importer) {
+    if (importer == Importer::Auto && path.ends_with(".gltf")) {
+        if (GltfLoader::load(path, m_meshes)) {
+            m_directory = path.substr(0, path.find_last_of('/'));
+            computeBounds();
+            return;
+        }
+        m_meshes.clear(); // whatever the native path got to before it gave up
+    }
+
+    loadModelAssimp(path);
+}
+
+void Model::loadModelAssimp(const std::string &path) {
+    PROFILE_SCOPE("Model::loadModel (Assimp)");
     Assimp::Importer importer;
     // https://the-asset-importer-lib-documentation.readthedocs.io/en/latest/usage/postprocessing.html
     const aiScene *scene = importer.ReadFile(
@@ -24,6 +42,21 @@ void Model::loadModel(const std::string &path) {
     m_directory = path.substr(0, path.find_last_of('/'));
 
     processNode(scene->mRootNode, scene);
+    computeBounds();
+}
+
+void Model::computeBounds() {
+    if (m_meshes.empty()) return;
+
+    m_boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    m_boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+    for (const auto &mesh : m_meshes) {
+        for (const auto &vertex : mesh.getVertices()) {
+            m_boundsMin = glm::min(m_boundsMin, vertex.Position);
+            m_boundsMax = glm::max(m_boundsMax, vertex.Position);
+        }
+    }
 }
 
 void Model::processNode(const aiNode *node, const aiScene *scene) {
@@ -40,6 +73,8 @@ void Model::processNode(const aiNode *node, const aiScene *scene) {
 Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) const {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 
     // Process vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -78,9 +113,9 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) const {
 
         material.diffuseMap  = loadMaterialTexture(aiMat, aiTextureType_DIFFUSE, true);
         material.specularMap = loadMaterialTexture(aiMat, aiTextureType_SPECULAR, false);
-        material.normalMap = loadMaterialTexture(aiMat, aiTextureType_HEIGHT, false);
+        material.normalMap = loadMaterialTexture(aiMat, aiTextureType_HEIGHT, false, Texture::Usage::Normal);
         if (!material.normalMap) {
-            material.normalMap = loadMaterialTexture(aiMat, aiTextureType_NORMALS, false);
+            material.normalMap = loadMaterialTexture(aiMat, aiTextureType_NORMALS, false, Texture::Usage::Normal);
         }
         material.armMap = loadMaterialTexture(aiMat, aiTextureType_METALNESS, false);
         if (!material.armMap) {
@@ -92,16 +127,16 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) const {
         }
     }
 
-    std::cout << "Mesh: " << mesh->mName.C_Str() << "\n";
-    std::cout << "  Diffuse: " << (material.diffuseMap ? "y" : "n") << "\n";
-    std::cout << "  Normal: " << (material.normalMap ? "y" : "n") << "\n";
-    std::cout << "  ARM: " << (material.armMap ? "y" : "n") << "\n";
-    std::cout << "  Has UVs: " << (mesh->HasTextureCoords(0) ? "✓" : "n") << "\n";
+    MeshOptimizer::Report report;
+    const bool reporting = MeshOptimizer::isReporting();
+    MeshOptimizer::optimize(vertices, indices, true, reporting ? &report : nullptr);
+    if (reporting) report.print(mesh->mName.C_Str());
 
-    return {vertices, indices, material};
+    return {std::move(vertices), std::move(indices), material};
 }
 
-std::shared_ptr<Texture> Model::loadMaterialTexture(const aiMaterial *mat, const aiTextureType type, const bool isSRGB) const {
+std::shared_ptr<Texture> Model::loadMaterialTexture(const aiMaterial *mat, const aiTextureType type, const bool isSRGB,
+                                                    const Texture::Usage usage) const {
     if (mat->GetTextureCount(type) == 0) return nullptr;
 
     aiString texturePath;
@@ -109,5 +144,5 @@ std::shared_ptr<Texture> Model::loadMaterialTexture(const aiMaterial *mat, const
 
     const std::string fullPath = m_directory + "/" + texturePath.C_Str();
 
-    return AssetManager::get().loadTexture(fullPath, isSRGB, false);
+    return AssetManager::get().loadTexture(fullPath, isSRGB, false, usage);
 }
@@ -7,8 +7,13 @@
 
 class Model {
 public:
-    explicit Model(const std::string &path, const bool gamma = false) : m_gammaCorrection(gamma) {
-        loadModel(path);
+    // Auto reads .gltf files natively (GltfLoader) and everything else, or a glTF the native path can't handle,
+    // through Assimp
+    enum class Importer { Auto, Assimp };
+
+    explicit Model(const std::string &path, const bool gamma = false, const Importer importer = Importer::Auto)
+        : m_gammaCorrection(gamma) {
+        loadModel(path, importer);
     }
 
     void render(const Shader &shader) const;
@@ -16,6 +21,10 @@ public:
         return m_meshes;
     }
 
+    // Local-space bounding box over all meshes, used for culling
+    [[nodiscard]] const glm::vec3& getBoundsMin() const { return m_boundsMin; }
+    [[nodiscard]] const glm::vec3& getBoundsMax() const { return m_boundsMax; }
+
 private:
     std::vector<Mesh> m_meshes;
 
@@ -26,11 +35,19 @@ private:
     std::string m_directory;
     bool m_gammaCorrection;
 
-    void loadModel(const std::string &path);
+    glm::vec3 m_boundsMin{0.0f};
+    glm::vec3 m_boundsMax{0.0f};
+
+    void loadModel(const std::string &path, Importer importer);
+
+    void loadModelAssimp(const std::string &path);
 
     void processNode(const aiNode *node, const aiScene *scene);
 
     Mesh processMesh(aiMesh *mesh, const aiScene *scene) const;
 
-    std::shared_ptr<Texture> loadMaterialTexture(const aiMaterial *mat, aiTextureType type, bool isSRGB) const;
+    void computeBounds();
+
+    std::shared_ptr<Texture> loadMaterialTexture(const aiMaterial *mat, aiTextureType type, bool isSRGB,
+                                                 Texture::Usage usage = Texture::Usage::Color) const;
 };
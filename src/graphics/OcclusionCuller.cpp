@@ -0,0 +1,210 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "InstancedModel.h"
+#include "Shader.h"
+#include "buffers/IndirectCommand.h"
+#include "core/AssetManager.h"
+#include "world/Terrain.h"
+
+namespace {
+    constexpr GLuint HIZ_TEXTURE_UNIT = 0;
+
+    // Matches the binding points in hiz_cull.glsl / cull_*.comp
+    constexpr GLuint BINDING_INPUT = 0;
+    constexpr GLuint BINDING_VISIBLE = 1;
+    constexpr GLuint BINDING_COMMANDS = 2;
+    constexpr GLuint BINDING_STATS = 3;
+
+    GLuint groupCount(const int items, const int groupSize) {
+        return static_cast<GLuint>((items + groupSize - 1) / groupSize);
+    }
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    releaseHiZ();
+    if (m_statsBuffer != 0) glDeleteBuffers(1, &m_statsBuffer);
+    glDeleteBuffers(READBACK_FRAMES, m_readbackBuffers);
+    for (const GLsync fence : m_readbackFences) {
+        if (fence) glDeleteSync(fence);
+    }
+}
+
+void OcclusionCuller::initialize() {
+    const std::string path = "assets/shaders/";
+    auto& assetManager = AssetManager::get();
+
+    m_hizBuildShader = assetManager.loadComputeShader(path + "hiz_build.comp");
+    m_cullInstancesShader = assetManager.loadComputeShader(path + "cull_instances.comp");
+    m_cullTerrainShader = assetManager.loadComputeShader(path + "cull_terrain.comp");
+
+    glCreateBuffers(1, &m_statsBuffer);
+    glNamedBufferStorage(m_statsBuffer, sizeof(Stats), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(READBACK_FRAMES, m_readbackBuffers);
+    for (const GLuint buffer : m_readbackBuffers) {
+        glNamedBufferStorage(buffer, sizeof(Stats), nullptr, GL_CLIENT_STORAGE_BIT);
+    }
+}
+
+void OcclusionCuller::resize(const int width, const int height) {
+    if (width == m_hizWidth && height == m_hizHeight && m_hizTexture != 0) return;
+    if (width <= 0 || height <= 0) return;
+
+    releaseHiZ();
+    m_hizWidth = width;
+    m_hizHeight = height;
+    m_hizLevels = 1 + static_cast<int>(std::floor(std::log2(std::max(width, height))));
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_hizTexture);
+    glTextureStorage2D(m_hizTexture, m_hizLevels, GL_R32F, width, height);
+    glTextureParameteri(m_hizTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTextureParameteri(m_hizTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(m_hizTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_hizTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void OcclusionCuller::beginCulling(const glm::mat4& viewProj) {
+    m_viewProj = viewProj;
+    m_useHiZ = true;
+
+    constexpr Stats zero{};
+    glNamedBufferSubData(m_statsBuffer, 0, sizeof(Stats), &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_STATS, m_statsBuffer);
+
+    glBindTextureUnit(HIZ_TEXTURE_UNIT, m_hizTexture);
+}
+
+void OcclusionCuller::beginFrustumCulling(const glm::mat4& viewProj) {
+    m_viewProj = viewProj;
+    m_useHiZ = false;
+
+    // The shaders still count, beginCulling clears the counters again before the camera's pass
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_STATS, m_statsBuffer);
+}
+
+void OcclusionCuller::setCullUniforms(const Shader& shader) const {
+    shader.use();
+    shader.setMat4("u_ViewProj", m_viewProj);
+    shader.setMat4("u_PrevViewProj", m_prevViewProj);
+    shader.setTextureUnit("u_HiZ", HIZ_TEXTURE_UNIT);
+    shader.setBool("u_UseHiZ", m_hizValid && m_useHiZ);
+}
+
+void OcclusionCuller::cullInstances(const InstancedModel& batch) const {
+    const GLsizei count = batch.getInstanceCount();
+    if (count == 0) return;
+
+    // Reset the visible counter, it lives in the first mesh's draw command
+    constexpr GLuint zero = 0;
+    glClearNamedBufferSubData(batch.getCommandBufferID(), GL_R32UI,
+                              offsetof(DrawElementsIndirectCommand, instanceCount), sizeof(GLuint),
+                              GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    setCullUniforms(*m_cullInstancesShader);
+    m_cullInstancesShader->setUInt("u_Count", static_cast<GLuint>(count));
+    m_cullInstancesShader->setVec3("u_BoundsMin", batch.getModel()->getBoundsMin());
+    m_cullInstancesShader->setVec3("u_BoundsMax", batch.getModel()->getBoundsMax());
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_INPUT, batch.getInstanceBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_VISIBLE, batch.getVisibleBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_COMMANDS, batch.getCommandBufferID());
+
+    glDispatchCompute(groupCount(count, 64), 1, 1);
+
+    // Every mesh of the model draws the same visible instances, copy the count on the GPU
+    const size_t meshCount = batch.getModel()->getMeshes().size();
+    if (meshCount > 1) {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        for (size_t i = 1; i < meshCount; i++) {
+            glCopyNamedBufferSubData(batch.getCommandBufferID(), batch.getCommandBufferID(),
+                                     offsetof(DrawElementsIndirectCommand, instanceCount),
+                                     i * sizeof(DrawElementsIndirectCommand) + offsetof(DrawElementsIndirectCommand, instanceCount),
+                                     sizeof(GLuint));
+        }
+    }
+}
+
+void OcclusionCuller::cullTerrain(const Terrain& terrain) const {
+    const GLsizei count = terrain.getChunkCount();
+    if (count == 0) return;
+
+    setCullUniforms(*m_cullTerrainShader);
+    m_cullTerrainShader->setUInt("u_Count", static_cast<GLuint>(count));
+    m_cullTerrainShader->setVec3("u_Offset", terrain.m_position);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_INPUT, terrain.getChunkBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING_COMMANDS, terrain.getChunkCommandBufferID());
+
+    glDispatchCompute(groupCount(count, 64), 1, 1);
+}
+
+void OcclusionCuller::endFrustumCulling() {
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void OcclusionCuller::endCulling() {
+    // Indirect commands and compacted instance matrices are consumed by the following draws
+    endFrustumCulling();
+
+    // Queue this frame's counters and pick up the oldest ones if the GPU is done with them
+    const int slot = m_readbackIndex;
+    glCopyNamedBufferSubData(m_statsBuffer, m_readbackBuffers[slot], 0, 0, sizeof(Stats));
+    if (m_readbackFences[slot]) glDeleteSync(m_readbackFences[slot]);
+    m_readbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_readbackIndex = (m_readbackIndex + 1) % READBACK_FRAMES;
+
+    if (const GLsync oldest = m_readbackFences[m_readbackIndex]) {
+        const GLenum status = glClientWaitSync(oldest, 0, 0); // never blocks
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glGetNamedBufferSubData(m_readbackBuffers[m_readbackIndex], 0, sizeof(Stats), &m_stats);
+        }
+    }
+}
+
+void OcclusionCuller::buildHiZ(const GLuint depthTexture, const glm::mat4& viewProj) {
+    if (m_hizTexture == 0) return;
+
+    m_hizBuildShader->use();
+
+    // Level 0: copy the scene depth
+    glBindTextureUnit(HIZ_TEXTURE_UNIT, depthTexture);
+    m_hizBuildShader->setTextureUnit("u_Depth", HIZ_TEXTURE_UNIT);
+    m_hizBuildShader->setInt("u_SrcLevel", -1);
+    m_hizBuildShader->setIVec2("u_DstSize", glm::ivec2(m_hizWidth, m_hizHeight));
+    glBindImageTexture(0, m_hizTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(groupCount(m_hizWidth, 8), groupCount(m_hizHeight, 8), 1);
+
+    // Remaining levels: 2x2 max reduction of the level above
+    for (int level = 1; level < m_hizLevels; level++) {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        const glm::ivec2 srcSize(std::max(1, m_hizWidth >> (level - 1)), std::max(1, m_hizHeight >> (level - 1)));
+        const glm::ivec2 dstSize(std::max(1, m_hizWidth >> level), std::max(1, m_hizHeight >> level));
+
+        m_hizBuildShader->setInt("u_SrcLevel", level - 1);
+        m_hizBuildShader->setIVec2("u_SrcSize", srcSize);
+        m_hizBuildShader->setIVec2("u_DstSize", dstSize);
+        glBindImageTexture(1, m_hizTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(0, m_hizTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute(groupCount(dstSize.x, 8), groupCount(dstSize.y, 8), 1);
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_prevViewProj = viewProj;
+    m_hizValid = true;
+}
+
+void OcclusionCuller::releaseHiZ() {
+    if (m_hizTexture != 0) glDeleteTextures(1, &m_hizTexture);
+    m_hizTexture = 0;
+    m_hizWidth = 0;
+    m_hizHeight = 0;
+    m_hizLevels = 0;
+    m_hizValid = false;
+}
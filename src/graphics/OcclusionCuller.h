@@ -0,0 +1,75 @@
+#pragma once
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Shader;
+class InstancedModel;
+class Terrain;
+
+// GPU frustum + hierarchical-Z occlusion culling.
+// At the end of a frame the scene depth is reduced into a max-depth pyramid. Next frame, instanced batches and
+// terrain chunks are tested against that pyramid (reprojected with the previous view-projection) in compute
+// shaders, which write indirect draw commands. Nothing is read back synchronously, the statistics arrive a few
+// frames late through a small readback ring.
+class OcclusionCuller {
+public:
+    struct Stats {
+        GLuint instancesTested = 0;
+        GLuint instancesVisible = 0;
+        GLuint chunksTested = 0;
+        GLuint chunksVisible = 0;
+    };
+
+    OcclusionCuller() = default;
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    void initialize();
+    void resize(int width, int height); // Hi-Z pyramid follows the scene target size
+
+    void beginCulling(const glm::mat4& viewProj); // resets the counters for this frame
+    // Frustum test only, for views the Hi-Z pyramid doesn't belong to (shadow cascades). The results overwrite the
+    // same indirect buffers, so they have to be drawn before the camera's culling runs.
+    void beginFrustumCulling(const glm::mat4& viewProj);
+    void cullInstances(const InstancedModel& batch) const;
+    void cullTerrain(const Terrain& terrain) const;
+    void endCulling(); // barriers so the draws see the results, queues the stats readback
+    static void endFrustumCulling(); // barriers only, the statistics stay the camera's
+
+    // Reduces the given depth texture, rendered with viewProj, into the pyramid used by next frame's culling
+    void buildHiZ(GLuint depthTexture, const glm::mat4& viewProj);
+
+    [[nodiscard]] const Stats& getStats() const { return m_stats; }
+    [[nodiscard]] GLuint getHiZTexture() const { return m_hizTexture; }
+    [[nodiscard]] int getHiZWidth() const { return m_hizWidth; }
+    [[nodiscard]] int getHiZHeight() const { return m_hizHeight; }
+
+private:
+    static constexpr int READBACK_FRAMES = 3;
+
+    void setCullUniforms(const Shader& shader) const;
+    void releaseHiZ();
+
+    std::shared_ptr<Shader> m_hizBuildShader;
+    std::shared_ptr<Shader> m_cullInstancesShader;
+    std::shared_ptr<Shader> m_cullTerrainShader;
+
+    GLuint m_hizTexture = 0;
+    int m_hizWidth = 0;
+    int m_hizHeight = 0;
+    int m_hizLevels = 0;
+    bool m_hizValid = false; // false until a pyramid matching the current size was built
+    bool m_useHiZ = true;    // off while culling for another view
+
+    glm::mat4 m_viewProj{1.0f};
+    glm::mat4 m_prevViewProj{1.0f};
+
+    GLuint m_statsBuffer = 0;
+    GLuint m_readbackBuffers[READBACK_FRAMES] = {};
+    GLsync m_readbackFences[READBACK_FRAMES] = {};
+    int m_readbackIndex = 0;
+    Stats m_stats;
+};
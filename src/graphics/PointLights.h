@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "camera/Frustum.h"
+
+// Point lights as structure of arrays, so the Renderer can frustum cull them with FrustumCulling before
+// ClusteredLighting uploads the visible ones.
+struct PointLights {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius; // the light has no effect beyond this distance
+    std::vector<glm::vec3> color; // linear RGB, multiplied by the intensity
+
+    void add(const glm::vec3& position, const float lightRadius, const glm::vec3& lightColor) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+        z.push_back(position.z);
+        radius.push_back(lightRadius);
+        color.push_back(lightColor);
+    }
+
+    void setPosition(const size_t index, const glm::vec3& position) {
+        x[index] = position.x;
+        y[index] = position.y;
+        z[index] = position.z;
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+        color.clear();
+    }
+
+    [[nodiscard]] size_t size() const { return x.size(); }
+    [[nodiscard]] SphereArrays spheres() const { return {x.data(), y.data(), z.data(), radius.data(), x.size()}; }
+};
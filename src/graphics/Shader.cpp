@@ -10,34 +10,58 @@ Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath)
     m_shaderID = compileProgram(vertexPath, fragmentPath);
 }
 
-unsigned int Shader::compileProgram(const std::string &vPath, const std::string &fPath) {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+Shader::Shader(const std::string &computePath)
+    : m_computePath(computePath) {
 
-    // ensure ifstream objects can throw exceptions
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    m_shaderID = compileComputeProgram(computePath);
+}
 
-    try {
-        vShaderFile.open(vPath);
-        fShaderFile.open(fPath);
+// Reads a shader file and splices in any #include "file" lines, resolved relative to the including file.
+// GLSL has no include mechanism of its own, this lets shaders share blocks like the Hi-Z test.
+bool Shader::loadSource(const std::string &path, std::string &source, const int depth) {
+    if (depth > 8) {
+        std::cerr << "ERROR::SHADER::INCLUDE_DEPTH_EXCEEDED: " << path << std::endl;
+        return false;
+    }
 
-        std::stringstream vShaderStream;
-        std::stringstream fShaderStream;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return false;
+    }
 
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+    const std::string directory = path.substr(0, path.find_last_of('/') + 1);
+
+    std::stringstream out;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.starts_with("#include")) {
+            const size_t open = line.find('"');
+            const size_t close = line.find('"', open + 1);
+            if (open == std::string::npos || close == std::string::npos) {
+                std::cerr << "ERROR::SHADER::MALFORMED_INCLUDE in " << path << ": " << line << std::endl;
+                return false;
+            }
+
+            std::string included;
+            if (!loadSource(directory + line.substr(open + 1, close - open - 1), included, depth + 1)) {
+                return false;
+            }
+            out << included << '\n';
+            continue;
+        }
+        out << line << '\n';
+    }
 
-        vShaderFile.close();
-        fShaderFile.close();
+    source = out.str();
+    return true;
+}
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    }
-    catch (std::ifstream::failure &e) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << vPath << " or " << fPath << std::endl;
+unsigned int Shader::compileProgram(const std::string &vPath, const std::string &fPath) {
+    std::string vertexCode;
+    std::string fragmentCode;
+
+    if (!loadSource(vPath, vertexCode) || !loadSource(fPath, fragmentCode)) {
         return 0;
     }
 
@@ -92,8 +116,48 @@ unsigned int Shader::compileProgram(const std::string &vPath, const std::string
     return programID;
 }
 
+unsigned int Shader::compileComputeProgram(const std::string &cPath) {
+    std::string computeCode;
+    if (!loadSource(cPath, computeCode)) {
+        return 0;
+    }
+
+    const char *cShaderCode = computeCode.c_str();
+    int success;
+
+    const unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compute, 1, &cShaderCode, nullptr);
+    glCompileShader(compute);
+
+    glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        checkCompileErrors(compute, "COMPUTE");
+        glDeleteShader(compute);
+        return 0;
+    }
+
+    const unsigned int programID = glCreateProgram();
+    glAttachShader(programID, compute);
+    glLinkProgram(programID);
+
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    if (!success) {
+        checkCompileErrors(programID, "PROGRAM");
+        glDeleteProgram(programID);
+        glDeleteShader(compute);
+        return 0;
+    }
+
+    glDetachShader(programID, compute);
+    glDeleteShader(compute);
+
+    return programID;
+}
+
 bool Shader::reload() {
-    const unsigned int newShaderID = compileProgram(m_vertexPath, m_fragmentPath);
+    const unsigned int newShaderID = m_computePath.empty()
+        ? compileProgram(m_vertexPath, m_fragmentPath)
+        : compileComputeProgram(m_computePath);
     if (newShaderID == 0) {
         std::cerr << "Error: Failed to reload shader program!" << std::endl;
         return false;
@@ -122,10 +186,22 @@ void Shader::setInt(const std::string &name, const int value) const {
     glUniform1i(getUniformLocation(name), value);
 }
 
+void Shader::setUInt(const std::string &name, const unsigned int value) const {
+    glUniform1ui(getUniformLocation(name), value);
+}
+
 void Shader::setFloat(const std::string &name, const float value) const {
     glUniform1f(getUniformLocation(name), value);
 }
 
+void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
+    glUniform2f(getUniformLocation(name), value.x, value.y);
+}
+
+void Shader::setIVec2(const std::string &name, const glm::ivec2 &value) const {
+    glUniform2i(getUniformLocation(name), value.x, value.y);
+}
+
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
     glUniform3f(getUniformLocation(name), value.x, value.y, value.z);
 }
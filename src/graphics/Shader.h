@@ -24,12 +24,19 @@ public:
     // constructor reads and builds the shader
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
 
+    // builds a compute-only program
+    explicit Shader(const std::string& computePath);
+
     Shader(); // default constructor
 
     bool reload();
 
     void setVec4(const std::string &name, const glm::vec4 &value) const;
 
+    void setVec2(const std::string &name, const glm::vec2 &value) const;
+
+    void setIVec2(const std::string &name, const glm::ivec2 &value) const;
+
     void setVec3(const std::string &name, const glm::vec3 &value) const;
 
     // use/activate the shader
@@ -40,6 +47,8 @@ public:
 
     void setInt(const std::string &name, int value) const;
 
+    void setUInt(const std::string &name, unsigned int value) const;
+
     void setFloat(const std::string &name, float value) const;
 
     void setMat4(const std::string &name, const glm::mat4 &value) const;
@@ -62,11 +71,14 @@ private:
     GLuint m_shaderID;
     std::string m_vertexPath;
     std::string m_fragmentPath;
+    std::string m_computePath; // non-empty for compute programs
 
     mutable std::unordered_map<std::string, GLint> m_uniformLocations;
 
     [[nodiscard]] int getUniformLocation(const std::string &name) const;
 
+    static bool loadSource(const std::string& path, std::string& source, int depth = 0);
     static unsigned int compileProgram(const std::string& vPath, const std::string& fPath);
+    static unsigned int compileComputeProgram(const std::string& cPath);
     static void checkCompileErrors(unsigned int shader, const std::string &type);
 };
\ No newline at end of file
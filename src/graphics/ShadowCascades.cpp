@@ -0,0 +1,214 @@
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+
+#include "camera/FrameUBO.h"
+#include "utils/Profiler.h"
+
+namespace {
+    // How far towards the sun casters are still rendered into a cascade, beyond its slice
+    constexpr float CASTER_DISTANCE = 500.0f;
+}
+
+ShadowCascades::~ShadowCascades() {
+    glDeleteFramebuffers(CASCADE_COUNT, m_framebuffers);
+    if (m_depthArray != 0) glDeleteTextures(1, &m_depthArray);
+}
+
+void ShadowCascades::initialize() {
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_depthArray);
+    glTextureStorage3D(m_depthArray, 1, GL_DEPTH_COMPONENT32F, RESOLUTION, RESOLUTION, CASCADE_COUNT);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Hardware depth comparison, linear filtering then blends four comparison results for free
+    glTextureParameteri(m_depthArray, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glCreateFramebuffers(CASCADE_COUNT, m_framebuffers);
+    for (int i = 0; i < CASCADE_COUNT; i++) {
+        glNamedFramebufferTextureLayer(m_framebuffers[i], GL_DEPTH_ATTACHMENT, m_depthArray, 0, i);
+        glNamedFramebufferDrawBuffer(m_framebuffers[i], GL_NONE);
+        glNamedFramebufferReadBuffer(m_framebuffers[i], GL_NONE);
+
+        if (glCheckNamedFramebufferStatus(m_framebuffers[i], GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR::SHADOW_CASCADES:: Framebuffer of cascade " << i << " is incomplete" << std::endl;
+        }
+    }
+
+    m_stream.generate(sizeof(ShadowData));
+}
+
+void ShadowCascades::update(const FrameData& frame, const glm::vec3& sunDirection) {
+    PROFILE_SCOPE("ShadowCascades::update");
+
+    // Near and far back out of the OpenGL perspective matrix
+    const float near = frame.projection[3][2] / (frame.projection[2][2] - 1.0f);
+    const float far = frame.projection[3][2] / (frame.projection[2][2] + 1.0f);
+    const float shadowFar = std::min(m_shadowDistance, far);
+
+    // Points at a given view depth lie on the edges between the near and far plane corners
+    glm::vec3 nearCorners[4];
+    glm::vec3 farCorners[4];
+    for (int i = 0; i < 4; i++) {
+        const glm::vec2 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f);
+        const glm::vec4 nearCorner = frame.invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+        const glm::vec4 farCorner = frame.invViewProj * glm::vec4(ndc, 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+        farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+    }
+
+    const float cosSunThreshold = std::cos(glm::radians(m_sunThresholdDegrees));
+    bool sunUpdateDone = false;
+    float splitNear = near;
+
+    for (int i = 0; i < CASCADE_COUNT; i++) {
+        // Practical split scheme: blend of uniform and logarithmic splits
+        const float t = static_cast<float>(i + 1) / CASCADE_COUNT;
+        const float splitFar = glm::mix(near + (shadowFar - near) * t, near * std::pow(shadowFar / near, t), m_splitLambda);
+
+        glm::vec3 corners[8];
+        for (int c = 0; c < 4; c++) {
+            corners[c] = glm::mix(nearCorners[c], farCorners[c], (splitNear - near) / (far - near));
+            corners[c + 4] = glm::mix(nearCorners[c], farCorners[c], (splitFar - near) / (far - near));
+        }
+
+        // A sphere doesn't change size when the camera turns, so neither does the texel size
+        glm::vec3 center(0.0f);
+        for (const glm::vec3& corner : corners) center += corner;
+        center /= 8.0f;
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners) radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f; // rounding noise would resize the texels every frame
+
+        Cascade& cascade = m_cascades[i];
+        cascade.splitFar = splitFar;
+        splitNear = splitFar;
+
+        if (i == 0) {
+            fit(cascade, sunDirection, center, radius);
+            continue;
+        }
+        if (!cascade.valid) {
+            fit(cascade, sunDirection, center, radius * (1.0f + m_cacheMargin));
+            continue;
+        }
+
+        // Cached: keep it while the slice still lies inside the rendered square and depth range
+        const glm::vec3 offset = glm::abs(glm::vec3(cascade.view * glm::vec4(center, 1.0f)) - cascade.center);
+        const bool covered = std::max({offset.x, offset.y, offset.z}) + radius <= cascade.radius;
+        const bool sunMoved = glm::dot(cascade.sunDirection, sunDirection) < cosSunThreshold;
+
+        if (!covered) {
+            fit(cascade, sunDirection, center, radius * (1.0f + m_cacheMargin));
+        } else if (sunMoved && !sunUpdateDone) {
+            fit(cascade, sunDirection, center, radius * (1.0f + m_cacheMargin));
+            sunUpdateDone = true; // the others follow in the next frames
+        }
+    }
+
+    ShadowData data{};
+    for (int i = 0; i < CASCADE_COUNT; i++) {
+        const Cascade& cascade = m_cascades[i];
+        const float texelSize = 2.0f * cascade.radius / RESOLUTION;
+        const float depthRange = 2.0f * cascade.radius + CASTER_DISTANCE;
+
+        data.viewProj[i] = cascade.projection * cascade.view;
+        data.splits[i] = cascade.splitFar;
+        data.texelSize[i] = texelSize;
+        data.depthBias[i] = m_depthBiasTexels * texelSize / depthRange;
+    }
+    data.params = glm::vec4(m_enabled ? 1.0f : 0.0f, m_normalOffset, 0.0f, 0.0f);
+
+    m_stream.beginFrame();
+    const GLintptr offset = m_stream.write(&data, sizeof(ShadowData));
+    glBindBufferRange(GL_UNIFORM_BUFFER, DATA_BINDING, m_stream.getID(), offset, sizeof(ShadowData));
+    glBindTextureUnit(TEXTURE_UNIT, m_depthArray);
+}
+
+void ShadowCascades::fit(Cascade& cascade, const glm::vec3& sunDirection, const glm::vec3& center, const float radius) const {
+    // Looking along the sunlight. The view is only a rotation, so the texel grid stays fixed in the world and
+    // snapping the projection to it keeps the rasterization of static geometry identical between frames.
+    const glm::vec3 up = std::abs(sunDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    cascade.view = glm::lookAt(glm::vec3(0.0f), -sunDirection, up);
+    cascade.sunDirection = sunDirection;
+
+    // One texel of slack on every side for the snapping
+    const float texelSize = 2.0f * radius / (RESOLUTION - 2);
+    const float halfSize = radius + texelSize;
+
+    glm::vec3 lightCenter(cascade.view * glm::vec4(center, 1.0f));
+    lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+    lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+    cascade.center = lightCenter;
+    cascade.radius = halfSize;
+
+    // +z points at the sun: the depth range reaches past the slice towards it to include the casters
+    cascade.projection = glm::ortho(lightCenter.x - halfSize, lightCenter.x + halfSize,
+                                    lightCenter.y - halfSize, lightCenter.y + halfSize,
+                                    -(lightCenter.z + halfSize + CASTER_DISTANCE), -(lightCenter.z - halfSize));
+    cascade.frustum = Frustum::fromViewProj(cascade.projection * cascade.view);
+    cascade.dirty = true;
+}
+
+void ShadowCascades::beginCascade(const int cascade) const {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[cascade]);
+    glViewport(0, 0, RESOLUTION, RESOLUTION);
+
+    constexpr float clearDepth = 1.0f;
+    glClearNamedFramebufferfv(m_framebuffers[cascade], GL_DEPTH, 0, &clearDepth);
+
+    // Casters between the sun and the near plane are flattened onto it instead of clipped
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.5f, 2.0f); // slope scaled, the shaders add a constant bias and a normal offset
+}
+
+void ShadowCascades::endCascades() {
+    glDisable(GL_DEPTH_CLAMP);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    m_renderedThisFrame = 0;
+    for (Cascade& cascade : m_cascades) {
+        if (!m_enabled || !cascade.dirty) continue;
+        cascade.dirty = false;
+        cascade.valid = true;
+        cascade.renders++;
+        m_renderedThisFrame++;
+    }
+}
+
+void ShadowCascades::endFrame() {
+    m_stream.endFrame();
+}
+
+void ShadowCascades::invalidate() {
+    for (Cascade& cascade : m_cascades) {
+        cascade.valid = false;
+    }
+}
+
+void ShadowCascades::imGui() {
+    if (!ImGui::CollapsingHeader("Sun Shadows")) return;
+
+    bool changed = ImGui::Checkbox("Enabled", &m_enabled);
+    changed |= ImGui::SliderFloat("Distance", &m_shadowDistance, 100.0f, 2000.0f);
+    changed |= ImGui::SliderFloat("Split Lambda", &m_splitLambda, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("Cache Margin", &m_cacheMargin, 0.0f, 0.5f);
+    ImGui::SliderFloat("Sun Threshold (deg)", &m_sunThresholdDegrees, 0.0f, 5.0f);
+    ImGui::SliderFloat("Normal Offset (texels)", &m_normalOffset, 0.0f, 4.0f);
+    ImGui::SliderFloat("Depth Bias (texels)", &m_depthBiasTexels, 0.0f, 4.0f);
+    if (changed) invalidate();
+
+    ImGui::Text("Cascades rendered last frame: %d of %d", m_renderedThisFrame, CASCADE_COUNT);
+    for (int i = 0; i < CASCADE_COUNT; i++) {
+        const Cascade& cascade = m_cascades[i];
+        ImGui::Text("  %d: to %.0f, %.2f per texel, %d renders", i, cascade.splitFar,
+                    2.0f * cascade.radius / RESOLUTION, cascade.renders);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "buffers/StreamingBuffer.h"
+#include "camera/Frustum.h"
+
+struct FrameData;
+
+// Cascaded shadow maps for the sun. The camera frustum up to the shadow distance is split into CASCADE_COUNT
+// slices, each covered by an orthographic light view rendered into one layer of a depth texture array.
+// Cascades are fitted to a bounding sphere of their slice and snapped to whole shadow texels, so they don't
+// shimmer when the camera moves or turns.
+// The sun moves slowly, so only the first cascade follows the camera every frame. The distant ones are cached:
+// they are rendered with a margin and only re-rendered when the camera leaves it, or when the sun has turned
+// further than a threshold (at most one of those per frame). Moving objects lag behind in cached cascades.
+class ShadowCascades {
+public:
+    static constexpr int CASCADE_COUNT = 4; // must match shadows.glsl
+    static constexpr int RESOLUTION = 2048;
+
+    static constexpr GLuint DATA_BINDING = 2;  // uniform block
+    static constexpr GLuint TEXTURE_UNIT = 14; // after the terrain's material textures
+
+    ShadowCascades() = default;
+    ~ShadowCascades();
+
+    ShadowCascades(const ShadowCascades&) = delete;
+    ShadowCascades& operator=(const ShadowCascades&) = delete;
+
+    void initialize();
+
+    // Fits the cascades to this frame's camera, decides which ones are re-rendered and uploads the shader data
+    void update(const FrameData& frame, const glm::vec3& sunDirection);
+    void endFrame(); // after the frame's commands are submitted, fences the streamed data
+
+    [[nodiscard]] bool needsRender(const int cascade) const { return m_enabled && m_cascades[cascade].dirty; }
+    void beginCascade(int cascade) const; // binds and clears the cascade's layer as depth target
+    void endCascades(); // marks the rendered cascades as cached
+
+    [[nodiscard]] const glm::mat4& getView(const int cascade) const { return m_cascades[cascade].view; }
+    [[nodiscard]] const glm::mat4& getProjection(const int cascade) const { return m_cascades[cascade].projection; }
+    [[nodiscard]] const Frustum& getFrustum(const int cascade) const { return m_cascades[cascade].frustum; }
+
+    void invalidate(); // re-render every cascade next frame, e.g. after the terrain changed
+
+    void imGui();
+
+private:
+    struct Cascade {
+        glm::mat4 view{1.0f};       // light rotation, the translation lives in the projection
+        glm::mat4 projection{1.0f};
+        Frustum frustum{};          // of projection * view, for culling the casters
+        glm::vec3 sunDirection{0.0f};
+        glm::vec3 center{0.0f};     // light space, snapped to texels
+        float radius = 0.0f;        // half the width of the covered square, margin included
+        float splitFar = 0.0f;      // view depth where the cascade ends
+        bool dirty = true;
+        bool valid = false;         // rendered at least once since the last invalidate
+        int renders = 0;
+    };
+
+    // std140 layout of ShadowData in shadows.glsl
+    struct ShadowData {
+        glm::mat4 viewProj[CASCADE_COUNT];
+        glm::vec4 splits;    // view depth where each cascade ends
+        glm::vec4 texelSize; // world units per shadow texel
+        glm::vec4 depthBias; // in depth buffer units
+        glm::vec4 params;    // x: enabled, y: normal offset in texels
+    };
+
+    void fit(Cascade& cascade, const glm::vec3& sunDirection, const glm::vec3& center, float radius) const;
+
+    GLuint m_depthArray = 0;
+    GLuint m_framebuffers[CASCADE_COUNT] = {};
+    StreamingBuffer m_stream;
+
+    Cascade m_cascades[CASCADE_COUNT];
+    int m_renderedThisFrame = 0;
+
+    // Settings
+    bool m_enabled = true;
+    float m_shadowDistance = 800.0f;
+    float m_splitLambda = 0.75f;        // 0: uniform splits, 1: logarithmic
+    float m_cacheMargin = 0.15f;        // extra coverage of cached cascades, relative to their radius
+    float m_sunThresholdDegrees = 0.5f; // cached cascades follow the sun in steps of this angle
+    float m_normalOffset = 1.5f;        // texels
+    float m_depthBiasTexels = 1.0f;
+};
@@ -0,0 +1,54 @@
+#include "SkyIrradiance.h"
+
+#include "Shader.h"
+#include "core/AssetManager.h"
+
+SkyIrradiance::~SkyIrradiance() {
+    if (m_accumulator != 0) glDeleteBuffers(1, &m_accumulator);
+    if (m_result != 0) glDeleteBuffers(1, &m_result);
+    if (m_readbackBuffer != 0) glDeleteBuffers(1, &m_readbackBuffer);
+    if (m_readbackFence) glDeleteSync(m_readbackFence);
+}
+
+void SkyIrradiance::initialize() {
+    m_projectShader = AssetManager::get().loadComputeShader("assets/shaders/sky_irradiance.comp");
+
+    glCreateBuffers(1, &m_accumulator);
+    glNamedBufferStorage(m_accumulator, sizeof(Coefficients), nullptr, 0);
+    glCreateBuffers(1, &m_result);
+    glNamedBufferStorage(m_result, sizeof(Coefficients), nullptr, 0);
+    glCreateBuffers(1, &m_readbackBuffer);
+    glNamedBufferStorage(m_readbackBuffer, sizeof(Coefficients), nullptr, GL_CLIENT_STORAGE_BIT);
+}
+
+void SkyIrradiance::update(const float scale) {
+    // Pick up the last pass once the GPU is done with it, never waits
+    if (m_readbackFence) {
+        const GLenum status = glClientWaitSync(m_readbackFence, 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glGetNamedBufferSubData(m_readbackBuffer, 0, sizeof(Coefficients), m_coefficients.data());
+            glDeleteSync(m_readbackFence);
+            m_readbackFence = nullptr;
+        }
+    }
+
+    m_projectShader->use();
+    m_projectShader->setInt("u_Slice", m_slice);
+    m_projectShader->setInt("u_SliceCount", FRAMES_PER_UPDATE);
+    m_projectShader->setFloat("u_Scale", scale);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ACCUMULATOR_BINDING, m_accumulator);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RESULT_BINDING, m_result);
+    glDispatchCompute(1, 1, 1);
+
+    const bool finished = m_slice == FRAMES_PER_UPDATE - 1;
+    m_slice = (m_slice + 1) % FRAMES_PER_UPDATE;
+
+    // Passes finish every FRAMES_PER_UPDATE frames, a readback still in flight by then is simply skipped
+    if (finished && !m_readbackFence) {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glCopyNamedBufferSubData(m_result, m_readbackBuffer, 0, 0, sizeof(Coefficients));
+        m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    } else {
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // next frame's slice adds to the accumulator
+    }
+}
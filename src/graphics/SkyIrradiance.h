@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Shader;
+
+// Ambient light from the sky as 9 spherical harmonics coefficients of irradiance, so lit shaders evaluate it with
+// a handful of multiply-adds (sky_irradiance.glsl) and it follows the day/night cycle.
+// A single workgroup compute dispatch projects SAMPLES_PER_FRAME of the SAMPLE_COUNT directions every frame into an
+// accumulator. When a full pass over the sphere is done the result is published, read back without stalling and
+// handed to FrameUBO, so the shaders see it a few frames late, which ambient light can afford.
+class SkyIrradiance {
+public:
+    static constexpr int SAMPLE_COUNT = 4096;     // directions on a Fibonacci sphere
+    static constexpr int SAMPLES_PER_FRAME = 256; // must match sky_irradiance.comp
+    static constexpr int FRAMES_PER_UPDATE = SAMPLE_COUNT / SAMPLES_PER_FRAME;
+
+    using Coefficients = std::array<glm::vec4, 9>; // rgb, already convolved with the cosine lobe
+
+    SkyIrradiance() = default;
+    ~SkyIrradiance();
+
+    SkyIrradiance(const SkyIrradiance&) = delete;
+    SkyIrradiance& operator=(const SkyIrradiance&) = delete;
+
+    void initialize();
+
+    // Projects this frame's slice of the sky. Needs the frame constants and the sky LUTs bound.
+    // scale: irradiance units, 1 / sun illuminance matches the lit shaders' sun term.
+    void update(float scale);
+
+    [[nodiscard]] const Coefficients& getCoefficients() const { return m_coefficients; }
+
+private:
+    // Matches the binding points in sky_irradiance.comp
+    static constexpr GLuint ACCUMULATOR_BINDING = 0;
+    static constexpr GLuint RESULT_BINDING = 1;
+
+    std::shared_ptr<Shader> m_projectShader;
+    GLuint m_accumulator = 0; // running sums of the pass in progress
+    GLuint m_result = 0;      // last finished pass
+    GLuint m_readbackBuffer = 0;
+    GLsync m_readbackFence = nullptr;
+
+    int m_slice = 0;
+    Coefficients m_coefficients{}; // black until the first pass has been read back
+};
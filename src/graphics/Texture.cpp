@@ -1,25 +1,38 @@
 #include "Texture.h"
 
-#include <cmath>
+#include <algorithm>
 #include <stb/stb_image.h>
 #include <iostream>
+#include "TextureCache.h"
+#include "utils/Profiler.h"
 
-Texture::Texture() : m_textureID(0), m_width(0), m_height(0), m_nrChannels(0) {
+Texture::Texture() : m_textureID(0), m_width(0), m_height(0), m_format(0) {
 }
 
-Texture::Texture(const std::string &imagePath, std::string typeName, const bool isColorData, const bool flipVertically)
-    : Texture(imagePath, isColorData, flipVertically) {
+Texture::Texture(std::string imagePath, const GLuint placeholderID)
+    : m_textureID(0),
+      m_path(std::move(imagePath)),
+      m_width(0),
+      m_height(0),
+      m_format(0),
+      m_placeholderID(placeholderID) {
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
+}
+
+Texture::Texture(const std::string &imagePath, std::string typeName, const bool isColorData, const bool flipVertically,
+                 const Usage usage)
+    : Texture(imagePath, isColorData, flipVertically, usage) {
     m_type = std::move(typeName);
 }
 
-Texture::Texture(const std::string &imagePath, const bool isColorData, const bool flipVertically)
+Texture::Texture(const std::string &imagePath, const bool isColorData, const bool flipVertically, const Usage usage)
     : m_textureID(0),
       m_path(imagePath),
       m_width(0),
       m_height(0),
-      m_nrChannels(0) {
+      m_format(0) {
     glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
-    loadFromFile(imagePath, isColorData, flipVertically);
+    loadFromFile(imagePath, isColorData, flipVertically, usage);
 }
 
 Texture::~Texture() {
@@ -36,11 +49,14 @@ Texture::Texture(Texture &&other) noexcept
       m_type(std::move(other.m_type)),
       m_width(other.m_width),
       m_height(other.m_height),
-      m_nrChannels(other.m_nrChannels) {
+      m_format(other.m_format),
+      m_placeholderID(other.m_placeholderID),
+      m_ready(other.m_ready) {
     other.m_textureID = 0;
     other.m_width = 0;
     other.m_height = 0;
-    other.m_nrChannels = 0;
+    other.m_format = 0;
+    other.m_ready = false;
 }
 
 // Move assignment
@@ -57,19 +73,22 @@ Texture &Texture::operator=(Texture &&other) noexcept {
         m_type = std::move(other.m_type);
         m_width = other.m_width;
         m_height = other.m_height;
-        m_nrChannels = other.m_nrChannels;
+        m_format = other.m_format;
+        m_placeholderID = other.m_placeholderID;
+        m_ready = other.m_ready;
 
         // Reset other
         other.m_textureID = 0;
         other.m_width = 0;
         other.m_height = 0;
-        other.m_nrChannels = 0;
+        other.m_format = 0;
+        other.m_ready = false;
     }
     return *this;
 }
 
 void Texture::bindToTextureUnit(const GLuint unit) const {
-    glBindTextureUnit(unit, m_textureID);
+    glBindTextureUnit(unit, m_ready || m_placeholderID == 0 ? m_textureID : m_placeholderID);
 }
 
 void Texture::setWrapMode(const GLint wrapS, const GLint wrapT) const {
@@ -82,63 +101,70 @@ void Texture::setFilterMode(const GLint minFilter, const GLint magFilter) const
     glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, magFilter);
 }
 
-void Texture::loadFromFile(const std::string &imagePath, const bool isColorData, const bool flipVertically) {
-    stbi_set_flip_vertically_on_load(flipVertically);
+void Texture::ImageDeleter::operator()(unsigned char *pixels) const {
+    stbi_image_free(pixels);
+}
 
-    unsigned char *data = stbi_load(
-        imagePath.c_str(),
-        &m_width,
-        &m_height,
-        &m_nrChannels,
-        0
-    );
+void Texture::loadFromFile(const std::string &imagePath, const bool isColorData, const bool flipVertically,
+                           const Usage usage) {
+    PROFILE_SCOPE("Texture::loadFromFile");
+    const CookedTexture cooked = TextureCache::load(imagePath, usage, isColorData, flipVertically);
 
-    if (!data) {
+    if (!cooked.isValid()) {
         std::cerr << "Failed to load textures: " << imagePath << std::endl;
         return;
     }
 
-    GLenum dataFormat = 0;
-    GLenum internalFormat = 0;
-
-    if (m_nrChannels == 4) {
-        dataFormat = GL_RGBA;
-        internalFormat = isColorData ? GL_SRGB8_ALPHA8 : GL_RGBA8;
-        // glTextureStorage2D requires us to be precise about internal format, unlike glTexImage2D
-    } else if (m_nrChannels == 3) {
-        dataFormat = GL_RGB;
-        internalFormat = isColorData ? GL_SRGB8 : GL_RGB8;
-    } else if (m_nrChannels == 1) {
-        dataFormat = GL_RED;
-        internalFormat = GL_R8;
-    } else {
-        std::cerr << "Unsupported number of channels: " << m_nrChannels << " in textures: " << imagePath << std::endl;
-        stbi_image_free(data);
-        return;
+    const int levels = static_cast<int>(cooked.levels.size());
+    beginUpload(cooked.format, cooked.levels[0].width, cooked.levels[0].height, levels);
+    for (int level = 0; level < levels; level++) {
+        uploadBlockRows(level, 0, cooked.getBlockRows(level), static_cast<GLsizei>(cooked.levels[level].size),
+                        cooked.getBlocks() + cooked.levels[level].offset);
     }
+    endUpload();
+}
+
+Texture::Image Texture::decode(const std::string &imagePath, const bool flipVertically) {
+    PROFILE_SCOPE("Texture::decode");
+    // The global stbi_set_flip_vertically_on_load would race with decodes on other threads
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    Image image;
+    image.pixels.reset(stbi_load(imagePath.c_str(), &image.width, &image.height, &image.channels, 0));
+    return image;
+}
+
+void Texture::beginUpload(const GLenum compressedFormat, const int width, const int height, const int levels) {
+    m_width = width;
+    m_height = height;
+    m_format = compressedFormat;
 
     setWrapMode(GL_REPEAT, GL_REPEAT);
     setFilterMode(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
 
-    const GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(std::max(m_width, m_height))));
-
-    glTextureStorage2D(m_textureID, levels, internalFormat, m_width, m_height);
+    // The mip chain comes precomputed with the blocks, glGenerateTextureMipmap can't write compressed formats anyway
+    glTextureStorage2D(m_textureID, levels, compressedFormat, m_width, m_height);
+}
 
-    // is this needed? pixel row alignment, default is 4
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+void Texture::uploadBlockRows(const int level, const int firstBlockRow, const int blockRows, const GLsizei size,
+                              const void *blocks) const {
+    const int levelWidth = std::max(1, m_width >> level);
+    const int levelHeight = std::max(1, m_height >> level);
+    const int firstRow = firstBlockRow * 4;
 
-    glTextureSubImage2D(
+    // The last block row of a level may cover fewer than 4 texel rows
+    glCompressedTextureSubImage2D(
         m_textureID,
-        0, 0, 0,
-        m_width, m_height,
-        dataFormat,
-        GL_UNSIGNED_BYTE,
-        data
+        level, 0, firstRow,
+        levelWidth, std::min(blockRows * 4, levelHeight - firstRow),
+        m_format,
+        size,
+        blocks
     );
+}
 
-    glGenerateTextureMipmap(m_textureID);
-
-    stbi_image_free(data);
+void Texture::endUpload() {
+    m_ready = true;
 }
 
 GLuint Texture::getID() const {
@@ -1,14 +1,36 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <memory>
 #include <string>
 
 class Texture {
 public:
+    struct ImageDeleter {
+        void operator()(unsigned char* pixels) const; // stbi_image_free
+    };
+
+    // Decoded pixels, 8 bits per channel, tightly packed rows
+    struct Image {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::unique_ptr<unsigned char[], ImageDeleter> pixels; // null when decoding failed
+    };
+
+    // What a texture holds. Picks the block compression it is cooked to (TextureCache) and the placeholder an
+    // asynchronously loaded one binds until its pixels are resident (TextureLoader).
+    enum class Usage { Color, Normal, Mask };
+
     Texture();
 
-    explicit Texture(const std::string &imagePath, std::string typeName, bool isColorData = true, bool flipVertically = true);
-    explicit Texture(const std::string& imagePath, bool isColorData = true, bool flipVertically = false);
+    // Empty until beginUpload/uploadBlockRows/endUpload complete, binds placeholderID until then
+    Texture(std::string imagePath, GLuint placeholderID);
+
+    explicit Texture(const std::string &imagePath, std::string typeName, bool isColorData = true, bool flipVertically = true,
+                     Usage usage = Usage::Color);
+    explicit Texture(const std::string& imagePath, bool isColorData = true, bool flipVertically = false,
+                     Usage usage = Usage::Color);
 
     ~Texture();
 
@@ -25,7 +47,21 @@ public:
     void setWrapMode(GLint wrapS, GLint wrapT) const;
     void setFilterMode(GLint minFilter = GL_LINEAR_MIPMAP_LINEAR, GLint magFilter = GL_LINEAR) const;
 
-    void loadFromFile(const std::string &imagePath, bool isColorData = true, bool flipVertically = false);
+    // Through the TextureCache, cooking the image the first time
+    void loadFromFile(const std::string &imagePath, bool isColorData = true, bool flipVertically = false,
+                      Usage usage = Usage::Color);
+
+    // Safe to call from any thread, the flip is set per thread
+    static Image decode(const std::string &imagePath, bool flipVertically);
+
+    // Upload of a block compressed mip chain in steps, so a large texture can be spread over frames. beginUpload
+    // allocates the storage, uploadBlockRows copies rows of 4x4 blocks [firstBlockRow, firstBlockRow + blockRows) of a
+    // level from blocks or, with a GL_PIXEL_UNPACK_BUFFER bound, from that offset into it. endUpload marks it ready.
+    void beginUpload(GLenum compressedFormat, int width, int height, int levels);
+    void uploadBlockRows(int level, int firstBlockRow, int blockRows, GLsizei size, const void *blocks) const;
+    void endUpload();
+
+    [[nodiscard]] bool isReady() const { return m_ready; }
 
     [[nodiscard]] GLuint getID() const;
     [[nodiscard]] const std::string &getPath() const;
@@ -37,5 +73,7 @@ private:
     std::string m_type;
     int m_width;
     int m_height;
-    int m_nrChannels;
+    GLenum m_format; // compressed internal format
+    GLuint m_placeholderID = 0; // not owned
+    bool m_ready = false;
 };
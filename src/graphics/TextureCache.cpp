@@ -0,0 +1,279 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "BlockCompression.h"
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
+namespace {
+    constexpr char MAGIC[4] = {'S', 'C', 'T', 'X'};
+    constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t settings; // usage, colour data and flip it was cooked with, see cookSettings
+        uint32_t padding;
+        uint64_t sourceSize;
+        int64_t sourceTime; // last write time, in the file clock's ticks
+    };
+    static_assert(sizeof(FileHeader) == 48);
+
+    uint32_t cookSettings(const Texture::Usage usage, const bool isColorData, const bool flipVertically) {
+        return static_cast<uint32_t>(usage) | static_cast<uint32_t>(isColorData) << 2 | static_cast<uint32_t>(flipVertically) << 3;
+    }
+
+    GLenum formatFor(const Texture::Usage usage, const bool isColorData) {
+        switch (usage) {
+            case Texture::Usage::Normal: return GL_COMPRESSED_RG_RGTC2;
+            case Texture::Usage::Mask:   return GL_COMPRESSED_RED_RGTC1;
+            default:                     return isColorData ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        }
+    }
+
+    int blockSizeFor(const GLenum format) {
+        return format == GL_COMPRESSED_RED_RGTC1 ? 8 : 16;
+    }
+
+    // Every level down to 1x1, packed one after the other
+    std::vector<CookedTexture::Level> layoutLevels(int width, int height, const int blockSize) {
+        std::vector<CookedTexture::Level> levels;
+        size_t offset = 0;
+        while (true) {
+            const size_t size = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+            levels.push_back({width, height, offset, size});
+            offset += size;
+            if (width == 1 && height == 1) return levels;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    // Colour data is filtered in linear space, averaging sRGB values darkens the mips
+    float srgbToLinear(const uint8_t value) {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> result{};
+            for (int i = 0; i < 256; i++) {
+                const float c = static_cast<float>(i) / 255.0f;
+                result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return result;
+        }();
+        return table[value];
+    }
+
+    uint8_t linearToSrgb(const float value) {
+        const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+    }
+
+    uint8_t toByte(const float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 255.0f)));
+    }
+
+    std::vector<uint8_t> toRgba(const Texture::Image& image) {
+        std::vector<uint8_t> rgba(static_cast<size_t>(image.width) * image.height * 4);
+        const size_t count = static_cast<size_t>(image.width) * image.height;
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* in = &image.pixels[i * image.channels];
+            uint8_t* out = &rgba[i * 4];
+            switch (image.channels) {
+                case 1: out[0] = out[1] = out[2] = in[0]; out[3] = 255; break;
+                case 2: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break; // grey and alpha
+                case 3: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255; break;
+                default: std::memcpy(out, in, 4); break;
+            }
+        }
+        return rgba;
+    }
+
+    // 2x2 box filter, odd sizes repeat the last row or column
+    std::vector<uint8_t> downsample(const std::vector<uint8_t>& source, const int width, const int height,
+                                    const int nextWidth, const int nextHeight,
+                                    const Texture::Usage usage, const bool isColorData) {
+        std::vector<uint8_t> result(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+        Parallel::forRange(0, nextHeight, [&](const int begin, const int end) {
+            for (int y = begin; y < end; y++) {
+                const int y0 = std::min(2 * y, height - 1);
+                const int y1 = std::min(2 * y + 1, height - 1);
+                for (int x = 0; x < nextWidth; x++) {
+                    const int x0 = std::min(2 * x, width - 1);
+                    const int x1 = std::min(2 * x + 1, width - 1);
+                    const uint8_t* texels[4] = {
+                        &source[(static_cast<size_t>(y0) * width + x0) * 4], &source[(static_cast<size_t>(y0) * width + x1) * 4],
+                        &source[(static_cast<size_t>(y1) * width + x0) * 4], &source[(static_cast<size_t>(y1) * width + x1) * 4]
+                    };
+                    uint8_t* out = &result[(static_cast<size_t>(y) * nextWidth + x) * 4];
+
+                    float sum[4] = {};
+                    for (const uint8_t* texel : texels) {
+                        for (int c = 0; c < 4; c++) {
+                            if (c < 3 && usage == Texture::Usage::Normal) {
+                                sum[c] += texel[c] / 127.5f - 1.0f;
+                            } else if (c < 3 && usage == Texture::Usage::Color && isColorData) {
+                                sum[c] += srgbToLinear(texel[c]);
+                            } else {
+                                sum[c] += texel[c];
+                            }
+                        }
+                    }
+
+                    if (usage == Texture::Usage::Normal) {
+                        // The average of unit vectors is shorter, renormalize
+                        const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                        for (int c = 0; c < 3; c++) {
+                            out[c] = toByte((length > 1e-6f ? sum[c] / length : c == 2 ? 1.0f : 0.0f) * 127.5f + 127.5f);
+                        }
+                    } else if (usage == Texture::Usage::Color && isColorData) {
+                        for (int c = 0; c < 3; c++) out[c] = linearToSrgb(sum[c] * 0.25f);
+                    } else {
+                        for (int c = 0; c < 3; c++) out[c] = toByte(sum[c] * 0.25f);
+                    }
+                    out[3] = toByte(sum[3] * 0.25f);
+                }
+            }
+        }, 16);
+
+        return result;
+    }
+
+    void encodeLevel(const std::vector<uint8_t>& rgba, const CookedTexture::Level& level, const GLenum format,
+                     const int blockSize, unsigned char* out) {
+        const int blocksX = (level.width + 3) / 4;
+        const int blocksY = (level.height + 3) / 4;
+
+        Parallel::forRange(0, blocksY, [&](const int begin, const int end) {
+            uint8_t block[64];
+            uint8_t red[16], green[16];
+            for (int by = begin; by < end; by++) {
+                for (int bx = 0; bx < blocksX; bx++) {
+                    // Blocks past the edge of small mips repeat the last texel
+                    for (int i = 0; i < 16; i++) {
+                        const int x = std::min(bx * 4 + i % 4, level.width - 1);
+                        const int y = std::min(by * 4 + i / 4, level.height - 1);
+                        std::memcpy(&block[i * 4], &rgba[(static_cast<size_t>(y) * level.width + x) * 4], 4);
+                        red[i] = block[i * 4];
+                        green[i] = block[i * 4 + 1];
+                    }
+
+                    unsigned char* blockOut = out + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+                    if (format == GL_COMPRESSED_RED_RGTC1) {
+                        BlockCompression::encodeBC4(red, blockOut);
+                    } else if (format == GL_COMPRESSED_RG_RGTC2) {
+                        BlockCompression::encodeBC5(red, green, blockOut);
+                    } else {
+                        BlockCompression::encodeBC7(block, blockOut);
+                    }
+                }
+            }
+        }, 8);
+    }
+}
+
+std::string TextureCache::getCachePath(const std::string& sourcePath) {
+    return sourcePath + ".sctex";
+}
+
+CookedTexture TextureCache::cook(const Texture::Image& image, const Texture::Usage usage, const bool isColorData) {
+    PROFILE_SCOPE("TextureCache::cook");
+    CookedTexture cooked;
+    if (!image.pixels || image.width <= 0 || image.height <= 0) return cooked;
+
+    cooked.format = formatFor(usage, isColorData);
+    cooked.blockSize = blockSizeFor(cooked.format);
+    cooked.levels = layoutLevels(image.width, image.height, cooked.blockSize);
+    cooked.memory.resize(cooked.levels.back().offset + cooked.levels.back().size);
+
+    std::vector<uint8_t> rgba = toRgba(image);
+    for (size_t i = 0; i < cooked.levels.size(); i++) {
+        const CookedTexture::Level& level = cooked.levels[i];
+        encodeLevel(rgba, level, cooked.format, cooked.blockSize, cooked.memory.data() + level.offset);
+
+        if (i + 1 < cooked.levels.size()) {
+            const CookedTexture::Level& next = cooked.levels[i + 1];
+            rgba = downsample(rgba, level.width, level.height, next.width, next.height, usage, isColorData);
+        }
+    }
+    return cooked;
+}
+
+CookedTexture TextureCache::load(const std::string& sourcePath, const Texture::Usage usage, const bool isColorData,
+                                 const bool flipVertically) {
+    PROFILE_SCOPE("TextureCache::load");
+    std::error_code error;
+    const uint64_t sourceSize = std::filesystem::file_size(sourcePath, error);
+    if (error) return {};
+    const int64_t sourceTime = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+    if (error) return {};
+
+    const uint32_t settings = cookSettings(usage, isColorData, flipVertically);
+    const std::string cachePath = getCachePath(sourcePath);
+
+    CookedTexture cooked;
+    if (cooked.file.open(cachePath) && cooked.file.getSize() >= sizeof(FileHeader)) {
+        FileHeader header{};
+        std::memcpy(&header, cooked.file.getData(), sizeof(header));
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+            header.settings == settings && header.sourceSize == sourceSize && header.sourceTime == sourceTime &&
+            header.format == formatFor(usage, isColorData) && header.width > 0 && header.height > 0) {
+            cooked.format = header.format;
+            cooked.blockSize = blockSizeFor(cooked.format);
+            cooked.levels = layoutLevels(static_cast<int>(header.width), static_cast<int>(header.height), cooked.blockSize);
+            cooked.fileOffset = sizeof(FileHeader);
+
+            const size_t expectedSize = sizeof(FileHeader) + cooked.levels.back().offset + cooked.levels.back().size;
+            if (cooked.levels.size() == header.levelCount && cooked.file.getSize() == expectedSize) {
+                return cooked;
+            }
+        }
+        cooked = {}; // stale or truncated, cooked again below
+    }
+
+    const Texture::Image image = Texture::decode(sourcePath, flipVertically);
+    cooked = cook(image, usage, isColorData);
+    if (!cooked.isValid()) return cooked;
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = cooked.format;
+    header.width = static_cast<uint32_t>(image.width);
+    header.height = static_cast<uint32_t>(image.height);
+    header.levelCount = static_cast<uint32_t>(cooked.levels.size());
+    header.settings = settings;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+
+    // Written next to it and renamed, a crash mid-write never leaves a truncated cache behind
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(cooked.memory.data()), static_cast<std::streamsize>(cooked.memory.size()));
+        if (!file) {
+            std::cerr << "WARNING::TEXTURE_CACHE:: Could not write " << cachePath << ", cooking again next run" << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return cooked;
+        }
+    }
+    std::filesystem::rename(tempPath, cachePath, error);
+
+    std::cout << "Cooked " << sourcePath << ": " << image.width * image.height * image.channels / 1024 << " KB -> "
+              << cooked.memory.size() / 1024 << " KB with mips" << std::endl;
+    return cooked;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Texture.h"
+#include "utils/MappedFile.h"
+
+// A texture cooked to a block compressed format with its whole mip chain (see TextureCache)
+struct CookedTexture {
+    struct Level {
+        int width = 0;
+        int height = 0;
+        size_t offset = 0; // into getBlocks()
+        size_t size = 0;
+    };
+
+    GLenum format = 0;
+    int blockSize = 0; // bytes per 4x4 block
+    std::vector<Level> levels;
+
+    MappedFile file;                   // from the cache
+    size_t fileOffset = 0;             // where the blocks start in it
+    std::vector<unsigned char> memory; // freshly cooked
+
+    [[nodiscard]] const unsigned char* getBlocks() const { return file.isOpen() ? file.getData() + fileOffset : memory.data(); }
+    [[nodiscard]] int getBlockRows(const int level) const { return (levels[level].height + 3) / 4; }
+    [[nodiscard]] size_t getBlockRowSize(const int level) const { return static_cast<size_t>((levels[level].width + 3) / 4) * blockSize; }
+    [[nodiscard]] bool isValid() const { return !levels.empty(); }
+};
+
+// Textures are cooked once into a cache file next to their source (<source>.sctex) and memory mapped from there on
+// later runs, so loading costs the I/O of the compressed data instead of a PNG/JPEG decode and a mip build.
+// The formats by Texture::Usage:
+//   Color  -> BC7 (sRGB for colour data), 4:1 against RGBA8
+//   Normal -> BC5, only x and y are stored, shaders rebuild z
+//   Mask   -> BC4, the red channel, 8:1 against the RGBA8 drivers store RGB8 as
+namespace TextureCache {
+    // The source's cooked texture: mapped from the cache when it was cooked from this version of the source with the
+    // same settings, otherwise decoded, cooked and written back. Invalid if the source can't be read.
+    CookedTexture load(const std::string& sourcePath, Texture::Usage usage, bool isColorData, bool flipVertically);
+
+    // Builds the mip chain and encodes every level, the blocks on worker threads
+    CookedTexture cook(const Texture::Image& image, Texture::Usage usage, bool isColorData);
+
+    std::string getCachePath(const std::string& sourcePath);
+}
@@ -0,0 +1,194 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <imgui.h>
+
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
+namespace {
+    GLuint createPlaceholder(const unsigned char r, const unsigned char g, const unsigned char b) {
+        const unsigned char texel[4] = {r, g, b, 255};
+        GLuint id = 0;
+        glCreateTextures(GL_TEXTURE_2D, 1, &id);
+        glTextureStorage2D(id, 1, GL_RGBA8, 1, 1);
+        glTextureSubImage2D(id, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+        return id;
+    }
+}
+
+TextureLoader& TextureLoader::get() { // Meyers singleton
+    static TextureLoader instance;
+    return instance;
+}
+
+void TextureLoader::initialize() {
+    m_ring.generate(MAX_UPLOAD_BUDGET);
+
+    m_placeholders[static_cast<int>(Texture::Usage::Color)] = createPlaceholder(128, 128, 128);
+    m_placeholders[static_cast<int>(Texture::Usage::Normal)] = createPlaceholder(128, 128, 255);
+    m_placeholders[static_cast<int>(Texture::Usage::Mask)] = createPlaceholder(255, 255, 255);
+
+    // Leave a core to the main thread, which keeps rendering meanwhile
+    const int workers = std::max(1, Parallel::workerCount() - 1);
+    for (int i = 0; i < workers; i++) {
+        m_workers.emplace_back([this](const std::stop_token& stop) { workerLoop(stop); });
+    }
+}
+
+std::shared_ptr<Texture> TextureLoader::load(const std::string& path, const Texture::Usage usage,
+                                             const bool isColorData, const bool flipVertically) {
+    if (m_workers.empty()) {
+        initialize();
+    }
+
+    auto texture = std::make_shared<Texture>(path, m_placeholders[static_cast<int>(usage)]);
+    {
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back({texture, path, usage, isColorData, flipVertically});
+    }
+    m_jobAdded.notify_one();
+    m_pending++;
+    return texture;
+}
+
+void TextureLoader::workerLoop(const std::stop_token& stop) {
+    Profiler::setThreadName("Texture load");
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_jobAdded.wait(lock, stop, [this] { return !m_jobs.empty(); })) {
+                return; // stop requested
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        // Every job hands back an upload, even a failed or abandoned one, so update() can count it as done
+        Upload upload;
+        upload.texture = job.texture;
+        upload.path = job.path;
+        if (!job.texture.expired()) {
+            upload.cooked = TextureCache::load(job.path, job.usage, job.isColorData, job.flipVertically);
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_loaded.push_back(std::move(upload));
+    }
+}
+
+void TextureLoader::update() {
+    m_uploadedLastFrame = 0;
+    if (m_pending == 0) return;
+    PROFILE_SCOPE("TextureLoader::update");
+
+    {
+        std::lock_guard lock(m_mutex);
+        for (Upload& upload : m_loaded) {
+            m_uploads.push_back(std::move(upload));
+        }
+        m_loaded.clear();
+    }
+    if (m_uploads.empty()) return;
+
+    m_ring.beginFrame();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_ring.getID());
+
+    const GLsizeiptr budget = std::min(m_budget, m_ring.getRegionSize());
+    while (!m_uploads.empty()) {
+        Upload& upload = m_uploads.front();
+        const std::shared_ptr<Texture> texture = upload.texture.lock();
+        const CookedTexture& cooked = upload.cooked;
+
+        if (!texture || !cooked.isValid()) {
+            if (texture) {
+                std::cerr << "ERROR::TEXTURE_LOADER:: Failed to load " << upload.path << ", keeping the placeholder" << std::endl;
+            }
+            m_uploads.pop_front();
+            m_pending--;
+            continue;
+        }
+
+        // Whole block rows only, a large level continues next frame where this one stopped
+        const auto rowSize = static_cast<GLsizeiptr>(cooked.getBlockRowSize(upload.level));
+        const int blockRows = cooked.getBlockRows(upload.level);
+        const GLsizeiptr available = budget - m_ring.getBytesUsed() - 4; // allocations are 4-byte aligned
+        const int rows = static_cast<int>(std::min<GLsizeiptr>(blockRows - upload.nextBlockRow,
+                                                               std::max<GLsizeiptr>(available, 0) / rowSize));
+        if (rows == 0) break;
+
+        const StreamingBuffer::Allocation allocation = m_ring.allocate(rows * rowSize, 4);
+        if (!allocation.data) break;
+
+        if (upload.level == 0 && upload.nextBlockRow == 0) {
+            texture->beginUpload(cooked.format, cooked.levels[0].width, cooked.levels[0].height,
+                                 static_cast<int>(cooked.levels.size()));
+        }
+
+        const unsigned char* blocks = cooked.getBlocks() + cooked.levels[upload.level].offset;
+        std::memcpy(allocation.data, blocks + upload.nextBlockRow * rowSize, rows * rowSize);
+        texture->uploadBlockRows(upload.level, upload.nextBlockRow, rows, static_cast<GLsizei>(rows * rowSize),
+                                 reinterpret_cast<const void*>(allocation.offset));
+        upload.nextBlockRow += rows;
+        m_uploadedLastFrame += rows * rowSize;
+
+        if (upload.nextBlockRow == blockRows) {
+            upload.level++;
+            upload.nextBlockRow = 0;
+            if (upload.level == static_cast<int>(cooked.levels.size())) {
+                texture->endUpload();
+                m_uploads.pop_front();
+                m_pending--;
+            }
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_ring.endFrame();
+}
+
+void TextureLoader::finish() {
+    PROFILE_SCOPE("TextureLoader::finish");
+    while (m_pending > 0) {
+        update();
+        if (m_uploads.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // the workers are still decoding
+        }
+    }
+}
+
+void TextureLoader::shutdown() {
+    for (auto& worker : m_workers) {
+        worker.request_stop(); // wakes the ones waiting for a job
+    }
+    m_workers.clear(); // joins
+
+    m_jobs.clear();
+    m_loaded.clear();
+    m_uploads.clear();
+    m_pending = 0;
+
+    m_ring.release();
+    for (GLuint& placeholder : m_placeholders) {
+        if (placeholder != 0) glDeleteTextures(1, &placeholder);
+        placeholder = 0;
+    }
+}
+
+void TextureLoader::imGui() {
+    if (ImGui::CollapsingHeader("Texture Streaming")) {
+        ImGui::Text("Pending textures: %d", m_pending);
+        ImGui::Text("Uploaded last frame: %.1f MB", static_cast<double>(m_uploadedLastFrame) / (1 << 20));
+        ImGui::Text("Ring stalls: %d", m_ring.getStallCount());
+
+        int budgetMb = static_cast<int>(m_budget >> 20);
+        if (ImGui::SliderInt("Upload budget (MB/frame)", &budgetMb, 1, static_cast<int>(MAX_UPLOAD_BUDGET >> 20))) {
+            m_budget = static_cast<GLsizeiptr>(budgetMb) << 20;
+        }
+    }
+}
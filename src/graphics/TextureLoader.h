@@ -0,0 +1,86 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Texture.h"
+#include "TextureCache.h"
+#include "buffers/StreamingBuffer.h"
+
+// Loads textures without stalling the frame. Worker threads fetch the cooked mip chains from the TextureCache
+// (mapping the cache file, or decoding and cooking the source the first time), then update() on the main thread
+// copies rows of blocks into a persistently mapped pixel unpack ring, at most the upload budget per frame, and
+// uploads them from there. Until the last level is in the texture binds a 1x1 placeholder, so callers can use it
+// right away.
+//
+//   auto texture = TextureLoader::get().load(path, Texture::Usage::Normal, false, false);
+//   ...
+//   TextureLoader::get().update(); // every frame
+class TextureLoader {
+public:
+    static constexpr GLsizeiptr MAX_UPLOAD_BUDGET = 16 << 20; // bytes per frame, the size of a ring region
+
+    static TextureLoader& get();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Returns immediately, main thread only (the empty texture and the placeholders are GL objects)
+    std::shared_ptr<Texture> load(const std::string& path, Texture::Usage usage,
+                                  bool isColorData = true, bool flipVertically = false);
+
+    void update(); // once per frame, uploads what the workers loaded within the budget
+    void finish(); // blocks until every requested texture is resident, for runs that measure frames
+
+    // Stops the workers and deletes the ring and the placeholders. Called by Engine::shutdown() while the context
+    // is still alive, the singleton itself is only destroyed after glfwTerminate()
+    void shutdown();
+
+    void imGui();
+
+    [[nodiscard]] int getPendingCount() const { return m_pending; }
+
+private:
+    struct Job {
+        std::weak_ptr<Texture> texture; // decoding is skipped when it's gone already (terrain regenerated, ...)
+        std::string path;
+        Texture::Usage usage = Texture::Usage::Color;
+        bool isColorData = true;
+        bool flipVertically = false;
+    };
+
+    struct Upload {
+        std::weak_ptr<Texture> texture;
+        std::string path;
+        CookedTexture cooked;
+        int level = 0;
+        int nextBlockRow = 0; // of level
+    };
+
+    TextureLoader() = default; // Private constructor for singleton
+    ~TextureLoader() = default;
+
+    void initialize();
+    void workerLoop(const std::stop_token& stop);
+
+    StreamingBuffer m_ring;
+    GLuint m_placeholders[3] = {}; // by Texture::Usage: grey, flat normal, white
+    GLsizeiptr m_budget = 8 << 20;
+    GLsizeiptr m_uploadedLastFrame = 0;
+
+    // Main thread only
+    int m_pending = 0; // requested and not yet resident or failed
+    std::deque<Upload> m_uploads;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_jobAdded;
+    std::deque<Job> m_jobs;
+    std::vector<Upload> m_loaded; // finished by the workers, collected by update()
+
+    std::vector<std::jthread> m_workers; // last, so they are stopped and joined before the queues go away
+};
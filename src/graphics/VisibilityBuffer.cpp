@@ -0,0 +1,148 @@
+#include "VisibilityBuffer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "InstancedModel.h"
+#include "Model.h"
+#include "Shader.h"
+#include "core/AssetManager.h"
+#include "core/Renderer.h"
+#include "world/Terrain.h"
+
+// The resolve reads both vertex types as 14 tightly packed floats
+static_assert(sizeof(Vertex) == 14 * sizeof(float));
+static_assert(sizeof(Terrain::TerrainVertex) == 14 * sizeof(float));
+
+VisibilityBuffer::~VisibilityBuffer() {
+    if (m_vegetationVertices != 0) glDeleteBuffers(1, &m_vegetationVertices);
+    if (m_vegetationIndices != 0) glDeleteBuffers(1, &m_vegetationIndices);
+}
+
+void VisibilityBuffer::initialize() {
+    const std::string path = "assets/shaders/";
+    auto& assetManager = AssetManager::get();
+    m_terrainShader = assetManager.loadShader(path + "visibility_terrain.vert", path + "visibility_terrain.frag");
+    m_vegetationShader = assetManager.loadShader(path + "visibility_vegetation.vert", path + "visibility_vegetation.frag");
+    m_resolveShader = assetManager.loadShader(path + "fullscreen.vert", path + "visibility_resolve.frag");
+    m_VAO.generate();
+
+    // The resolve samples every material of the terrain and the trees in one shader
+    GLint textureUnits = 0;
+    GLint fragmentBlocks = 0;
+    GLint bufferBindings = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &textureUnits);
+    glGetIntegerv(GL_MAX_FRAGMENT_SHADER_STORAGE_BLOCKS, &fragmentBlocks);
+    glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &bufferBindings);
+
+    m_supported = textureUnits > static_cast<GLint>(DEPTH_UNIT) &&
+                  fragmentBlocks >= 8 && // 3 light lists and 5 geometry buffers
+                  bufferBindings > static_cast<GLint>(VEGETATION_INSTANCES_BINDING);
+    if (!m_supported) {
+        std::cerr << "WARNING::VISIBILITY_BUFFER:: Not supported (" << textureUnits << " texture units, "
+                  << fragmentBlocks << " fragment storage blocks), rendering forward" << std::endl;
+    }
+}
+
+bool VisibilityBuffer::prepare(const InstancedModel* trees) {
+    if (!m_supported) return false;
+    if (!trees) return true;
+
+    const Model* model = trees->getModel().get();
+    if (model->getMeshes().size() > MAX_VEGETATION_MESHES) {
+        if (!m_warnedModel) {
+            std::cerr << "WARNING::VISIBILITY_BUFFER:: Vegetation model has " << model->getMeshes().size()
+                      << " meshes, at most " << MAX_VEGETATION_MESHES << " are supported, rendering forward" << std::endl;
+            m_warnedModel = true;
+        }
+        return false;
+    }
+
+    if (model != m_vegetationModel) {
+        buildVegetationBuffers(*model);
+    }
+    return true;
+}
+
+void VisibilityBuffer::buildVegetationBuffers(const Model& model) {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+
+    const auto& meshes = model.getMeshes();
+    m_meshCount = static_cast<int>(meshes.size());
+    for (int i = 0; i < m_meshCount; i++) {
+        m_meshFirstIndex[i] = static_cast<GLuint>(indices.size());
+        m_meshBaseVertex[i] = static_cast<GLuint>(vertices.size());
+        vertices.insert(vertices.end(), meshes[i].getVertices().begin(), meshes[i].getVertices().end());
+        indices.insert(indices.end(), meshes[i].getIndices().begin(), meshes[i].getIndices().end());
+    }
+
+    if (m_vegetationVertices != 0) glDeleteBuffers(1, &m_vegetationVertices);
+    if (m_vegetationIndices != 0) glDeleteBuffers(1, &m_vegetationIndices);
+
+    // Storage needs a non-zero size even for an empty model
+    glCreateBuffers(1, &m_vegetationVertices);
+    glNamedBufferStorage(m_vegetationVertices, std::max<GLsizeiptr>(sizeof(Vertex), vertices.size() * sizeof(Vertex)),
+                         vertices.empty() ? nullptr : vertices.data(), 0);
+    glCreateBuffers(1, &m_vegetationIndices);
+    glNamedBufferStorage(m_vegetationIndices, std::max<GLsizeiptr>(sizeof(GLuint), indices.size() * sizeof(GLuint)),
+                         indices.empty() ? nullptr : indices.data(), 0);
+
+    m_vegetationModel = &model;
+}
+
+void VisibilityBuffer::renderGeometry(Renderer& renderer, const Terrain& terrain, const InstancedModel* trees,
+                                      const bool culled) const {
+    m_terrainShader->use();
+    m_terrainShader->setMat4("model", terrain.getModelMatrix());
+    terrain.renderDepth(culled);
+
+    if (trees) {
+        renderer.renderInstanced(*trees, *m_vegetationShader); // sets u_Mesh and the alpha tested diffuse map
+    }
+}
+
+void VisibilityBuffer::resolve(const Terrain& terrain, const InstancedModel* trees, const GLuint visibility,
+                               const GLuint depth, const bool culled) const {
+    const Shader& shader = *m_resolveShader;
+    shader.use();
+
+    terrain.bindMaterial(shader);
+    const glm::mat4 model = terrain.getModelMatrix();
+    shader.setMat4("u_TerrainModel", model);
+    shader.setMat3("u_TerrainNormalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_VERTICES_BINDING, terrain.getVertexBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_INDICES_BINDING, terrain.getIndexBufferID());
+
+    if (trees && m_vegetationModel) {
+        const auto& meshes = m_vegetationModel->getMeshes();
+        for (int i = 0; i < m_meshCount; i++) {
+            const Material& material = meshes[i].getMaterial();
+            if (material.diffuseMap) material.diffuseMap->bindToTextureUnit(VEGETATION_DIFFUSE_UNIT + i);
+            if (material.normalMap) material.normalMap->bindToTextureUnit(VEGETATION_NORMAL_UNIT + i);
+            if (material.armMap) material.armMap->bindToTextureUnit(VEGETATION_ARM_UNIT + i);
+
+            const std::string index = "[" + std::to_string(i) + "]";
+            shader.setUInt("u_MeshFirstIndex" + index, m_meshFirstIndex[i]);
+            shader.setUInt("u_MeshBaseVertex" + index, m_meshBaseVertex[i]);
+        }
+
+        // Instance IDs of the geometry pass index whichever buffer it drew from
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VEGETATION_VERTICES_BINDING, m_vegetationVertices);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VEGETATION_INDICES_BINDING, m_vegetationIndices);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VEGETATION_INSTANCES_BINDING,
+                         culled ? trees->getVisibleBufferID() : trees->getInstanceBufferID());
+    }
+
+    glBindTextureUnit(VISIBILITY_UNIT, visibility);
+    glBindTextureUnit(DEPTH_UNIT, depth);
+
+    // The visible instances were compacted by the culling compute shader
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_VAO.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
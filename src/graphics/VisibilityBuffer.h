@@ -0,0 +1,74 @@
+#pragma once
+#include <memory>
+#include <glad/glad.h>
+
+#include "buffers/VAO.h"
+
+class InstancedModel;
+class Model;
+class Renderer;
+class Shader;
+class Terrain;
+
+// Deferred path for the terrain and the trees. The geometry pass rasterizes only a triangle and instance ID per
+// pixel (visibility.glsl) into an RG32UI target, cheap enough that overlapping foliage costs little. The resolve
+// then shades every pixel once: it fetches the triangle's vertices from the geometry buffers, rebuilds the
+// attributes and their derivatives from barycentrics and runs the same shading as the forward shaders.
+// Everything else (scene objects, static batches, the sky) is still drawn forward on top.
+class VisibilityBuffer {
+public:
+    static constexpr GLenum FORMAT = GL_RG32UI; // x: triangle, y: kind and instance
+    static constexpr int MAX_VEGETATION_MESHES = 4; // must match visibility_resolve.frag
+
+    // Must match visibility_resolve.frag, after the sky LUTs
+    static constexpr GLuint VEGETATION_DIFFUSE_UNIT = 17; // one per mesh
+    static constexpr GLuint VEGETATION_NORMAL_UNIT = 21;
+    static constexpr GLuint VEGETATION_ARM_UNIT = 25;
+    static constexpr GLuint VISIBILITY_UNIT = 29;
+    static constexpr GLuint DEPTH_UNIT = 30;
+
+    // Storage buffers, after the clustered lighting's
+    static constexpr GLuint TERRAIN_VERTICES_BINDING = 8;
+    static constexpr GLuint TERRAIN_INDICES_BINDING = 9;
+    static constexpr GLuint VEGETATION_VERTICES_BINDING = 10;
+    static constexpr GLuint VEGETATION_INDICES_BINDING = 11;
+    static constexpr GLuint VEGETATION_INSTANCES_BINDING = 12;
+
+    VisibilityBuffer() = default;
+    ~VisibilityBuffer();
+
+    VisibilityBuffer(const VisibilityBuffer&) = delete;
+    VisibilityBuffer& operator=(const VisibilityBuffer&) = delete;
+
+    void initialize(); // loads the shaders and checks the GL limits the resolve needs
+
+    // Whether this frame can take the deferred path. Rebuilds the combined vegetation buffers when the trees'
+    // model changed. False with a warning on drivers or models the resolve can't handle.
+    [[nodiscard]] bool prepare(const InstancedModel* trees);
+
+    // Into the visibility and depth targets
+    void renderGeometry(Renderer& renderer, const Terrain& terrain, const InstancedModel* trees, bool culled) const;
+
+    // Shades every covered pixel into the bound colour target, the far plane is left to the sky
+    void resolve(const Terrain& terrain, const InstancedModel* trees, GLuint visibility, GLuint depth, bool culled) const;
+
+    [[nodiscard]] bool isSupported() const { return m_supported; }
+
+private:
+    void buildVegetationBuffers(const Model& model); // every mesh concatenated, for the resolve's vertex fetches
+
+    std::shared_ptr<Shader> m_terrainShader;
+    std::shared_ptr<Shader> m_vegetationShader;
+    std::shared_ptr<Shader> m_resolveShader;
+    VAO m_VAO; // empty, the fullscreen triangle is generated from gl_VertexID
+
+    bool m_supported = false;
+    bool m_warnedModel = false;
+
+    const Model* m_vegetationModel = nullptr; // what the combined buffers were built from
+    GLuint m_vegetationVertices = 0;
+    GLuint m_vegetationIndices = 0;
+    GLuint m_meshFirstIndex[MAX_VEGETATION_MESHES] = {};
+    GLuint m_meshBaseVertex[MAX_VEGETATION_MESHES] = {};
+    int m_meshCount = 0;
+};
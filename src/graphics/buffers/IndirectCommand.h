@@ -0,0 +1,12 @@
+#pragma once
+#include <glad/glad.h>
+
+// Layout of one glDrawElementsIndirect / glMultiDrawElementsIndirect command.
+// Matches the DrawCommand struct in the culling compute shaders.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
@@ -1,5 +1,7 @@
 #include "InstanceBuffer.h"
 
+#include <algorithm>
+
 InstanceBuffer::InstanceBuffer() : m_bufferID(0) { }
 
 InstanceBuffer::~InstanceBuffer() {
@@ -16,17 +18,59 @@ void InstanceBuffer::generate() {
 
 void InstanceBuffer::addData(const glm::mat4& matrix) { // set the model matrix for an instance. Position, rotation, scale combined.
     m_data.push_back(matrix);
+    markDirty(getCount() - 1);
+}
+
+void InstanceBuffer::updateData(const GLsizei index, const glm::mat4& matrix) {
+    m_data[index] = matrix;
+    markDirty(index);
+}
+
+void InstanceBuffer::removeData(const GLsizei index) {
+    m_data[index] = m_data.back();
+    m_data.pop_back();
+
+    if (index < getCount()) {
+        markDirty(index);
+    }
+    m_dirtyEnd = std::min(m_dirtyEnd, getCount());
+}
+
+void InstanceBuffer::markDirty(const GLsizei index) {
+    if (m_dirtyBegin >= m_dirtyEnd) {
+        m_dirtyBegin = index;
+        m_dirtyEnd = index + 1;
+    } else {
+        m_dirtyBegin = std::min(m_dirtyBegin, index);
+        m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+    }
 }
 
-void InstanceBuffer::setData() const {
+void InstanceBuffer::setData() {
     if (m_data.empty() || m_bufferID == 0) return;
 
-    glNamedBufferStorage(
-        m_bufferID,
-        m_data.size() * sizeof(glm::mat4),
-        m_data.data(),
-        GL_DYNAMIC_STORAGE_BIT
-    );
+    if (getCount() > m_capacity) {
+        // Grow geometrically so adding objects one by one doesn't reallocate every time
+        m_capacity = std::max(getCount(), m_capacity * 2);
+
+        glDeleteBuffers(1, &m_bufferID);
+        glCreateBuffers(1, &m_bufferID);
+        glNamedBufferStorage(m_bufferID, m_capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+        m_dirtyBegin = 0;
+        m_dirtyEnd = getCount();
+    }
+
+    if (m_dirtyBegin < m_dirtyEnd) {
+        glNamedBufferSubData(
+            m_bufferID,
+            m_dirtyBegin * sizeof(glm::mat4),
+            (m_dirtyEnd - m_dirtyBegin) * sizeof(glm::mat4),
+            &m_data[m_dirtyBegin]
+        );
+    }
+
+    m_dirtyBegin = m_dirtyEnd = 0;
 }
 
 GLuint InstanceBuffer::getID() const {
@@ -35,4 +79,4 @@ GLuint InstanceBuffer::getID() const {
 
 GLsizei InstanceBuffer::getCount() const {
     return static_cast<GLsizei>(m_data.size());
-}
\ No newline at end of file
+}
@@ -11,13 +11,25 @@ public:
     void generate();
 
     void addData(const glm::mat4& matrix);
+    void updateData(GLsizei index, const glm::mat4& matrix);
+    void removeData(GLsizei index); // moves the last matrix into the freed slot
 
-    void setData() const;
+    // Uploads the matrices changed since the last call. Storage is immutable, so when the count outgrows the
+    // capacity a new, larger buffer replaces the old one and getID() changes.
+    void setData();
 
     [[nodiscard]] GLuint getID() const;
     [[nodiscard]] GLsizei getCount() const;
+    [[nodiscard]] GLsizei getCapacity() const { return m_capacity; }
 
 private:
+    void markDirty(GLsizei index);
+
     GLuint m_bufferID;
+    GLsizei m_capacity = 0;
     std::vector<glm::mat4> m_data;
-};
\ No newline at end of file
+
+    // Range of matrices to upload, empty when dirtyBegin >= dirtyEnd
+    GLsizei m_dirtyBegin = 0;
+    GLsizei m_dirtyEnd = 0;
+};
@@ -0,0 +1,88 @@
+#include "StreamingBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+StreamingBuffer::~StreamingBuffer() {
+    release();
+}
+
+void StreamingBuffer::release() {
+    for (GLsync& fence : m_fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_bufferID != 0) {
+        glUnmapNamedBuffer(m_bufferID);
+        glDeleteBuffers(1, &m_bufferID);
+    }
+    m_bufferID = 0;
+    m_mapped = nullptr;
+    m_region = REGIONS - 1;
+    m_head = 0;
+}
+
+void StreamingBuffer::generate(const GLsizeiptr regionSize) {
+    if (m_bufferID != 0) return;
+
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniformAlignment);
+
+    // Regions start aligned so offsets inside them only need aligning relative to the region
+    m_regionSize = (regionSize + m_uniformAlignment - 1) / m_uniformAlignment * m_uniformAlignment;
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_bufferID);
+    glNamedBufferStorage(m_bufferID, m_regionSize * REGIONS, nullptr, flags);
+    m_mapped = static_cast<char*>(glMapNamedBufferRange(m_bufferID, 0, m_regionSize * REGIONS, flags));
+
+    if (!m_mapped) {
+        std::cerr << "ERROR::STREAMING_BUFFER:: Persistent mapping failed" << std::endl;
+    }
+}
+
+void StreamingBuffer::beginFrame() {
+    m_region = (m_region + 1) % REGIONS;
+    m_head = 0;
+
+    GLsync& fence = m_fences[m_region];
+    if (!fence) return;
+
+    // Usually signalled long ago, only waits if the CPU is REGIONS frames ahead of the GPU
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        m_stalls++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 ms
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamingBuffer::endFrame() {
+    if (m_fences[m_region]) glDeleteSync(m_fences[m_region]);
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamingBuffer::Allocation StreamingBuffer::allocate(const GLsizeiptr size, GLsizeiptr alignment) {
+    if (alignment == 0) alignment = m_uniformAlignment;
+
+    const GLsizeiptr start = (m_head + alignment - 1) / alignment * alignment;
+    if (!m_mapped || start + size > m_regionSize) {
+        return {};
+    }
+
+    m_head = start + size;
+
+    const GLintptr offset = m_region * m_regionSize + start;
+    return {m_mapped + offset, offset, size};
+}
+
+GLintptr StreamingBuffer::write(const void* data, const GLsizeiptr size, const GLsizeiptr alignment) {
+    const Allocation allocation = allocate(size, alignment);
+    if (!allocation.data) return -1;
+
+    std::memcpy(allocation.data, data, size);
+    return allocation.offset;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <glad/glad.h>
+
+// Ring buffer for data written by the CPU every frame (per-draw uniforms, culled instances, particles, ...).
+// The storage is persistently and coherently mapped and split into REGIONS regions, one per frame in flight.
+// Each frame writes into its own region, endFrame() fences it, and beginFrame() only waits when the GPU is still
+// reading the region it is about to reuse. Nothing is copied by the driver and no implicit sync happens.
+//
+//   buffer.beginFrame();
+//   const auto alloc = buffer.allocate(sizeof(DrawData));
+//   memcpy(alloc.data, &drawData, sizeof(DrawData));
+//   glBindBufferRange(GL_UNIFORM_BUFFER, 1, buffer.getID(), alloc.offset, sizeof(DrawData));
+//   ...
+//   buffer.endFrame();
+class StreamingBuffer {
+public:
+    static constexpr int REGIONS = 3;
+
+    struct Allocation {
+        void* data = nullptr; // null when the region is full
+        GLintptr offset = 0;  // into the whole buffer, for glBindBufferRange / glVertexArrayVertexBuffer
+        GLsizeiptr size = 0;
+    };
+
+    StreamingBuffer() = default;
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    void generate(GLsizeiptr regionSize); // bytes available per frame
+    void release(); // needs the context, for owners that outlive it
+
+    void beginFrame();
+    void endFrame();
+
+    // alignment 0 uses GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so every allocation can be bound as a UBO range
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 0);
+    GLintptr write(const void* data, GLsizeiptr size, GLsizeiptr alignment = 0); // -1 when the region is full
+
+    [[nodiscard]] GLuint getID() const { return m_bufferID; }
+    [[nodiscard]] GLsizeiptr getRegionSize() const { return m_regionSize; }
+    [[nodiscard]] GLsizeiptr getBytesUsed() const { return m_head; } // in the current region
+    [[nodiscard]] int getStallCount() const { return m_stalls; } // frames that had to wait for the GPU
+
+private:
+    GLuint m_bufferID = 0;
+    char* m_mapped = nullptr;
+    GLsizeiptr m_regionSize = 0;
+    GLint m_uniformAlignment = 256;
+
+    GLsync m_fences[REGIONS] = {};
+    int m_region = REGIONS - 1; // the first beginFrame moves to region 0
+    GLsizeiptr m_head = 0;
+    int m_stalls = 0;
+};
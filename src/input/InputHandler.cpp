@@ -31,6 +31,14 @@ void InputHandler::handleKeyInput(const int key, int scancode, const int action,
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
         m_shouldReload = true;
     }
+
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        m_shouldToggleCapture = true;
+    }
+
+    if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
+        m_shouldToggleRecording = true;
+    }
 }
 
 void InputHandler::toggleWireframeMode() {
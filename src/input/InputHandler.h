@@ -10,6 +10,10 @@ public:
     [[nodiscard]] bool isNormalMappingEnabled() const { return m_normalMapping; }
     [[nodiscard]] bool shouldReloadShaders() const { return m_shouldReload; }
     void resetReloadFlag() { m_shouldReload = false; }
+    [[nodiscard]] bool shouldToggleCapture() const { return m_shouldToggleCapture; }
+    void resetCaptureFlag() { m_shouldToggleCapture = false; }
+    [[nodiscard]] bool shouldToggleRecording() const { return m_shouldToggleRecording; }
+    void resetRecordingFlag() { m_shouldToggleRecording = false; }
     void toggleCursorVisibility();
 
 private:
@@ -19,4 +23,6 @@ private:
     bool m_normalMapping;
     bool m_cursorLocked = true;
     bool m_shouldReload = false;
+    bool m_shouldToggleCapture = false; // F9 starts/stops a CPU profile capture
+    bool m_shouldToggleRecording = false; // F8 starts/stops recording a camera path
 };
@@ -1,9 +1,91 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
 #include "core/Engine.h"
 
-int main() {
-    if (const auto engine = std::make_unique<Engine>(); engine->initialize(1280, 960, "Scilla Engine")) {
-        engine->run();
+static void printUsage() {
+    std::cerr << "Usage: scilla [options]\n"
+                 "  --width N, --height N   framebuffer size (default 1280x960)\n"
+                 "  --trace-frames N        capture a CPU profile of startup and the first N frames\n"
+                 "  --trace-out path        trace file (default scilla_trace.json)\n"
+                 "  --benchmark             headless run along a scripted camera path, vsync off\n"
+                 "  --frames N              measured benchmark frames (default 1000)\n"
+                 "  --warmup N              benchmark frames run before measuring (default 60)\n"
+                 "  --benchmark-out path    results file (default benchmark.json)\n"
+                 "  --camera-path path      fly a recorded camera path with a fixed time step (also as benchmark path)\n"
+                 "  --record-out path       camera path file written by F8 recording (default camera_path.txt)\n"
+                 "  --frame-log path        per-frame times of a benchmark or playback as CSV\n"
+                 "  --lights N              animated point lights (default 256)\n"
+                 "  --visibility-buffer     shade terrain and trees from a visibility buffer instead of forward\n"
+                 "  --mesh-stats            print vertex cache and fetch statistics of imported meshes\n"
+                 "  --microbench name       headless subsystem benchmark: streaming, culling, models\n"
+                 "  --microbench-out path   results file (default microbench.json)" << std::endl;
+}
+
+static bool parseArguments(const int argc, char** argv, EngineOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        const auto is = [&](const char* name) { return std::strcmp(argv[i], name) == 0; };
+
+        if (is("--benchmark")) {
+            options.benchmark = true;
+        } else if (is("--width") && hasValue) {
+            options.width = std::atoi(argv[++i]);
+        } else if (is("--height") && hasValue) {
+            options.height = std::atoi(argv[++i]);
+        } else if (is("--trace-frames") && hasValue) {
+            options.traceFrames = std::atoi(argv[++i]);
+        } else if (is("--trace-out") && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (is("--frames") && hasValue) {
+            options.benchmarkFrames = std::atoi(argv[++i]);
+        } else if (is("--warmup") && hasValue) {
+            options.warmupFrames = std::atoi(argv[++i]);
+        } else if (is("--benchmark-out") && hasValue) {
+            options.benchmarkPath = argv[++i];
+        } else if (is("--camera-path") && hasValue) {
+            options.cameraPath = argv[++i];
+        } else if (is("--record-out") && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (is("--frame-log") && hasValue) {
+            options.frameLogPath = argv[++i];
+        } else if (is("--lights") && hasValue) {
+            options.pointLights = std::atoi(argv[++i]);
+        } else if (is("--visibility-buffer")) {
+            options.visibilityBuffer = true;
+        } else if (is("--mesh-stats")) {
+            options.meshStats = true;
+        } else if (is("--microbench") && hasValue) {
+            options.microbench = argv[++i];
+        } else if (is("--microbench-out") && hasValue) {
+            options.microbenchPath = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << argv[i] << std::endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    if (options.width <= 0 || options.height <= 0 || options.benchmarkFrames <= 0 || options.warmupFrames < 0
+        || options.pointLights < 0) {
+        std::cerr << "Sizes and frame counts must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(const int argc, char** argv) {
+    EngineOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    // Non-zero when anything failed, so automated benchmark runs can tell a broken run from a good one
+    bool succeeded = false;
+    if (const auto engine = std::make_unique<Engine>(); engine->initialize(options.width, options.height, "Scilla Engine", options)) {
+        succeeded = engine->run();
     }
     Engine::shutdown();
-    return 0;
-}
\ No newline at end of file
+    return succeeded ? 0 : 1;
+}
@@ -2,13 +2,12 @@
 
 #include <iostream>
 #include <ostream>
-#include <GLFW/glfw3.h>
 
-FrameTimer::FrameTimer() : m_lastTime(glfwGetTime()), m_frameCount(0), m_deltaTime(0.0f) { }
+FrameTimer::FrameTimer() : m_lastTime(std::chrono::steady_clock::now()), m_frameCount(0), m_deltaTime(0.0f) { }
 
 void FrameTimer::update() {
-    const double currentTime = glfwGetTime();
-    m_deltaTime = static_cast<float>(currentTime - m_lastTime);
+    const auto currentTime = std::chrono::steady_clock::now();
+    m_deltaTime = std::chrono::duration<float>(currentTime - m_lastTime).count();
     m_lastTime = currentTime;
     m_frameCount++;
 
@@ -1,12 +1,13 @@
 #pragma once
+#include <chrono>
 
 class FrameTimer {
 private:
-    double m_lastTime;
+    std::chrono::steady_clock::time_point m_lastTime; // independent of GLFW, the benchmark runs without it
     int m_frameCount;
     float m_deltaTime;
 public:
     FrameTimer();
     void update();
     [[nodiscard]] float getDeltaTime() const;
-};
\ No newline at end of file
+};
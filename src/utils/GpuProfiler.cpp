@@ -0,0 +1,249 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+#include "imgui.h"
+
+GpuProfiler::~GpuProfiler() {
+    for (auto& slot : m_slots) {
+        if (!slot.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        }
+    }
+}
+
+void GpuProfiler::initialize() {
+    // Drivers without usable timestamps report 0 counter bits
+    GLint counterBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+    m_supported = counterBits > 0;
+
+    if (!m_supported) {
+        std::cerr << "WARNING::GPU_PROFILER:: GL_TIMESTAMP queries not supported, GPU timings disabled" << std::endl;
+    }
+
+    m_frameGpuHistory.assign(HISTORY_SIZE, 0.0f);
+}
+
+void GpuProfiler::beginFrame() {
+    m_currentSlot = (m_currentSlot + 1) % RING_FRAMES;
+
+    FrameSlot& slot = m_slots[m_currentSlot];
+    collect(slot); // recorded RING_FRAMES frames ago
+
+    slot.usedQueries = 0;
+    slot.zones.clear();
+    slot.recorded = false;
+}
+
+void GpuProfiler::endFrame() {
+    if (m_zoneOpen) endZone();
+    m_slots[m_currentSlot].recorded = m_supported && m_enabled && !m_slots[m_currentSlot].zones.empty();
+}
+
+void GpuProfiler::beginZone(const std::string& name) {
+    if (!m_supported || !m_enabled) return;
+    if (m_zoneOpen) endZone(); // zones don't nest, the frame graph runs passes back to back
+
+    FrameSlot& slot = m_slots[m_currentSlot];
+    m_openZone = {getZoneIndex(name), acquireQuery(slot), -1, 0.0f};
+    glQueryCounter(slot.queries[m_openZone.startQuery], GL_TIMESTAMP);
+
+    m_zoneCpuStart = std::chrono::steady_clock::now();
+    m_zoneOpen = true;
+}
+
+void GpuProfiler::endZone() {
+    if (!m_zoneOpen) return;
+
+    FrameSlot& slot = m_slots[m_currentSlot];
+    m_openZone.cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_zoneCpuStart).count();
+    m_openZone.endQuery = acquireQuery(slot);
+    glQueryCounter(slot.queries[m_openZone.endQuery], GL_TIMESTAMP);
+
+    slot.zones.push_back(m_openZone);
+    m_zoneOpen = false;
+}
+
+void GpuProfiler::flush() {
+    if (m_zoneOpen) endZone();
+    glFinish();
+
+    // Oldest slot first, the current one last
+    for (int i = 1; i <= RING_FRAMES; i++) {
+        FrameSlot& slot = m_slots[(m_currentSlot + i) % RING_FRAMES];
+        if (i == RING_FRAMES) {
+            slot.recorded = m_supported && m_enabled && !slot.zones.empty();
+        }
+        collect(slot);
+        slot.recorded = false;
+    }
+}
+
+void GpuProfiler::resetTotals() {
+    for (auto& zone : m_zones) {
+        zone.gpuTotal = 0.0;
+        zone.cpuTotal = 0.0;
+    }
+    m_frameGpuTotal = 0.0;
+    m_totalFrames = 0;
+}
+
+int GpuProfiler::acquireQuery(FrameSlot& slot) {
+    if (slot.usedQueries == static_cast<int>(slot.queries.size())) {
+        GLuint query = 0;
+        glCreateQueries(GL_TIMESTAMP, 1, &query);
+        slot.queries.push_back(query);
+    }
+    return slot.usedQueries++;
+}
+
+size_t GpuProfiler::getZoneIndex(const std::string& name) {
+    if (const auto it = m_zoneLookup.find(name); it != m_zoneLookup.end()) {
+        return it->second;
+    }
+
+    ZoneStats zone;
+    zone.name = name;
+    zone.gpuHistory.assign(HISTORY_SIZE, 0.0f);
+    zone.cpuHistory.assign(HISTORY_SIZE, 0.0f);
+
+    m_zones.push_back(std::move(zone));
+    m_zoneLookup[name] = m_zones.size() - 1;
+    return m_zones.size() - 1;
+}
+
+void GpuProfiler::collect(FrameSlot& slot) {
+    if (!slot.recorded) return;
+
+    // Queries complete in order, if the last one is done all of them are
+    GLint available = 0;
+    glGetQueryObjectiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        m_droppedFrames++;
+        return;
+    }
+
+    std::vector<GLuint64> timestamps(slot.usedQueries);
+    for (int i = 0; i < slot.usedQueries; i++) {
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+    }
+
+    // Zones that didn't run this frame (e.g. a disabled pass) record 0 ms
+    std::vector<float> gpuMs(m_zones.size(), 0.0f);
+    std::vector<float> cpuMs(m_zones.size(), 0.0f);
+    for (const auto& zone : slot.zones) {
+        gpuMs[zone.zone] += static_cast<float>(timestamps[zone.endQuery] - timestamps[zone.startQuery]) * 1e-6f;
+        cpuMs[zone.zone] += zone.cpuMs;
+    }
+
+    const GLuint64 frameStart = timestamps[slot.zones.front().startQuery];
+    const GLuint64 frameEnd = timestamps[slot.zones.back().endQuery];
+    m_frameGpuLast = static_cast<float>(frameEnd - frameStart) * 1e-6f;
+    m_frameGpuHistory[m_historyIndex] = m_frameGpuLast;
+
+    m_recordedFrames++;
+    const int window = std::min(m_recordedFrames, HISTORY_SIZE);
+    const auto average = [window](const std::vector<float>& history) {
+        return std::accumulate(history.begin(), history.end(), 0.0f) / static_cast<float>(window);
+    };
+
+    for (size_t i = 0; i < m_zones.size(); i++) {
+        ZoneStats& zone = m_zones[i];
+        zone.gpuHistory[m_historyIndex] = gpuMs[i];
+        zone.cpuHistory[m_historyIndex] = cpuMs[i];
+        zone.gpuLast = gpuMs[i];
+        zone.cpuLast = cpuMs[i];
+        zone.gpuAverage = average(zone.gpuHistory);
+        zone.cpuAverage = average(zone.cpuHistory);
+        zone.gpuTotal += gpuMs[i];
+        zone.cpuTotal += cpuMs[i];
+    }
+    m_frameGpuAverage = average(m_frameGpuHistory);
+    m_frameGpuTotal += m_frameGpuHistory[m_historyIndex];
+    m_totalFrames++;
+
+    m_historyIndex = (m_historyIndex + 1) % HISTORY_SIZE;
+}
+
+void GpuProfiler::imGui() {
+    ImGui::Begin("GPU Profiler");
+
+    if (!m_supported) {
+        ImGui::Text("GL_TIMESTAMP queries are not supported by this driver");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Enabled", &m_enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump CSV")) {
+        dumpCsv("gpu_profile.csv");
+    }
+
+    ImGui::Text("GPU frame: %.3f ms (avg over %d frames), dropped readbacks: %d",
+                m_frameGpuAverage, std::min(m_recordedFrames, HISTORY_SIZE), m_droppedFrames);
+
+    if (ImGui::BeginTable("zones", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("GPU avg");
+        ImGui::TableSetupColumn("GPU last");
+        ImGui::TableSetupColumn("CPU avg");
+        ImGui::TableSetupColumn("GPU history", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (const auto& zone : m_zones) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(zone.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", zone.gpuAverage);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", zone.gpuLast);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", zone.cpuAverage);
+            ImGui::TableNextColumn();
+            ImGui::PushID(zone.name.c_str());
+            ImGui::PlotLines("##gpu", zone.gpuHistory.data(), HISTORY_SIZE, m_historyIndex,
+                             nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, 20.0f));
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+bool GpuProfiler::dumpCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::GPU_PROFILER:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "frame,frame_gpu_ms";
+    for (const auto& zone : m_zones) {
+        file << "," << zone.name << "_gpu_ms," << zone.name << "_cpu_ms";
+    }
+    file << "\n";
+
+    // Oldest sample first
+    const int count = std::min(m_recordedFrames, HISTORY_SIZE);
+    for (int row = 0; row < count; row++) {
+        const int index = (m_historyIndex - count + row + HISTORY_SIZE) % HISTORY_SIZE;
+
+        file << (m_recordedFrames - count + row) << "," << m_frameGpuHistory[index];
+        for (const auto& zone : m_zones) {
+            file << "," << zone.gpuHistory[index] << "," << zone.cpuHistory[index];
+        }
+        file << "\n";
+    }
+
+    std::cout << "GPU profile written to " << path << " (" << count << " frames)" << std::endl;
+    return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+// Per-pass GPU timings from GL_TIMESTAMP query pairs, plus the CPU time spent recording each pass.
+// Queries go into a ring of frame slots, a slot is only read back when it comes around again (RING_FRAMES later),
+// and only if its results are already available, so the profiler never stalls the pipeline.
+// Works on any driver exposing ARB_timer_query, including Mesa llvmpipe.
+class GpuProfiler {
+public:
+    struct ZoneStats {
+        std::string name;
+        std::vector<float> gpuHistory; // ms, ring of HISTORY_SIZE samples
+        std::vector<float> cpuHistory;
+        float gpuAverage = 0.0f; // average over the history window
+        float cpuAverage = 0.0f;
+        float gpuLast = 0.0f;
+        float cpuLast = 0.0f;
+        double gpuTotal = 0.0; // sums since the last resetTotals(), for whole-run averages
+        double cpuTotal = 0.0;
+    };
+
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void initialize();
+
+    void beginFrame(); // collects the oldest slot and starts recording into it
+    void endFrame();
+
+    void beginZone(const std::string& name);
+    void endZone();
+
+    void flush(); // waits for the GPU and collects every pending frame
+    void resetTotals();
+
+    void imGui();
+    bool dumpCsv(const std::string& path) const; // one row per recorded frame, one column per zone
+
+    [[nodiscard]] bool isSupported() const { return m_supported; }
+    [[nodiscard]] const std::vector<ZoneStats>& getZones() const { return m_zones; }
+    [[nodiscard]] float getFrameGpuAverage() const { return m_frameGpuAverage; }
+    [[nodiscard]] float getFrameGpuLast() const { return m_frameGpuLast; } // newest collected frame, RING_FRAMES old
+    [[nodiscard]] int getRecordedFrames() const { return m_recordedFrames; } // changes when a new frame was collected
+    [[nodiscard]] int getDroppedFrames() const { return m_droppedFrames; }
+    [[nodiscard]] int getTotalFrames() const { return m_totalFrames; }
+    [[nodiscard]] double getFrameGpuTotal() const { return m_frameGpuTotal; }
+
+private:
+    static constexpr int RING_FRAMES = 4;
+    static constexpr int HISTORY_SIZE = 240;
+
+    struct PendingZone {
+        size_t zone; // index into m_zones
+        int startQuery;
+        int endQuery;
+        float cpuMs;
+    };
+
+    struct FrameSlot {
+        std::vector<GLuint> queries; // grows on demand, reused every time the slot comes around
+        int usedQueries = 0;
+        std::vector<PendingZone> zones;
+        bool recorded = false;
+    };
+
+    int acquireQuery(FrameSlot& slot);
+    void collect(FrameSlot& slot);
+    size_t getZoneIndex(const std::string& name);
+
+    bool m_supported = false;
+    bool m_enabled = true;
+
+    FrameSlot m_slots[RING_FRAMES];
+    int m_currentSlot = 0;
+
+    std::vector<ZoneStats> m_zones; // in first-seen order, which is pass order
+    std::unordered_map<std::string, size_t> m_zoneLookup;
+
+    bool m_zoneOpen = false;
+    PendingZone m_openZone{};
+    std::chrono::steady_clock::time_point m_zoneCpuStart;
+
+    std::vector<float> m_frameGpuHistory;
+    float m_frameGpuAverage = 0.0f;
+    float m_frameGpuLast = 0.0f;
+    int m_historyIndex = 0; // shared write position of all history rings
+    int m_recordedFrames = 0;
+    int m_droppedFrames = 0; // results that weren't ready when their slot was reused
+
+    int m_totalFrames = 0; // frames collected since resetTotals()
+    double m_frameGpuTotal = 0.0;
+};
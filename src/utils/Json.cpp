@@ -0,0 +1,213 @@
+#include "Json.h"
+
+#include <charconv>
+#include <cstdint>
+
+namespace {
+    constexpr int MAX_DEPTH = 256; // deeper documents are rejected rather than overflowing the stack
+
+    const JsonValue& nullValue() {
+        static const JsonValue value;
+        return value;
+    }
+
+    void appendUtf8(std::string& out, const uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | codePoint >> 6);
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | codePoint >> 12);
+            out += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | codePoint >> 18);
+            out += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+// Recursive descent over the text, fills JsonValue's private members
+class JsonParser {
+public:
+    explicit JsonParser(const std::string_view text) : m_text(text) {}
+
+    bool parseDocument(JsonValue& out) {
+        if (!parseValue(out, 0)) return false;
+        skipWhitespace();
+        return m_pos == m_text.size() || fail("trailing characters");
+    }
+
+    [[nodiscard]] std::string getError() const { return m_error + " at offset " + std::to_string(m_pos); }
+
+private:
+    std::string_view m_text;
+    size_t m_pos = 0;
+    std::string m_error;
+
+    bool fail(const char* message) {
+        if (m_error.empty()) m_error = message;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r')) {
+            m_pos++;
+        }
+    }
+
+    bool consume(const char c) {
+        skipWhitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(const std::string_view word) {
+        if (m_text.substr(m_pos, word.size()) != word) return fail("invalid literal");
+        m_pos += word.size();
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, const int depth) {
+        if (depth > MAX_DEPTH) return fail("nesting too deep");
+        skipWhitespace();
+        if (m_pos == m_text.size()) return fail("unexpected end");
+
+        switch (m_text[m_pos]) {
+            case '{': return parseObject(out, depth);
+            case '[': return parseArray(out, depth);
+            case '"':
+                out.m_type = JsonValue::Type::String;
+                return parseString(out.m_string);
+            case 't':
+                out.m_type = JsonValue::Type::Bool;
+                out.m_bool = true;
+                return literal("true");
+            case 'f':
+                out.m_type = JsonValue::Type::Bool;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(JsonValue& out, const int depth) {
+        out.m_type = JsonValue::Type::Object;
+        m_pos++; // '{'
+        if (consume('}')) return true;
+
+        do {
+            skipWhitespace();
+            std::string key;
+            if (m_pos == m_text.size() || m_text[m_pos] != '"') return fail("expected a key");
+            if (!parseString(key)) return false;
+            if (!consume(':')) return fail("expected ':'");
+
+            out.m_keys.push_back(std::move(key));
+            out.m_elements.emplace_back();
+            if (!parseValue(out.m_elements.back(), depth + 1)) return false;
+        } while (consume(','));
+
+        return consume('}') || fail("expected ',' or '}'");
+    }
+
+    bool parseArray(JsonValue& out, const int depth) {
+        out.m_type = JsonValue::Type::Array;
+        m_pos++; // '['
+        if (consume(']')) return true;
+
+        do {
+            out.m_elements.emplace_back();
+            if (!parseValue(out.m_elements.back(), depth + 1)) return false;
+        } while (consume(','));
+
+        return consume(']') || fail("expected ',' or ']'");
+    }
+
+    bool parseHex4(uint32_t& value) {
+        if (m_pos + 4 > m_text.size()) return fail("truncated \\u escape");
+        const auto [end, error] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + 4, value, 16);
+        if (error != std::errc() || end != m_text.data() + m_pos + 4) return fail("invalid \\u escape");
+        m_pos += 4;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        m_pos++; // '"'
+        while (m_pos < m_text.size()) {
+            const char c = m_text[m_pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (m_pos == m_text.size()) break;
+            switch (m_text[m_pos++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t codePoint = 0;
+                    if (!parseHex4(codePoint)) return false;
+                    // Characters outside the BMP come as a surrogate pair
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && m_text.substr(m_pos, 2) == "\\u") {
+                        m_pos += 2;
+                        uint32_t low = 0;
+                        if (!parseHex4(low)) return false;
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(JsonValue& out) {
+        out.m_type = JsonValue::Type::Number;
+        const auto [end, error] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_text.size(), out.m_number);
+        if (error != std::errc()) return fail("invalid value");
+        m_pos = end - m_text.data();
+        return true;
+    }
+};
+
+std::optional<JsonValue> JsonValue::parse(const std::string_view text, std::string& error) {
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parseDocument(root)) {
+        error = parser.getError();
+        return std::nullopt;
+    }
+    return root;
+}
+
+const JsonValue& JsonValue::operator[](const std::string_view key) const {
+    if (m_type != Type::Object) return nullValue();
+    for (size_t i = 0; i < m_keys.size(); i++) {
+        if (m_keys[i] == key) return m_elements[i];
+    }
+    return nullValue();
+}
+
+const JsonValue& JsonValue::operator[](const size_t index) const {
+    if (m_type != Type::Array || index >= m_elements.size()) return nullValue();
+    return m_elements[index];
+}
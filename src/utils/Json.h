@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal JSON reader for asset descriptions (glTF). The whole document is parsed into a tree of values, numbers are
+// doubles and objects keep their members in file order. Lookups never throw: a missing key, an index out of range
+// or a type mismatch yields a null value, so chains like doc["meshes"][0]["name"].asString() are safe.
+// There is no writer, the engine writes its few JSON files by hand.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    // Empty on malformed input, error then says what and where
+    static std::optional<JsonValue> parse(std::string_view text, std::string& error);
+
+    [[nodiscard]] Type getType() const { return m_type; }
+    [[nodiscard]] bool isNull() const { return m_type == Type::Null; }
+    [[nodiscard]] bool isNumber() const { return m_type == Type::Number; }
+    [[nodiscard]] bool isString() const { return m_type == Type::String; }
+    [[nodiscard]] bool isArray() const { return m_type == Type::Array; }
+    [[nodiscard]] bool isObject() const { return m_type == Type::Object; }
+
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue& operator[](size_t index) const;
+    [[nodiscard]] bool contains(std::string_view key) const { return !(*this)[key].isNull(); }
+
+    [[nodiscard]] size_t size() const { return m_type == Type::Array || m_type == Type::Object ? m_elements.size() : 0; }
+    [[nodiscard]] const std::string& getKey(size_t index) const { return m_keys[index]; } // objects only
+
+    [[nodiscard]] double asNumber(double fallback = 0.0) const { return m_type == Type::Number ? m_number : fallback; }
+    [[nodiscard]] int asInt(const int fallback = 0) const { return m_type == Type::Number ? static_cast<int>(m_number) : fallback; }
+    [[nodiscard]] bool asBool(const bool fallback = false) const { return m_type == Type::Bool ? m_bool : fallback; }
+    [[nodiscard]] const std::string& asString() const { return m_string; } // empty unless a string
+
+private:
+    friend class JsonParser;
+
+    Type m_type = Type::Null;
+    bool m_bool = false;
+    double m_number = 0.0;
+    std::string m_string;
+    std::vector<JsonValue> m_elements; // array elements, or object values
+    std::vector<std::string> m_keys;   // object keys, parallel to m_elements
+};
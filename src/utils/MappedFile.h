@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are read in when the file is opened, so the first access to
+// the data doesn't fault on disk I/O (open on a worker thread, read on the main thread).
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path); // false if it doesn't exist, is empty or can't be mapped
+    void close();
+
+    [[nodiscard]] const unsigned char* getData() const { return m_data; }
+    [[nodiscard]] size_t getSize() const { return m_size; }
+    [[nodiscard]] bool isOpen() const { return m_data != nullptr; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+};
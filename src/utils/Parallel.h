@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+    inline int workerCount() {
+        // hardware_concurrency may return 0 when it cannot be determined
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Splits [begin, end) into contiguous chunks and calls fn(chunkBegin, chunkEnd) for each of them on worker threads.
+    // The calling thread processes the first chunk itself and blocks until every chunk is done.
+    // minChunk keeps tiny ranges from paying thread start-up costs for a handful of items.
+    template<typename Fn>
+    void forRange(const int begin, const int end, Fn&& fn, const int minChunk = 1) {
+        const int count = end - begin;
+        if (count <= 0) return;
+
+        const int workers = std::min(workerCount(), std::max(1, count / std::max(1, minChunk)));
+        if (workers == 1) {
+            fn(begin, end);
+            return;
+        }
+
+        const int chunk = (count + workers - 1) / workers;
+
+        std::vector<std::jthread> threads; // jthread joins on destruction
+        threads.reserve(workers - 1);
+
+        for (int w = 1; w < workers; w++) {
+            const int chunkBegin = begin + w * chunk;
+            const int chunkEnd = std::min(end, chunkBegin + chunk);
+            if (chunkBegin >= chunkEnd) break;
+
+            threads.emplace_back([&fn, chunkBegin, chunkEnd] { fn(chunkBegin, chunkEnd); });
+        }
+
+        fn(begin, std::min(end, begin + chunk));
+    }
+}
@@ -0,0 +1,199 @@
+#include "Profiler.h"
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    constexpr size_t RING_CAPACITY = 1 << 14; // events per thread, the oldest are overwritten
+
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // A ring entry guarded by a sequence number, so an exporter on another thread can copy it while the owning
+    // thread keeps recording: odd while being written, 2 * (index + 1) once event number `index` is complete.
+    // A copy is only kept if the sequence matched before and after it, i.e. the slot wasn't overwritten meanwhile.
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+
+        void write(const uint64_t index, const Event& event) {
+            sequence.store(2 * index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            name.store(event.name, std::memory_order_relaxed);
+            start.store(event.start, std::memory_order_relaxed);
+            end.store(event.end, std::memory_order_relaxed);
+            sequence.store(2 * index + 2, std::memory_order_release);
+        }
+
+        bool read(const uint64_t index, Event& event) const {
+            if (sequence.load(std::memory_order_acquire) != 2 * index + 2) return false;
+            event = {name.load(std::memory_order_relaxed), start.load(std::memory_order_relaxed),
+                     end.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence.load(std::memory_order_relaxed) == 2 * index + 2;
+        }
+    };
+
+    // Written only by its owning thread, read by the exporter through the slots' sequence numbers
+    struct ThreadBuffer {
+        std::array<Slot, RING_CAPACITY> events;
+        std::atomic<uint64_t> writeIndex{0};
+        int trackId = 0;
+    };
+
+    // Everything behind the mutex is only touched when a thread records its first zone, when it exits,
+    // and when a capture starts or ends.
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::vector<ThreadBuffer*> freeBuffers; // from exited threads, e.g. Parallel::forRange workers
+        std::map<int, std::string> trackNames;
+        std::unordered_set<std::string> names; // node based, so c_str() pointers stay valid
+        uint64_t captureStart = 0;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Returns the thread's buffer to the registry on exit, so short-lived workers don't grow it forever.
+    // Reusing buffers also keeps worker zones on a small, stable set of tracks.
+    struct ThreadState {
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadState() {
+            if (buffer) {
+                std::lock_guard lock(registry().mutex);
+                registry().freeBuffers.push_back(buffer);
+            }
+        }
+    };
+
+    thread_local ThreadState t_state;
+
+    ThreadBuffer& threadBuffer() {
+        if (!t_state.buffer) {
+            Registry& reg = registry();
+            std::lock_guard lock(reg.mutex);
+
+            if (!reg.freeBuffers.empty()) {
+                t_state.buffer = reg.freeBuffers.back();
+                reg.freeBuffers.pop_back();
+            } else {
+                reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+                t_state.buffer = reg.buffers.back().get();
+                t_state.buffer->trackId = static_cast<int>(reg.buffers.size());
+            }
+        }
+        return *t_state.buffer;
+    }
+
+    void writeEscaped(std::ostream& out, const std::string& text) {
+        for (const char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+    }
+}
+
+uint64_t Profiler::now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::beginCapture() {
+#if !SCILLA_PROFILING
+    std::cerr << "WARNING::PROFILER:: Built with SCILLA_PROFILING=OFF, the capture will be empty" << std::endl;
+#endif
+    registry().captureStart = now();
+    g_capturing.store(true, std::memory_order_relaxed);
+    std::cout << "CPU profile capture started" << std::endl;
+}
+
+bool Profiler::endCapture(const std::string& path) {
+    g_capturing.store(false, std::memory_order_relaxed);
+    const uint64_t captureEnd = now();
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::PROFILER:: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    Registry& reg = registry();
+    std::lock_guard lock(reg.mutex);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    size_t eventCount = 0;
+    for (const auto& buffer : reg.buffers) {
+        // Threads may still be recording (scopes that were open when the capture stopped, the texture workers),
+        // events overwritten during the export are skipped
+        const uint64_t written = buffer->writeIndex.load(std::memory_order_acquire);
+        const uint64_t begin = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+
+        for (uint64_t i = begin; i < written; i++) {
+            Event event{};
+            if (!buffer->events[i % RING_CAPACITY].read(i, event)) continue;
+            if (event.start < reg.captureStart || event.end > captureEnd) continue;
+
+            // Chrome trace timestamps are microseconds
+            file << (first ? "" : ",\n") << "{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->trackId
+                 << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0 << "}";
+            first = false;
+            eventCount++;
+        }
+    }
+
+    for (const auto& [trackId, name] : reg.trackNames) {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trackId
+             << ",\"args\":{\"name\":\"";
+        writeEscaped(file, name);
+        file << "\"}}";
+        first = false;
+    }
+
+    file << "\n]}\n";
+
+    std::cout << "CPU profile written to " << path << " (" << eventCount << " zones)" << std::endl;
+    return true;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    const int trackId = threadBuffer().trackId;
+
+    std::lock_guard lock(registry().mutex);
+    registry().trackNames[trackId] = name;
+}
+
+const char* Profiler::internName(const std::string& name) {
+    std::lock_guard lock(registry().mutex);
+    return registry().names.insert(name).first->c_str();
+}
+
+void Profiler::record(const char* name, const uint64_t start, const uint64_t end) {
+    ThreadBuffer& buffer = threadBuffer();
+
+    const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    buffer.events[index % RING_CAPACITY].write(index, {name, start, end});
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
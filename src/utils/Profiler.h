@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped CPU profiling zones, exported as Chrome trace / Perfetto JSON.
+//
+//   PROFILE_SCOPE("Terrain::generate");
+//   PROFILE_FUNCTION();
+//
+// Every thread records into its own ring buffer, recording takes no locks. While no capture is running a scope
+// costs a single relaxed atomic load. Configure with -DSCILLA_PROFILING=OFF to compile the macros out entirely.
+namespace Profiler {
+    // Nanoseconds since the profiler epoch (first use), steady clock
+    uint64_t now();
+
+    inline std::atomic<bool> g_capturing{false};
+
+    void beginCapture();
+    bool endCapture(const std::string& path); // stops recording and writes the captured zones
+    inline bool isCapturing() { return g_capturing.load(std::memory_order_relaxed); }
+
+    void setThreadName(const std::string& name); // shown as the track name in the trace viewer
+
+    // Returns a pointer that stays valid for the lifetime of the program, for zone names built at runtime
+    const char* internName(const std::string& name);
+
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    class Scope {
+    public:
+        explicit Scope(const char* name) {
+            if (isCapturing()) {
+                m_name = name;
+                m_start = now();
+            }
+        }
+
+        // Slow: interns the name under the profiler's global lock while capturing. For one-off zones only,
+        // per-frame zones should intern their names once and use the const char* constructor.
+        explicit Scope(const std::string& name) {
+            if (isCapturing()) {
+                m_name = internName(name);
+                m_start = now();
+            }
+        }
+
+        ~Scope() {
+            if (m_name) record(m_name, m_start, now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name = nullptr; // null when the scope started outside a capture
+        uint64_t m_start = 0;
+    };
+}
+
+#if SCILLA_PROFILING
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_SCOPE(name) const Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+    #define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+    #define PROFILE_FUNCTION() ((void)0)
+#endif
@@ -0,0 +1,76 @@
+#include "HeightFog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+void HeightFog::update(const glm::vec3& sunDirection) {
+    // Twilight while the sun is close to the horizon, blending into day above and night below
+    const float elevation = sunDirection.y;
+    const float day = glm::smoothstep(0.05f, 0.3f, elevation);
+    const float night = 1.0f - glm::smoothstep(-0.25f, -0.05f, elevation);
+    const float twilight = 1.0f - day - night;
+
+    const float weights[PERIOD_COUNT] = {day, twilight, night};
+    m_current = {0.0f, 0.0f};
+    for (int i = 0; i < PERIOD_COUNT; i++) {
+        m_current.density += m_periods[i].density * weights[i];
+        m_current.falloff += m_periods[i].falloff * weights[i];
+    }
+}
+
+// Integral of density * exp(-falloff * h) along a straight ray between the heights, divided by the ray's length
+float HeightFog::opticalDepthScale(const float fromHeight, const float toHeight) const {
+    const float start = m_current.density * std::exp(-m_current.falloff * fromHeight);
+    const float k = m_current.falloff * (toHeight - fromHeight);
+    const float integral = std::abs(k) > 1e-4f ? (1.0f - std::exp(-k)) / k : 1.0f - 0.5f * k;
+    return start * integral;
+}
+
+float HeightFog::getVisibilityDistance(const glm::vec3& cameraPos, const float topHeight) const {
+    if (!m_enabled || !m_adaptiveFarPlane) return MAX_FAR_PLANE;
+
+    // At any distance, the least fogged geometry is the highest that distance can reach. The optical depth towards
+    // it grows with the distance, so the first distance where it hides even that is found by bisection.
+    const float targetHeight = topHeight + m_geometryMargin;
+    const float cutoffDepth = -std::log(m_cutoffTransmittance);
+    const auto opticalDepth = [&](const float distance) {
+        const float endHeight = std::min(targetHeight, cameraPos.y + distance);
+        return distance * opticalDepthScale(cameraPos.y, endHeight);
+    };
+
+    if (opticalDepth(MAX_FAR_PLANE) < cutoffDepth) return MAX_FAR_PLANE;
+
+    float lo = MIN_FAR_PLANE;
+    float hi = MAX_FAR_PLANE;
+    for (int i = 0; i < 20; i++) {
+        const float mid = 0.5f * (lo + hi);
+        (opticalDepth(mid) < cutoffDepth ? lo : hi) = mid;
+    }
+    return hi;
+}
+
+glm::vec4 HeightFog::getShaderParams(const float farPlane) const {
+    return {m_enabled ? m_current.density : 0.0f, m_current.falloff, farPlane * FADE_START, farPlane};
+}
+
+void HeightFog::imGui(const float farPlane) {
+    if (!ImGui::TreeNode("Fog")) return;
+
+    ImGui::Checkbox("Height Fog", &m_enabled);
+    ImGui::Checkbox("Adaptive Far Plane", &m_adaptiveFarPlane);
+    ImGui::SliderFloat("Cutoff Transmittance", &m_cutoffTransmittance, 0.001f, 0.05f, "%.4f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("Geometry Margin (m)", &m_geometryMargin, 0.0f, 200.0f);
+
+    static constexpr const char* PERIOD_NAMES[PERIOD_COUNT] = {"Day", "Twilight", "Night"};
+    for (int i = 0; i < PERIOD_COUNT; i++) {
+        ImGui::PushID(i);
+        ImGui::Text("%s", PERIOD_NAMES[i]);
+        ImGui::SliderFloat("Density", &m_periods[i].density, 0.0f, 0.02f, "%.5f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Falloff", &m_periods[i].falloff, 0.001f, 0.05f, "%.4f", ImGuiSliderFlags_Logarithmic);
+        ImGui::PopID();
+    }
+
+    ImGui::Text("Far plane: %.0f m", farPlane);
+    ImGui::TreePop();
+}
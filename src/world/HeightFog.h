@@ -0,0 +1,47 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Exponential height fog, on top of the atmosphere's aerial perspective (atmosphere.glsl). Its density follows the
+// time of day, blended by the sun's elevation between settings for day, twilight and night.
+// The fog's optical depth along a ray has a closed form, so the distance beyond which it hides all geometry is
+// solved on the CPU and becomes the camera's far plane: culling and shadows stop there, and the depth buffer
+// gets its precision back. The shaders fade the last stretch before the far plane into the sky, so nothing pops.
+class HeightFog {
+public:
+    struct Settings {
+        float density; // extinction per metre at height 0
+        float falloff; // per metre of height, the density halves every ln(2) / falloff metres
+    };
+
+    enum Period { Day, Twilight, Night, PERIOD_COUNT };
+
+    static constexpr float MIN_FAR_PLANE = 300.0f;
+    static constexpr float MAX_FAR_PLANE = 4000.0f;
+    static constexpr float FADE_START = 0.85f; // of the far plane, where the fade into the sky begins
+
+    void update(const glm::vec3& sunDirection); // blends this time of day's settings
+
+    // Distance at which the fog hides everything up to topHeight seen from cameraPos, between the far plane limits.
+    // MAX_FAR_PLANE when the adaptive far plane is off.
+    [[nodiscard]] float getVisibilityDistance(const glm::vec3& cameraPos, float topHeight) const;
+
+    // x: density, y: falloff, z: fade start, w: far plane. FrameData::fog
+    [[nodiscard]] glm::vec4 getShaderParams(float farPlane) const;
+
+    void imGui(float farPlane); // shows the far plane it led to
+
+private:
+    [[nodiscard]] float opticalDepthScale(float fromHeight, float toHeight) const; // optical depth per metre of ray
+
+    Settings m_periods[PERIOD_COUNT] = {
+        {0.0015f, 0.008f},  // day: thin haze in the valleys
+        {0.0060f, 0.006f},  // twilight: morning and evening mist
+        {0.0040f, 0.007f},  // night
+    };
+    Settings m_current = m_periods[Day];
+
+    bool m_enabled = true;
+    bool m_adaptiveFarPlane = true;
+    float m_cutoffTransmittance = 1.0f / 255.0f; // what the far plane may hide
+    float m_geometryMargin = 50.0f; // metres above the terrain's highest point, for trees and objects
+};
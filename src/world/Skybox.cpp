@@ -1,79 +1,139 @@
+// Atmosphere model and LUTs after Hillaire, "A Scalable and Production Ready Sky and Atmosphere Rendering
+// Technique" (2020), single scattering only. Distances on the GPU are in kilometres, one world unit is a metre.
+
 #include "Skybox.h"
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
-#include <ostream>
-
-static constexpr float skyboxVertices[] = {
-    // Back face
-    -1.0f, 1.0f, -1.0f,
-    -1.0f, -1.0f, -1.0f,
-    1.0f, -1.0f, -1.0f,
-    1.0f, -1.0f, -1.0f,
-    1.0f, 1.0f, -1.0f,
-    -1.0f, 1.0f, -1.0f,
-
-    // Left face
-    -1.0f, -1.0f, 1.0f,
-    -1.0f, -1.0f, -1.0f,
-    -1.0f, 1.0f, -1.0f,
-    -1.0f, 1.0f, -1.0f,
-    -1.0f, 1.0f, 1.0f,
-    -1.0f, -1.0f, 1.0f,
-
-    // Right face
-    1.0f, -1.0f, -1.0f,
-    1.0f, -1.0f, 1.0f,
-    1.0f, 1.0f, 1.0f,
-    1.0f, 1.0f, 1.0f,
-    1.0f, 1.0f, -1.0f,
-    1.0f, -1.0f, -1.0f,
-
-    // Front face
-    -1.0f, -1.0f, 1.0f,
-    -1.0f, 1.0f, 1.0f,
-    1.0f, 1.0f, 1.0f,
-    1.0f, 1.0f, 1.0f,
-    1.0f, -1.0f, 1.0f,
-    -1.0f, -1.0f, 1.0f,
-
-    // Top face
-    -1.0f, 1.0f, -1.0f,
-    1.0f, 1.0f, -1.0f,
-    1.0f, 1.0f, 1.0f,
-    1.0f, 1.0f, 1.0f,
-    -1.0f, 1.0f, 1.0f,
-    -1.0f, 1.0f, -1.0f,
-
-    // Bottom face
-    -1.0f, -1.0f, -1.0f,
-    -1.0f, -1.0f, 1.0f,
-    1.0f, -1.0f, -1.0f,
-    1.0f, -1.0f, -1.0f,
-    -1.0f, -1.0f, 1.0f,
-    1.0f, -1.0f, 1.0f
-};
-
-Skybox::Skybox() {
+#include <imgui.h>
+
+#include "core/AssetManager.h"
+#include "utils/Profiler.h"
+
+namespace {
+    // Earth
+    constexpr float GROUND_RADIUS = 6360.0f;
+    constexpr float TOP_RADIUS = 6460.0f;
+    const glm::vec3 RAYLEIGH_SCATTERING(5.802e-3f, 13.558e-3f, 33.1e-3f);
+    constexpr float RAYLEIGH_SCALE_HEIGHT = 8.0f;
+    constexpr float MIE_SCATTERING = 3.996e-3f;
+    constexpr float MIE_EXTINCTION = 4.440e-3f;
+    constexpr float MIE_SCALE_HEIGHT = 1.2f;
+    constexpr float MIE_G = 0.8f;
+    const glm::vec3 OZONE_ABSORPTION(0.650e-3f, 1.881e-3f, 0.085e-3f);
+    constexpr float OZONE_PEAK_HEIGHT = 25.0f;
+
+    constexpr float MIN_CAMERA_HEIGHT = 1.0f; // metres, the LUT parameterizations break down at the ground
+
+    GLuint groupCount(const int items, const int groupSize) {
+        return static_cast<GLuint>((items + groupSize - 1) / groupSize);
+    }
+
+    GLuint createLut(const int width, const int height) {
+        GLuint texture = 0;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, 1, GL_RGBA16F, width, height);
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+}
+
+Skybox::Skybox() : m_params(PARAMS_BINDING, sizeof(AtmosphereData)) {
+    const std::string path = "assets/shaders/";
+    auto& assetManager = AssetManager::get();
+    m_transmittanceShader = assetManager.loadComputeShader(path + "sky_transmittance.comp");
+    m_skyViewShader = assetManager.loadComputeShader(path + "sky_view.comp");
+
+    m_transmittanceLut = createLut(TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT);
+    m_skyViewLut = createLut(SKY_VIEW_WIDTH, SKY_VIEW_HEIGHT);
+
     m_VAO.generate();
-    m_VBO.generate();
+}
+
+Skybox::~Skybox() {
+    if (m_transmittanceLut != 0) glDeleteTextures(1, &m_transmittanceLut);
+    if (m_skyViewLut != 0) glDeleteTextures(1, &m_skyViewLut);
+}
 
-    m_VBO.setData(skyboxVertices, sizeof(skyboxVertices));
-    m_VAO.bindVBO(m_VBO, 0, 3 * sizeof(float));
+void Skybox::update(const glm::vec3& sunDirection, const glm::vec3& cameraPos) {
+    PROFILE_SCOPE("Skybox::update");
 
-    m_VAO.enableAttrib(0);
-    m_VAO.setAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    const float cameraRadius = GROUND_RADIUS + std::max(cameraPos.y, MIN_CAMERA_HEIGHT) * 0.001f;
+    const bool sunMoved = glm::dot(m_lutSunDirection, sunDirection) < std::cos(glm::radians(m_sunThresholdDegrees));
+    const bool cameraMoved = std::abs(cameraRadius - m_lutCameraRadius) * 1000.0f > m_heightThreshold;
+
+    glBindTextureUnit(TRANSMITTANCE_UNIT, m_transmittanceLut);
+    glBindTextureUnit(SKY_VIEW_UNIT, m_skyViewLut);
+    if (m_transmittanceValid && m_skyViewValid && !sunMoved && !cameraMoved) return;
+
+    // The sky-view LUT and every shader applying aerial perspective read the camera's height from here
+    const AtmosphereData data = buildData(cameraRadius);
+    m_params.updateData(0, sizeof(AtmosphereData), &data);
+
+    if (!m_transmittanceValid) {
+        m_transmittanceShader->use();
+        glBindImageTexture(0, m_transmittanceLut, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute(groupCount(TRANSMITTANCE_WIDTH, 8), groupCount(TRANSMITTANCE_HEIGHT, 8), 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        m_transmittanceValid = true;
+    }
+
+    m_skyViewShader->use();
+    glBindImageTexture(0, m_skyViewLut, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(groupCount(SKY_VIEW_WIDTH, 8), groupCount(SKY_VIEW_HEIGHT, 8), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_skyViewValid = true;
+    m_lutSunDirection = sunDirection;
+    m_lutCameraRadius = cameraRadius;
+    m_skyViewUpdates++;
+}
+
+Skybox::AtmosphereData Skybox::buildData(const float cameraRadius) const {
+    // Same density profiles as mediumAt in atmosphere_medium.glsl
+    const float height = cameraRadius - GROUND_RADIUS;
+    const float rayleighDensity = std::exp(-height / RAYLEIGH_SCALE_HEIGHT);
+    const float mieDensity = std::exp(-height / MIE_SCALE_HEIGHT);
+    const float ozoneDensity = std::max(0.0f, 1.0f - std::abs(height - OZONE_PEAK_HEIGHT) / 15.0f);
+    const glm::vec3 extinction = RAYLEIGH_SCATTERING * rayleighDensity + MIE_EXTINCTION * mieDensity +
+                                 OZONE_ABSORPTION * ozoneDensity;
+
+    AtmosphereData data{};
+    data.rayleighScattering = glm::vec4(RAYLEIGH_SCATTERING, RAYLEIGH_SCALE_HEIGHT);
+    data.mieParams = glm::vec4(MIE_SCATTERING, MIE_EXTINCTION, MIE_SCALE_HEIGHT, MIE_G);
+    data.ozoneAbsorption = glm::vec4(OZONE_ABSORPTION, OZONE_PEAK_HEIGHT);
+    data.radii = glm::vec4(GROUND_RADIUS, TOP_RADIUS, cameraRadius, m_aerialPerspectiveScale);
+    data.sunIlluminance = glm::vec4(glm::vec3(m_sunIntensity), std::cos(glm::radians(m_sunDiscDegrees)));
+    data.cameraExtinction = glm::vec4(extinction, 0.0f);
+    return data;
 }
 
-void Skybox::render(const Shader &shader, const glm::vec3 &sunDir, const float dayTime) const {
+void Skybox::render(const Shader &shader) const {
     glDepthFunc(GL_LEQUAL);
 
-    shader.use();
-    shader.setVec3("u_SunDirection", sunDir);
-    shader.setFloat("u_Time", dayTime);
+    shader.use(); // the sun direction comes from the frame constants
 
     m_VAO.bind();
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
 
     glDepthFunc(GL_LESS);
 }
+
+void Skybox::imGui() {
+    if (!ImGui::TreeNode("Sky")) return;
+
+    ImGui::Checkbox("Quarter Resolution", &m_quarterResolution);
+    bool changed = ImGui::SliderFloat("Sun Intensity", &m_sunIntensity, 1.0f, 40.0f);
+    changed |= ImGui::SliderFloat("Sun Disc (deg)", &m_sunDiscDegrees, 0.25f, 3.0f);
+    ImGui::SliderFloat("Ambient Intensity", &m_ambientIntensity, 0.0f, 8.0f);
+    changed |= ImGui::SliderFloat("Aerial Perspective Scale", &m_aerialPerspectiveScale, 0.0f, 50.0f);
+    ImGui::SliderFloat("Sun Threshold (deg)", &m_sunThresholdDegrees, 0.0f, 2.0f);
+    ImGui::SliderFloat("Height Threshold (m)", &m_heightThreshold, 1.0f, 500.0f);
+    if (changed) m_skyViewValid = false;
+
+    ImGui::Text("Sky-view LUT updates: %d", m_skyViewUpdates);
+    ImGui::TreePop();
+}
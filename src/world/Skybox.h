@@ -1,19 +1,78 @@
 #pragma once
+#include <memory>
 #include <glm/glm.hpp>
 #include "../graphics/Shader.h"
+#include "graphics/buffers/UniformBuffer.h"
 #include "graphics/buffers/VAO.h"
-#include "graphics/buffers/VBO.h"
 
+// Physically based sky from two precomputed LUTs (atmosphere.glsl). The transmittance LUT holds the extinction
+// from any height and direction to the top of the atmosphere and is built once. The sky-view LUT holds the
+// single scattered sunlight for every view direction from the camera's height, and is only rebuilt when the sun
+// or the camera's height have moved past a threshold, not every frame.
+// The sky itself is one fullscreen triangle with a texture lookup per pixel, optionally at quarter resolution and
+// upsampled. Lit shaders use the same LUTs for aerial perspective (applyAerialPerspective).
 class Skybox {
 public:
+    static constexpr int TRANSMITTANCE_WIDTH = 256;
+    static constexpr int TRANSMITTANCE_HEIGHT = 64;
+    static constexpr int SKY_VIEW_WIDTH = 192;
+    static constexpr int SKY_VIEW_HEIGHT = 108;
+
+    // Must match atmosphere.glsl
+    static constexpr GLuint PARAMS_BINDING = 3;      // uniform block
+    static constexpr GLuint TRANSMITTANCE_UNIT = 15; // after the shadow map
+    static constexpr GLuint SKY_VIEW_UNIT = 16;
+
     explicit Skybox();
+    ~Skybox();
 
     Skybox(const Skybox&) = delete;
     Skybox& operator=(const Skybox&) = delete;
 
-    void render(const Shader &shader, const glm::vec3 &sunDir, float dayTime) const;
+    // Rebuilds the LUTs that are out of date and binds them for the following passes. Needs the frame constants bound.
+    void update(const glm::vec3& sunDirection, const glm::vec3& cameraPos);
+
+    void render(const Shader &shader) const; // fullscreen triangle on the far plane
+
+    [[nodiscard]] bool isQuarterResolution() const { return m_quarterResolution; }
+    [[nodiscard]] float getSunIntensity() const { return m_sunIntensity; }
+    [[nodiscard]] float getAmbientIntensity() const { return m_ambientIntensity; } // sky irradiance multiplier
+
+    void imGui();
 
 private:
-    VAO m_VAO;
-    VBO m_VBO;
+    // std140 layout of AtmosphereData in atmosphere.glsl
+    struct AtmosphereData {
+        glm::vec4 rayleighScattering; // rgb per km, w: scale height in km
+        glm::vec4 mieParams;          // x: scattering per km, y: extinction per km, z: scale height in km, w: phase g
+        glm::vec4 ozoneAbsorption;    // rgb per km, w: height of the layer's peak in km
+        glm::vec4 radii;              // x: ground, y: top, z: camera distance from the planet's centre, w: aerial perspective scale
+        glm::vec4 sunIlluminance;     // rgb, w: cosine of the sun disc's angular radius
+        glm::vec4 cameraExtinction;   // rgb per km at the camera's height
+    };
+
+    [[nodiscard]] AtmosphereData buildData(float cameraRadius) const;
+
+    std::shared_ptr<Shader> m_transmittanceShader;
+    std::shared_ptr<Shader> m_skyViewShader;
+
+    GLuint m_transmittanceLut = 0;
+    GLuint m_skyViewLut = 0;
+    UniformBuffer m_params;
+    VAO m_VAO; // empty, the triangle is generated from gl_VertexID
+
+    bool m_transmittanceValid = false;
+    bool m_skyViewValid = false;
+    glm::vec3 m_lutSunDirection{0.0f}; // what the sky-view LUT was built for
+    float m_lutCameraRadius = 0.0f;
+    int m_skyViewUpdates = 0;
+
+    // Settings
+    bool m_quarterResolution = true;
+    float m_sunIntensity = 16.0f;
+    float m_ambientIntensity = 2.0f;      // sky light relative to the sun, brightened for the artistic look
+    float m_sunDiscDegrees = 0.75f;       // angular radius, larger than the real sun's so it reads on screen
+    float m_aerialPerspectiveScale = 10.0f; // km of air per km of world
+    float m_sunThresholdDegrees = 0.25f;
+    float m_heightThreshold = 50.0f;      // metres
 };
@@ -1,22 +1,43 @@
 #include "Terrain.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <glm/ext/matrix_transform.hpp>
 
+#include "core/AssetManager.h"
+#include "graphics/MeshOptimizer.h"
+#include "graphics/buffers/IndirectCommand.h"
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
 Terrain::Terrain(const int worldWidth, const int worldDepth, const std::vector<float>& heightMap)
     : m_heights(heightMap),
       m_indexCount(0),
       m_worldWidth(worldWidth),
-      m_worldDepth(worldDepth) {
+      m_worldDepth(worldDepth),
+      m_splatMap(worldWidth, worldDepth),
+      m_horizonMap(worldWidth, worldDepth) {
+    PROFILE_SCOPE("Terrain::Terrain");
+    if (!m_heights.empty()) m_maxHeight = *std::ranges::max_element(m_heights);
 
     std::vector<TerrainVertex> vertices = generateVertices();
     calculateNormals(vertices, m_worldWidth, m_worldDepth);
-    const std::vector<unsigned int> indices = generateIndices();
+    std::vector<TerrainChunk> chunks;
+    std::vector<unsigned int> indices = generateIndices(chunks);
+    optimizeIndices(indices, chunks);
 
     m_indexCount = static_cast<GLsizei>(indices.size());
     setupMesh(vertices, indices);
+    setupChunks(chunks);
     loadTextures();
+    m_horizonMap.bake(m_heights);
+
+    std::cout << indices.size() / 3 << " total triangles in terrain mesh, " << chunks.size() << " chunks." << std::endl;
+}
 
-    std::cout << indices.size() / 3 << " total triangles in terrain mesh." << std::endl;
+Terrain::~Terrain() {
+    if (m_chunkBufferID != 0) glDeleteBuffers(1, &m_chunkBufferID);
+    if (m_chunkCommandBufferID != 0) glDeleteBuffers(1, &m_chunkCommandBufferID);
 }
 
 std::vector<Terrain::TerrainVertex> Terrain::generateVertices() const {
@@ -42,32 +63,103 @@ std::vector<Terrain::TerrainVertex> Terrain::generateVertices() const {
     return vertices;
 }
 
-std::vector<unsigned int> Terrain::generateIndices() const {
+std::vector<unsigned int> Terrain::generateIndices(std::vector<TerrainChunk>& chunks) const {
     std::vector<unsigned int> indices;
     indices.reserve((m_worldWidth - 1) * (m_worldDepth - 1) * 6);
 
-    for (int z = 0; z < m_worldDepth - 1; z++) {
-        for (int x = 0; x < m_worldWidth - 1; x++) {
-            const int topLeft = (z * m_worldWidth) + x;
-            const int topRight = topLeft + 1;
-            const int bottomLeft = ((z + 1) * m_worldWidth) + x;
-            const int bottomRight = bottomLeft + 1;
-
-            // First triangle
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            // Second triangle
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+    for (int chunkZ = 0; chunkZ < m_worldDepth - 1; chunkZ += CHUNK_QUADS) {
+        for (int chunkX = 0; chunkX < m_worldWidth - 1; chunkX += CHUNK_QUADS) {
+            const int endX = std::min(chunkX + CHUNK_QUADS, m_worldWidth - 1);
+            const int endZ = std::min(chunkZ + CHUNK_QUADS, m_worldDepth - 1);
+
+            TerrainChunk chunk{};
+            chunk.firstIndex = static_cast<GLuint>(indices.size());
+
+            float minY = std::numeric_limits<float>::max();
+            float maxY = std::numeric_limits<float>::lowest();
+
+            for (int z = chunkZ; z < endZ; z++) {
+                for (int x = chunkX; x < endX; x++) {
+                    const int topLeft = (z * m_worldWidth) + x;
+                    const int topRight = topLeft + 1;
+                    const int bottomLeft = ((z + 1) * m_worldWidth) + x;
+                    const int bottomRight = bottomLeft + 1;
+
+                    // First triangle
+                    indices.push_back(topLeft);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(topRight);
+
+                    // Second triangle
+                    indices.push_back(topRight);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(bottomRight);
+                }
+            }
+
+            // Bounds include the shared edge vertices of the last row/column
+            for (int z = chunkZ; z <= endZ; z++) {
+                for (int x = chunkX; x <= endX; x++) {
+                    const float y = m_heights[z * m_worldWidth + x];
+                    minY = std::min(minY, y);
+                    maxY = std::max(maxY, y);
+                }
+            }
+
+            chunk.indexCount = static_cast<GLuint>(indices.size()) - chunk.firstIndex;
+            chunk.boundsMin = glm::vec4(chunkX, minY, chunkZ, 0.0f);
+            chunk.boundsMax = glm::vec4(endX, maxY, endZ, 0.0f);
+            chunks.push_back(chunk);
         }
     }
 
     return indices;
 }
 
+// Row-major quads leave less than a row of vertices in the post-transform cache. Each chunk is reordered on its own
+// so the chunk ranges stay intact for culling. The vertices keep their grid order: the chunks' rows are contiguous
+// in it, which measured better for vertex fetch than renumbering them by first use. No overdraw sorting, a
+// heightfield has little and the depth pre-pass takes care of it.
+void Terrain::optimizeIndices(std::vector<unsigned int>& indices, const std::vector<TerrainChunk>& chunks) const {
+    PROFILE_SCOPE("Terrain::optimizeIndices");
+    const size_t vertexCount = static_cast<size_t>(m_worldWidth) * m_worldDepth;
+
+    const bool reporting = MeshOptimizer::isReporting();
+    MeshOptimizer::Report report;
+    if (reporting) {
+        report.verticesBefore = report.verticesAfter = vertexCount;
+        report.cacheBefore = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+        report.fetchBefore = MeshOptimizer::analyzeVertexFetch(indices, vertexCount, sizeof(TerrainVertex));
+    }
+
+    const auto width = static_cast<unsigned int>(m_worldWidth);
+    Parallel::forRange(0, static_cast<int>(chunks.size()), [&](const int begin, const int end) {
+        for (int c = begin; c < end; c++) {
+            const TerrainChunk& chunk = chunks[c];
+            const auto chunkX = static_cast<unsigned int>(chunk.boundsMin.x);
+            const auto chunkZ = static_cast<unsigned int>(chunk.boundsMin.z);
+            const auto rowLength = static_cast<unsigned int>(chunk.boundsMax.x) - chunkX + 1;
+            const auto rows = static_cast<unsigned int>(chunk.boundsMax.z) - chunkZ + 1;
+            const std::span<unsigned int> range(indices.data() + chunk.firstIndex, chunk.indexCount);
+
+            // Chunk-local vertex numbers keep the optimizer's per-vertex arrays small
+            for (unsigned int& index : range) {
+                index = (index / width - chunkZ) * rowLength + index % width - chunkX;
+            }
+            MeshOptimizer::optimizeVertexCache(range, static_cast<size_t>(rowLength) * rows);
+            for (unsigned int& index : range) {
+                index = (index / rowLength + chunkZ) * width + index % rowLength + chunkX;
+            }
+        }
+    }, 16);
+
+    if (reporting) {
+        report.cacheAfter = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+        report.fetchAfter = MeshOptimizer::analyzeVertexFetch(indices, vertexCount, sizeof(TerrainVertex));
+        report.print("terrain");
+    }
+}
+
 void Terrain::calculateNormals(std::vector<TerrainVertex>& vertices, const int worldWidth, const int worldDepth) const {
     auto getHeightSafe = [&](int x, int z) -> float {
         x = std::max(0, std::min(x, worldWidth - 1));
@@ -131,23 +223,31 @@ float Terrain::getHeightAt(const float x, const float z) const {
     return height + m_position.y;
 }
 
+// Decoded on the TextureLoader's workers and cached by the AssetManager, so a regenerated terrain reuses them
 void Terrain::loadTextures() {
     const std::string texPath = "/home/holmberg/development/Scilla/assets/textures/terrain/";
+    auto& assetManager = AssetManager::get();
+    using Usage = Texture::Usage;
+
+    m_grassTexture   = assetManager.loadTextureAsync(texPath + "Grass001_2K-PNG_Color.png", Usage::Color, true, false);
+    m_grassNormal    = assetManager.loadTextureAsync(texPath + "Grass001_2K-PNG_NormalGL.png", Usage::Normal, false, false);
+    m_grassRoughness = assetManager.loadTextureAsync(texPath + "Grass001_2K-PNG_Roughness.png", Usage::Mask, false, false);
+    m_grassAO        = assetManager.loadTextureAsync(texPath + "Grass001_2K-PNG_AmbientOcclusion.png", Usage::Mask, false, false);
+
+    m_rockTexture   = assetManager.loadTextureAsync(texPath + "rock_face_03_diff_2k.jpg", Usage::Color, true, false);
+    m_rockNormal    = assetManager.loadTextureAsync(texPath + "rock_face_03_nor_gl_2k.png", Usage::Normal, false, false);
+    m_rockAO        = assetManager.loadTextureAsync(texPath + "rock_face_03_ao_2k.png", Usage::Mask, false, false);
+    m_rockRoughness = assetManager.loadTextureAsync(texPath + "rock_face_03_rough_2k.png", Usage::Mask, false, false);
+
+    m_snowTexture   = assetManager.loadTextureAsync(texPath + "snow_field_aerial_col_2k.jpg", Usage::Color, true, false);
+    m_snowNormal    = assetManager.loadTextureAsync(texPath + "snow_field_aerial_nor_gl_2k.png", Usage::Normal, false, false);
+    m_snowAO        = assetManager.loadTextureAsync(texPath + "snow_field_aerial_ao_2k.png", Usage::Mask, false, false);
+    m_snowRoughness = assetManager.loadTextureAsync(texPath + "snow_field_aerial_rough_2k.png", Usage::Mask, false, false);
+}
 
-    m_grassTexture   = Texture(texPath + "Grass001_2K-PNG_Color.png", "texture_diffuse", true, false);
-    m_grassNormal    = Texture(texPath + "Grass001_2K-PNG_NormalGL.png", "texture_normal", true, false);
-    m_grassRoughness = Texture(texPath + "Grass001_2K-PNG_Roughness.png", "texture_roughness", false, false);
-    m_grassAO        = Texture(texPath + "Grass001_2K-PNG_AmbientOcclusion.png", "texture_ao", false, false);
-
-    m_rockTexture   = Texture(texPath + "rock_face_03_diff_2k.jpg", "texture_diffuse", true, false);
-    m_rockNormal    = Texture(texPath + "rock_face_03_nor_gl_2k.png", "texture_normal", true, false);
-    m_rockAO        = Texture(texPath + "rock_face_03_ao_2k.png", "texture_ao", false, false);
-    m_rockRoughness = Texture(texPath + "rock_face_03_rough_2k.png", "texture_roughness", false, false);
-
-    m_snowTexture   = Texture(texPath + "snow_field_aerial_col_2k.jpg", "texture_diffuse", true, false);
-    m_snowNormal    = Texture(texPath + "snow_field_aerial_nor_gl_2k.png", "texture_normal", true, false);
-    m_snowAO        = Texture(texPath + "snow_field_aerial_ao_2k.png", "texture_ao", false, false);
-    m_snowRoughness = Texture(texPath + "snow_field_aerial_rough_2k.png", "texture_roughness", false, false);
+void Terrain::updateSplatMap(const TerrainMaterial& material) {
+    PROFILE_SCOPE("Terrain::updateSplatMap");
+    m_splatMap.bake(m_heights, material, m_position.y);
 }
 
 void Terrain::setupMesh(const std::vector<TerrainVertex>& vertices, const std::vector<unsigned int>& indices) {
@@ -182,21 +282,61 @@ void Terrain::setupMesh(const std::vector<TerrainVertex>& vertices, const std::v
     m_VAO.setAttribFormat(4, 3, GL_FLOAT, GL_FALSE, offsetof(TerrainVertex, Bitangent), 0);
 }
 
-void Terrain::render(const Shader& shader) const {
-    m_grassTexture.bindToTextureUnit(0);
-    m_grassNormal.bindToTextureUnit(1);
-    m_grassRoughness.bindToTextureUnit(2);
-    m_grassAO.bindToTextureUnit(3);
+void Terrain::setupChunks(const std::vector<TerrainChunk>& chunks) {
+    m_chunkCount = static_cast<GLsizei>(chunks.size());
+
+    glCreateBuffers(1, &m_chunkBufferID);
+    glNamedBufferStorage(m_chunkBufferID, chunks.size() * sizeof(TerrainChunk), chunks.data(), 0);
+
+    // Start with every chunk visible, the culling pass overwrites this each frame
+    std::vector<DrawElementsIndirectCommand> commands;
+    commands.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        commands.push_back({chunk.indexCount, 1, chunk.firstIndex, 0, 0});
+    }
+
+    glCreateBuffers(1, &m_chunkCommandBufferID);
+    glNamedBufferStorage(m_chunkCommandBufferID, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), 0);
+}
+
+void Terrain::draw(const bool culled) const {
+    m_VAO.bind();
 
-    m_rockTexture.bindToTextureUnit(4);
-    m_rockNormal.bindToTextureUnit(5);
-    m_rockRoughness.bindToTextureUnit(6);
-    m_rockAO.bindToTextureUnit(7);
+    if (culled) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_chunkCommandBufferID);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, m_chunkCount, 0);
+    } else {
+        glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
+    }
+}
 
-    m_snowTexture.bindToTextureUnit(8);
-    m_snowNormal.bindToTextureUnit(9);
-    m_snowRoughness.bindToTextureUnit(10);
-    m_snowAO.bindToTextureUnit(11);
+void Terrain::renderDepth(const bool culled) const {
+    draw(culled);
+}
+
+void Terrain::render(const Shader& shader, const bool culled) const {
+    bindMaterial(shader);
+    draw(culled);
+}
+
+void Terrain::bindMaterial(const Shader& shader) const {
+    m_grassTexture->bindToTextureUnit(0);
+    m_grassNormal->bindToTextureUnit(1);
+    m_grassRoughness->bindToTextureUnit(2);
+    m_grassAO->bindToTextureUnit(3);
+
+    m_rockTexture->bindToTextureUnit(4);
+    m_rockNormal->bindToTextureUnit(5);
+    m_rockRoughness->bindToTextureUnit(6);
+    m_rockAO->bindToTextureUnit(7);
+
+    m_snowTexture->bindToTextureUnit(8);
+    m_snowNormal->bindToTextureUnit(9);
+    m_snowRoughness->bindToTextureUnit(10);
+    m_snowAO->bindToTextureUnit(11);
+
+    m_splatMap.bindToTextureUnit(12);
+    m_horizonMap.bindToTextureUnit(13);
 
     shader.use();
 
@@ -215,8 +355,8 @@ void Terrain::render(const Shader& shader) const {
     shader.setTextureUnit("snowRoughness", 10);
     shader.setTextureUnit("snowAO", 11);
 
-    m_VAO.bind();
-    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
+    shader.setTextureUnit("splatMap", 12);
+    shader.setTextureUnit("horizonMap", 13);
 }
 
 glm::mat4 Terrain::getModelMatrix() const {
@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <glad/glad.h>
 #include "../graphics/Shader.h"
@@ -6,6 +7,8 @@
 #include "graphics/buffers/EBO.h"
 #include "graphics/buffers/VAO.h"
 #include "graphics/buffers/VBO.h"
+#include "TerrainHorizonMap.h"
+#include "TerrainSplatMap.h"
 
 struct TerrainParams {
     int octaves = 6;           // Number of noise layers
@@ -31,46 +34,89 @@ public:
         glm::vec3 Tangent;
         glm::vec3 Bitangent;
     };
+
+    // A square block of the index buffer with its bounds, culled as a unit on the GPU.
+    // std430 layout, matches the Chunk struct in cull_terrain.comp.
+    struct TerrainChunk {
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+        GLuint firstIndex;
+        GLuint indexCount;
+        GLuint pad[2];
+    };
+
+    static constexpr int CHUNK_QUADS = 64; // quads per chunk side
+
     Terrain(int worldWidth, int worldDepth, const std::vector<float>& heightMap);
+    ~Terrain();
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
 
     float getHeightAt(float x, float z) const;
+    [[nodiscard]] float getMaxHeight() const { return m_maxHeight + m_position.y; } // world space
 
     [[nodiscard]] std::vector<TerrainVertex> generateVertices() const;
-    [[nodiscard]] std::vector<unsigned int> generateIndices() const;
+    // Indices are laid out chunk by chunk so every chunk is one contiguous range
+    [[nodiscard]] std::vector<unsigned int> generateIndices(std::vector<TerrainChunk>& chunks) const;
     void calculateNormals(std::vector<TerrainVertex>& vertices, int worldWidth, int worldDepth) const;
 
     void loadTextures();
 
-    void render(const Shader& shader) const;
+    // Re-bakes the material blend weights, only touching tiles affected by changed limits
+    void updateSplatMap(const TerrainMaterial& material);
+
+    // culled = draw only the chunks the last OcclusionCuller pass left visible
+    void render(const Shader& shader, bool culled = false) const;
+    void renderDepth(bool culled = false) const; // geometry only, for the depth pre-pass, shadows and visibility buffer
+    void bindMaterial(const Shader& shader) const; // textures and sampler uniforms of terrain_shading.glsl
+
+    [[nodiscard]] GLuint getChunkBufferID() const { return m_chunkBufferID; }
+    [[nodiscard]] GLuint getChunkCommandBufferID() const { return m_chunkCommandBufferID; }
+    [[nodiscard]] GLsizei getChunkCount() const { return m_chunkCount; }
+    [[nodiscard]] GLuint getVertexBufferID() const { return m_VBO.getID(); } // TerrainVertex, read by the visibility resolve
+    [[nodiscard]] GLuint getIndexBufferID() const { return m_EBO.getID(); }
     [[nodiscard]] glm::mat4 getModelMatrix() const;
     glm::vec3 m_position{0.0f};
 
 private:
+    // Vertex cache order within every chunk. Prints the analysis while MeshOptimizer reporting is on.
+    void optimizeIndices(std::vector<unsigned int>& indices, const std::vector<TerrainChunk>& chunks) const;
     void setupMesh(const std::vector<TerrainVertex>& vertices, const std::vector<unsigned int>& indices);
+    void setupChunks(const std::vector<TerrainChunk>& chunks);
+    void draw(bool culled) const;
 
     std::vector<float> m_heights;
+    float m_maxHeight = 0.0f; // of m_heights
 
     VAO m_VAO;
     VBO m_VBO;
     EBO m_EBO;
 
     GLsizei m_indexCount;
+
+    GLuint m_chunkBufferID = 0;
+    GLuint m_chunkCommandBufferID = 0;
+    GLsizei m_chunkCount = 0;
     int m_worldWidth, m_worldDepth;
 
-    Texture m_grassTexture;
-    Texture m_grassNormal;
-    Texture m_grassRoughness;
-    Texture m_grassAO;
+    std::shared_ptr<Texture> m_grassTexture;
+    std::shared_ptr<Texture> m_grassNormal;
+    std::shared_ptr<Texture> m_grassRoughness;
+    std::shared_ptr<Texture> m_grassAO;
+
+    std::shared_ptr<Texture> m_rockTexture;
+    std::shared_ptr<Texture> m_rockNormal;
+    std::shared_ptr<Texture> m_rockRoughness;
+    std::shared_ptr<Texture> m_rockAO;
 
-    Texture m_rockTexture;
-    Texture m_rockNormal;
-    Texture m_rockRoughness;
-    Texture m_rockAO;
+    std::shared_ptr<Texture> m_snowTexture;
+    std::shared_ptr<Texture> m_snowNormal;
+    std::shared_ptr<Texture> m_snowRoughness;
+    std::shared_ptr<Texture> m_snowAO;
 
-    Texture m_snowTexture;
-    Texture m_snowNormal;
-    Texture m_snowRoughness;
-    Texture m_snowAO;
+    TerrainSplatMap m_splatMap;
+    TerrainHorizonMap m_horizonMap;
 };
 
 
@@ -4,9 +4,11 @@
 #define STB_PERLIN_IMPLEMENTATION
 #include <stb/stb_perlin.h>
 #include <utils/Math.h>
+#include "utils/Profiler.h"
 
 // this generates a heightmap using fractal brownian motion (FBM) based on Perlin noise
 std::vector<float> TerrainGenerator::generateHeights(const int worldWidth, const int worldDepth, const TerrainParams& params) {
+    PROFILE_SCOPE("TerrainGenerator::generateHeights");
     std::vector<float> heights(worldWidth * worldDepth);
 
     // Track the actual range of noise values we generate
@@ -0,0 +1,210 @@
+// The heightmap only changes when the terrain is regenerated, so the horizon around every texel is marched once on
+// worker threads instead of rendering the terrain into a shadow map every time the sun moves.
+// Directions are the 8 grid neighbours: along a row of texels the samples at a given step are then contiguous in
+// memory too, and the SIMD paths load 4 or 8 of them per instruction without gathers.
+
+#include "TerrainHorizonMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCILLA_HORIZON_X86 1
+#include <immintrin.h>
+#else
+#define SCILLA_HORIZON_X86 0
+#endif
+
+namespace {
+    // Texel distances marched in every direction, roughly geometric: the horizon is dominated by nearby
+    // terrain, far away only large features matter. The last one must be MAX_OFFSET.
+    constexpr int STEP_OFFSETS[] = {1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 19, 24, 30, 37, 46, 58, 72, 90, 112, 128};
+    constexpr int STEP_COUNT = static_cast<int>(std::size(STEP_OFFSETS));
+
+    constexpr int DIRECTION_X[] = {1, 1, 0, -1, -1, -1, 0, 1};
+    constexpr int DIRECTION_Z[] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+    constexpr float PADDING_HEIGHT = -1.0e6f; // far below any terrain, never raises the horizon
+
+    // One direction's samples relative to the texel
+    struct Steps {
+        ptrdiff_t offsets[STEP_COUNT]; // in m_grid elements
+        float invDistances[STEP_COUNT]; // 1 / horizontal distance in heightmap units
+    };
+
+    // out[i] = tangent of the highest horizon seen from row[i], at least 0.
+    // The scalar loop also handles the tails the SIMD loops leave over.
+    void horizonScalar(const float* row, const int count, const Steps& steps, float* out, const int begin) {
+        for (int i = begin; i < count; i++) {
+            const float h0 = row[i];
+            float tangent = 0.0f;
+            for (int k = 0; k < STEP_COUNT; k++) {
+                tangent = std::max(tangent, (row[i + steps.offsets[k]] - h0) * steps.invDistances[k]);
+            }
+            out[i] = tangent;
+        }
+    }
+
+#if SCILLA_HORIZON_X86
+    // SSE is part of the x86-64 baseline
+    int horizonSse(const float* row, const int count, const Steps& steps, float* out) {
+        const int end = count & ~3;
+        for (int i = 0; i < end; i += 4) {
+            const __m128 h0 = _mm_loadu_ps(row + i);
+            __m128 tangent = _mm_setzero_ps();
+            for (int k = 0; k < STEP_COUNT; k++) {
+                const __m128 rise = _mm_sub_ps(_mm_loadu_ps(row + i + steps.offsets[k]), h0);
+                tangent = _mm_max_ps(tangent, _mm_mul_ps(rise, _mm_set1_ps(steps.invDistances[k])));
+            }
+            _mm_storeu_ps(out + i, tangent);
+        }
+        return end;
+    }
+
+    // AVX is not part of the x86-64 baseline, only called after the runtime check in horizonRow
+    __attribute__((target("avx")))
+    int horizonAvx(const float* row, const int count, const Steps& steps, float* out) {
+        const int end = count & ~7;
+        for (int i = 0; i < end; i += 8) {
+            const __m256 h0 = _mm256_loadu_ps(row + i);
+            __m256 tangent = _mm256_setzero_ps();
+            for (int k = 0; k < STEP_COUNT; k++) {
+                const __m256 rise = _mm256_sub_ps(_mm256_loadu_ps(row + i + steps.offsets[k]), h0);
+                tangent = _mm256_max_ps(tangent, _mm256_mul_ps(rise, _mm256_set1_ps(steps.invDistances[k])));
+            }
+            _mm256_storeu_ps(out + i, tangent);
+        }
+        return end;
+    }
+#endif
+
+    void horizonRow(const float* row, const int count, const Steps& steps, float* out) {
+        int done = 0;
+#if SCILLA_HORIZON_X86
+        static const bool hasAvx = __builtin_cpu_supports("avx");
+        done = hasAvx ? horizonAvx(row, count, steps, out) : horizonSse(row, count, steps, out);
+#endif
+        horizonScalar(row, count, steps, out, done);
+    }
+
+    // Elevation angle as a fraction of 90 degrees, in 8 bits
+    uint32_t encodeAngle(const float tangent) {
+        const float angle = std::atan(tangent) / (std::numbers::pi_v<float> * 0.5f);
+        return static_cast<uint32_t>(std::lround(std::clamp(angle, 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+TerrainHorizonMap::TerrainHorizonMap(const int terrainWidth, const int terrainDepth)
+    : m_terrainWidth(terrainWidth), m_terrainDepth(terrainDepth),
+      m_width((terrainWidth + SCALE - 1) / SCALE), m_depth((terrainDepth + SCALE - 1) / SCALE),
+      m_stride(m_width + 2 * MAX_OFFSET) {
+    const GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(std::max(m_width, m_depth))));
+
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_textureID);
+    glTextureStorage3D(m_textureID, levels, GL_RGBA8, m_width, m_depth, 2);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    m_grid.assign(static_cast<size_t>(m_stride) * (m_depth + 2 * MAX_OFFSET), PADDING_HEIGHT);
+    for (auto& layer : m_texels) {
+        layer.resize(static_cast<size_t>(m_width) * m_depth);
+    }
+
+    for (int z0 = 0; z0 < m_depth; z0 += TILE_SIZE) {
+        for (int x0 = 0; x0 < m_width; x0 += TILE_SIZE) {
+            m_tiles.push_back({x0, z0, std::min(x0 + TILE_SIZE, m_width), std::min(z0 + TILE_SIZE, m_depth)});
+        }
+    }
+}
+
+TerrainHorizonMap::~TerrainHorizonMap() {
+    if (m_textureID != 0) {
+        glDeleteTextures(1, &m_textureID);
+    }
+}
+
+void TerrainHorizonMap::bake(const std::vector<float>& heights) {
+    PROFILE_SCOPE("TerrainHorizonMap::bake");
+    sampleHeights(heights);
+
+    Parallel::forRange(0, static_cast<int>(m_tiles.size()), [&](const int begin, const int end) {
+        PROFILE_SCOPE("TerrainHorizonMap::bakeTiles");
+        for (int i = begin; i < end; i++) {
+            bakeTile(m_tiles[i]);
+        }
+    });
+
+    upload();
+}
+
+void TerrainHorizonMap::bindToTextureUnit(const GLuint unit) const {
+    glBindTextureUnit(unit, m_textureID);
+}
+
+// Each texel takes the mean of the heightmap samples it covers
+void TerrainHorizonMap::sampleHeights(const std::vector<float>& heights) {
+    Parallel::forRange(0, m_depth, [&](const int begin, const int end) {
+        for (int z = begin; z < end; z++) {
+            float* gridRow = &m_grid[static_cast<size_t>(z + MAX_OFFSET) * m_stride + MAX_OFFSET];
+            for (int x = 0; x < m_width; x++) {
+                float sum = 0.0f;
+                int samples = 0;
+                for (int sz = z * SCALE; sz < std::min((z + 1) * SCALE, m_terrainDepth); sz++) {
+                    for (int sx = x * SCALE; sx < std::min((x + 1) * SCALE, m_terrainWidth); sx++) {
+                        sum += heights[static_cast<size_t>(sz) * m_terrainWidth + sx];
+                        samples++;
+                    }
+                }
+                gridRow[x] = sum / static_cast<float>(samples);
+            }
+        }
+    }, 16);
+}
+
+void TerrainHorizonMap::bakeTile(const Tile& tile) {
+    Steps steps[DIRECTIONS];
+    for (int d = 0; d < DIRECTIONS; d++) {
+        const float length = std::sqrt(static_cast<float>(DIRECTION_X[d] * DIRECTION_X[d] + DIRECTION_Z[d] * DIRECTION_Z[d]));
+        for (int k = 0; k < STEP_COUNT; k++) {
+            steps[d].offsets[k] = static_cast<ptrdiff_t>(STEP_OFFSETS[k]) * (DIRECTION_Z[d] * m_stride + DIRECTION_X[d]);
+            steps[d].invDistances[k] = 1.0f / (static_cast<float>(STEP_OFFSETS[k] * SCALE) * length);
+        }
+    }
+
+    const int count = tile.x1 - tile.x0;
+    float tangents[DIRECTIONS][TILE_SIZE];
+
+    for (int z = tile.z0; z < tile.z1; z++) {
+        const float* row = &m_grid[static_cast<size_t>(z + MAX_OFFSET) * m_stride + MAX_OFFSET + tile.x0];
+        for (int d = 0; d < DIRECTIONS; d++) {
+            horizonRow(row, count, steps[d], tangents[d]);
+        }
+
+        const size_t rowStart = static_cast<size_t>(z) * m_width + tile.x0;
+        for (int i = 0; i < count; i++) {
+            for (int layer = 0; layer < 2; layer++) {
+                uint32_t packed = 0;
+                for (int c = 0; c < 4; c++) {
+                    packed |= encodeAngle(tangents[layer * 4 + c][i]) << (8 * c);
+                }
+                m_texels[layer][rowStart + i] = packed;
+            }
+        }
+    }
+}
+
+void TerrainHorizonMap::upload() const {
+    // GL calls stay on the main thread
+    for (int layer = 0; layer < 2; layer++) {
+        glTextureSubImage3D(m_textureID, 0, 0, 0, layer, m_width, m_depth, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                            m_texels[layer].data());
+    }
+    glGenerateTextureMipmap(m_textureID);
+}
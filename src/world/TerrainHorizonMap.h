@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+// Horizon elevation of the terrain in DIRECTIONS azimuths around every texel, baked from the heightmap.
+// terrain.frag compares the sun's elevation against the horizon in the sun's azimuth for soft self-shadowing at any
+// distance, and averages all directions into an ambient occlusion term: a few texture lookups instead of a shadow pass.
+// Stored as a 2-layer RGBA8 array at half the heightmap resolution. Layer 0 holds directions 0-3, layer 1 holds 4-7.
+// Direction i points at azimuth i * 45 degrees, starting at +x and turning towards +z.
+class TerrainHorizonMap {
+public:
+    static constexpr int DIRECTIONS = 8;
+    static constexpr int SCALE = 2; // heightmap samples per texel side
+
+    TerrainHorizonMap(int terrainWidth, int terrainDepth);
+    ~TerrainHorizonMap();
+
+    TerrainHorizonMap(const TerrainHorizonMap&) = delete;
+    TerrainHorizonMap& operator=(const TerrainHorizonMap&) = delete;
+
+    // Every texel. The terrain only changes wholesale (regenerating builds a new Terrain), so there is no partial
+    // re-bake.
+    void bake(const std::vector<float>& heights);
+
+    void bindToTextureUnit(GLuint unit) const;
+
+private:
+    static constexpr int TILE_SIZE = 64;    // texels, the unit of work for the bake's threads
+    static constexpr int MAX_OFFSET = 128;  // texels searched in every direction (256 heightmap samples)
+
+    struct Tile {
+        int x0, z0, x1, z1;
+    };
+
+    void sampleHeights(const std::vector<float>& heights); // into m_grid
+    void bakeTile(const Tile& tile);
+    void upload() const;
+
+    GLuint m_textureID = 0;
+    int m_terrainWidth, m_terrainDepth;
+    int m_width, m_depth; // texels
+    int m_stride;         // of m_grid
+
+    // Downsampled heights with MAX_OFFSET texels of padding on every side, so the marching never needs bounds checks
+    std::vector<float> m_grid;
+    std::vector<uint32_t> m_texels[2]; // per layer, filled by the worker threads and uploaded on the main thread
+    std::vector<Tile> m_tiles;
+};
@@ -0,0 +1,187 @@
+// The splat map replaces the per-fragment height/slope/noise layer blending that used to live in terrain.frag.
+// Weights only depend on the (static) heightmap and the material limits, so we bake them once on worker threads
+// and re-bake only the tiles affected when a limit is changed from ImGui.
+
+#include "TerrainSplatMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Terrain.h"
+#include "utils/Parallel.h"
+#include "utils/Profiler.h"
+
+namespace {
+    float smoothstep(const float edge0, const float edge1, const float x) {
+        const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // Integer hash mapped to [0, 1). Stable across runs, unlike the old sin() based shader noise.
+    float hashNoise(const int x, const int z) {
+        uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(z) * 0xd8163841u;
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        return static_cast<float>(h & 0xffffffu) / static_cast<float>(0x1000000);
+    }
+
+    uint32_t packWeights(const float grass, const float rock, const float snow) {
+        const auto toByte = [](const float w) {
+            return static_cast<uint32_t>(std::lround(std::clamp(w, 0.0f, 1.0f) * 255.0f));
+        };
+        return toByte(grass) | toByte(rock) << 8 | toByte(snow) << 16; // alpha stays 0, no painted override
+    }
+}
+
+TerrainSplatMap::TerrainSplatMap(const int width, const int depth)
+    : m_width(width), m_depth(depth) {
+    const GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(std::max(width, depth))));
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
+    glTextureStorage2D(m_textureID, levels, GL_RGBA8, width, depth);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    m_texels.resize(static_cast<size_t>(width) * depth);
+}
+
+TerrainSplatMap::~TerrainSplatMap() {
+    if (m_textureID != 0) {
+        glDeleteTextures(1, &m_textureID);
+    }
+}
+
+void TerrainSplatMap::bake(const std::vector<float>& heights, const TerrainMaterial& material, const float heightOffset) {
+    if (m_tiles.empty()) {
+        buildTiles(heights);
+    }
+
+    // The tiles' height ranges are in heightmap units, so the limits are moved there instead
+    const float rockHeight = material.rockHeight - heightOffset;
+    const float snowHeight = material.snowHeight - heightOffset;
+
+    if (m_hasBake && rockHeight == m_bakedRockHeight && snowHeight == m_bakedSnowHeight) {
+        return;
+    }
+
+    // A texel's weights can only change if its height lies within the blend range of a limit that moved.
+    // Outside that band both smoothsteps are saturated at 0 or 1 for the old and the new limit.
+    std::vector<const Tile*> dirty;
+    for (const Tile& tile : m_tiles) {
+        const auto touches = [&tile](const float oldLimit, const float newLimit) {
+            if (oldLimit == newLimit) return false;
+            const float lo = std::min(oldLimit, newLimit) - BLEND_RANGE;
+            const float hi = std::max(oldLimit, newLimit) + BLEND_RANGE;
+            return tile.maxHeight >= lo && tile.minHeight <= hi;
+        };
+
+        if (!m_hasBake || touches(m_bakedRockHeight, rockHeight) || touches(m_bakedSnowHeight, snowHeight)) {
+            dirty.push_back(&tile);
+        }
+    }
+
+    m_hasBake = true;
+    m_bakedRockHeight = rockHeight;
+    m_bakedSnowHeight = snowHeight;
+
+    if (dirty.empty()) return;
+
+    PROFILE_SCOPE("TerrainSplatMap::bake");
+    Parallel::forRange(0, static_cast<int>(dirty.size()), [&](const int begin, const int end) {
+        PROFILE_SCOPE("TerrainSplatMap::bakeTiles");
+        for (int i = begin; i < end; i++) {
+            bakeTile(*dirty[i], heights, rockHeight, snowHeight);
+        }
+    });
+
+    // GL calls stay on the main thread
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+    for (const Tile* tile : dirty) {
+        uploadTile(*tile);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glGenerateTextureMipmap(m_textureID);
+}
+
+void TerrainSplatMap::bindToTextureUnit(const GLuint unit) const {
+    glBindTextureUnit(unit, m_textureID);
+}
+
+void TerrainSplatMap::buildTiles(const std::vector<float>& heights) {
+    for (int z0 = 0; z0 < m_depth; z0 += TILE_SIZE) {
+        for (int x0 = 0; x0 < m_width; x0 += TILE_SIZE) {
+            m_tiles.push_back({x0, z0, std::min(x0 + TILE_SIZE, m_width), std::min(z0 + TILE_SIZE, m_depth), 0.0f, 0.0f});
+        }
+    }
+
+    Parallel::forRange(0, static_cast<int>(m_tiles.size()), [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            Tile& tile = m_tiles[i];
+            tile.minHeight = std::numeric_limits<float>::max();
+            tile.maxHeight = std::numeric_limits<float>::lowest();
+
+            for (int z = tile.z0; z < tile.z1; z++) {
+                for (int x = tile.x0; x < tile.x1; x++) {
+                    const float h = biasedHeight(heights, x, z);
+                    tile.minHeight = std::min(tile.minHeight, h);
+                    tile.maxHeight = std::max(tile.maxHeight, h);
+                }
+            }
+        }
+    });
+}
+
+// Same layer rules terrain.frag used to evaluate per fragment
+void TerrainSplatMap::bakeTile(const Tile& tile, const std::vector<float>& heights, const float rockHeight, const float snowHeight) {
+    for (int z = tile.z0; z < tile.z1; z++) {
+        for (int x = tile.x0; x < tile.x1; x++) {
+            const float h = biasedHeight(heights, x, z);
+
+            float grassW = 1.0f - smoothstep(rockHeight - BLEND_RANGE, rockHeight + BLEND_RANGE, h);
+            float snowW = smoothstep(snowHeight - BLEND_RANGE, snowHeight + BLEND_RANGE, h);
+            float rockW = std::max(0.0f, 1.0f - grassW - snowW);
+
+            const float slope = slopeAt(heights, x, z);
+
+            rockW = std::max(rockW, slope);
+            grassW *= 1.0f - slope;
+            snowW *= 1.0f - slope;
+
+            const float sum = std::max(grassW + rockW + snowW, 0.0001f);
+            m_texels[static_cast<size_t>(z) * m_width + x] = packWeights(grassW / sum, rockW / sum, snowW / sum);
+        }
+    }
+}
+
+void TerrainSplatMap::uploadTile(const Tile& tile) const {
+    glTextureSubImage2D(
+        m_textureID,
+        0, tile.x0, tile.z0,
+        tile.x1 - tile.x0, tile.z1 - tile.z0,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        &m_texels[static_cast<size_t>(tile.z0) * m_width + tile.x0]
+    );
+}
+
+float TerrainSplatMap::biasedHeight(const std::vector<float>& heights, const int x, const int z) const {
+    return heights[static_cast<size_t>(z) * m_width + x] + hashNoise(x, z) * NOISE_AMPLITUDE;
+}
+
+// Slope factor from the terrain normal, using the same finite difference as Terrain::calculateNormals
+float TerrainSplatMap::slopeAt(const std::vector<float>& heights, const int x, const int z) const {
+    const auto heightAt = [&](const int sx, const int sz) {
+        return heights[static_cast<size_t>(std::clamp(sz, 0, m_depth - 1)) * m_width + std::clamp(sx, 0, m_width - 1)];
+    };
+
+    const float nx = heightAt(x - 1, z) - heightAt(x + 1, z);
+    const float nz = heightAt(x, z - 1) - heightAt(x, z + 1);
+    const float normalY = 2.0f / std::sqrt(nx * nx + 4.0f + nz * nz);
+
+    return smoothstep(0.1f, 0.35f, 1.0f - normalY);
+}
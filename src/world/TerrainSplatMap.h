@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+struct TerrainMaterial;
+
+// RGBA8 texture holding the grass/rock/snow blend weights for every heightmap texel.
+// R = grass, G = rock, B = snow, A = reserved for painted overrides (0 = none).
+// The weights are baked on the CPU so terrain.frag only has to sample them.
+class TerrainSplatMap {
+public:
+    TerrainSplatMap(int width, int depth);
+    ~TerrainSplatMap();
+
+    TerrainSplatMap(const TerrainSplatMap&) = delete;
+    TerrainSplatMap& operator=(const TerrainSplatMap&) = delete;
+
+    // Bakes the weights for the given material. The first call bakes everything,
+    // later calls only re-bake the tiles whose height range is touched by the changed limits.
+    // The limits are world-space heights, heightOffset is the terrain's world y.
+    void bake(const std::vector<float>& heights, const TerrainMaterial& material, float heightOffset);
+
+    void bindToTextureUnit(GLuint unit) const;
+
+private:
+    static constexpr int TILE_SIZE = 64;
+    static constexpr float BLEND_RANGE = 2.0f; // +- range around a height limit where two layers are mixed
+    static constexpr float NOISE_AMPLITUDE = 1.5f; // breaks up the straight contour lines between layers
+
+    struct Tile {
+        int x0, z0, x1, z1;
+        float minHeight, maxHeight; // range of the noise-offset heights inside the tile
+    };
+
+    void buildTiles(const std::vector<float>& heights);
+    void bakeTile(const Tile& tile, const std::vector<float>& heights, float rockHeight, float snowHeight);
+    void uploadTile(const Tile& tile) const;
+
+    [[nodiscard]] float biasedHeight(const std::vector<float>& heights, int x, int z) const;
+    [[nodiscard]] float slopeAt(const std::vector<float>& heights, int x, int z) const;
+
+    GLuint m_textureID = 0;
+    int m_width, m_depth;
+
+    std::vector<uint32_t> m_texels; // CPU copy, so dirty tiles can be re-uploaded on their own
+    std::vector<Tile> m_tiles;
+
+    bool m_hasBake = false;
+    float m_bakedRockHeight = 0.0f; // relative to the heightmap
+    float m_bakedSnowHeight = 0.0f;
+};
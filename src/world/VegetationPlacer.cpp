@@ -1,11 +1,14 @@
 #include "VegetationPlacer.h"
 #include "../core/AssetManager.h"
 #include "../core/Renderer.h"
+#include "../graphics/OcclusionCuller.h"
 #include <world/Terrain.h>
 #include <cstdlib>
 #include <iostream>
+#include "utils/Profiler.h"
 
 void VegetationPlacer::generate(const Terrain &terrain, const std::vector<float> &heightMap, const int mapWidth) {
+    PROFILE_SCOPE("VegetationPlacer::generate");
     auto &assets = AssetManager::get();
     srand(static_cast<unsigned>(time(nullptr)));
 
@@ -56,3 +59,24 @@ void VegetationPlacer::render(Renderer &renderer, const Shader &shader) const {
         renderer.renderInstanced(*m_grass, shader);
     }
 }
+
+void VegetationPlacer::cull(const OcclusionCuller &culler) const {
+    if (m_small_tree) {
+        culler.cullInstances(*m_small_tree);
+    }
+    if (m_grass) {
+        culler.cullInstances(*m_grass);
+    }
+}
+
+void VegetationPlacer::renderShadowCasters(Renderer &renderer, const Shader &shader) const {
+    if (m_small_tree) {
+        renderer.renderInstanced(*m_small_tree, shader);
+    }
+}
+
+void VegetationPlacer::cullShadowCasters(const OcclusionCuller &culler) const {
+    if (m_small_tree) {
+        culler.cullInstances(*m_small_tree);
+    }
+}
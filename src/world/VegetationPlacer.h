@@ -7,6 +7,7 @@
 // Forward declaration. do like this or include the headers?
 class Renderer;
 class Shader;
+class OcclusionCuller;
 
 class VegetationPlacer {
 public:
@@ -15,6 +16,13 @@ public:
     // Call this once during Scene::initialize
     void generate(const Terrain& terrain, const std::vector<float>& heightMap, int mapWidth);
     void render(Renderer& renderer, const Shader& shader) const;
+    void cull(const OcclusionCuller& culler) const;
+
+    // Trees only, grass blades are thinner than a shadow texel and would just add overdraw
+    void renderShadowCasters(Renderer& renderer, const Shader& shader) const;
+    void cullShadowCasters(const OcclusionCuller& culler) const;
+
+    [[nodiscard]] const InstancedModel* getTrees() const { return m_small_tree.get(); } // null before generate
 
 private:
     // The Batches